@@ -3,15 +3,29 @@
 #include "showarray.h"
 #include <assert.h>
 #include "vector.h"
+#include "vector_generator.h"
+#include "numerical_methods/roots.h"
 #include <math.h>
 
 const double pi = 4.0 * atan(1);
 
+static double cosine(double x, void *params)
+{
+    (void)params;
+    return cos(x);
+}
+
+static double minus_sine(double x, void *params)
+{
+    (void)params;
+    return -sin(x);
+}
+
 int main(void)
 {
-    vector_t *x = linspace(0, 2 * PI, 10000);
-    vector_t *y = function_like(x, sin);
-    vector_t *dydx = gradient(y, x);
+    vector_gen_t x = gen_linspace(0, 2 * PI, 10000);
+    vector_t *y = gen_function_like(x, sin);
+    vector_t *dydx = gen_gradient(y, x);
 
     // Finds x values where dydx is zero
     for (size_t i = 0; i < dydx->size - 1; ++i)
@@ -19,12 +33,21 @@ int main(void)
         double prod = dydx->arr[i] * dydx->arr[i + 1];
         if (prod < 0)
         {
-            printf("%g ", x->arr[i + 1]);
+            printf("%g ", gen_at(x, i + 1));
             printf("%g ", y->arr[i + 1]);
         }
     }
 
-    free(x);
+    printf("\n");
+
+    // The same extrema refined to machine precision from a coarse grid
+    root_t extrema[8];
+    size_t n = find_extrema(cosine, minus_sine, NULL, 0, 2 * PI, 16, 0.0, extrema, 8);
+    for (size_t i = 0; i < n && i < 8; ++i)
+    {
+        printf("%.17g %.17g %s\n", extrema[i].x, sin(extrema[i].x), extrema[i].direction > 0 ? "min" : "max");
+    }
+
     free(y);
     free(dydx);
 }
\ No newline at end of file
@@ -6,9 +6,12 @@ and 1D x-array
 #include <stdio.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 #include <assert.h>
 #include "01_gradient.h"
+#include "gradient.h"
+#include "../vector/vector_sum.h"
 
 #define DATA_SIZE 6
 
@@ -63,33 +66,27 @@ double *gradient_descent(
     size_t n_iter,
     double tolerance)
 {
+    // x is a matrix with a single feature
+    gd_matrix_t X = gd_matrix(data_size, 1, GD_ROW_MAJOR, x);
+
     double *errors = malloc(sizeof(*errors) * data_size);
     check_mem_alloc(errors);
 
+    // Buffers for the sweeps, allocated once for every iteration
+    gd_workspace_t *workspace = gd_workspace_create(data_size, 1);
+    check_mem_alloc(workspace);
+
+    double gradient[2];
     double step[2];
 
     for (size_t i = 0; i < n_iter; ++i)
     {
-        double dc_dw0 = 0.0;
-        double dc_dw1 = 0.0;
-
-        // Calculating erros and gradients of each weight
-        for (size_t j = 0; j < data_size; ++j)
-        {
-            double h = hypothesis(weights, x[j]);
-            errors[j] = h - y[j];
-            dc_dw0 += errors[j];
-            dc_dw1 += errors[j] * x[j];
-        }
-
-        // Normalizing gradients
-        dc_dw0 = dc_dw0 / data_size;
-        dc_dw1 = dc_dw1 / data_size;
-
-        // Adjusting weights
-        step[0] = -learn_rate * dc_dw0;
-        step[1] = -learn_rate * dc_dw1;
+        gd_errors_gradient_with(workspace, &X, y, weights, gradient);
+
+        step[0] = -learn_rate * gradient[0];
+        step[1] = -learn_rate * gradient[1];
 
+        // Unlike gd_fit(), the step that falls within tolerance is not applied
         if (is_within_tolerance(2, step, tolerance))
             break;
 
@@ -97,6 +94,9 @@ double *gradient_descent(
         weights[1] += step[1];
     }
 
+    memcpy(errors, gd_workspace_errors(workspace), sizeof(*errors) * data_size);
+    gd_workspace_destroy(workspace);
+
     return errors;
 }
 
@@ -118,21 +118,10 @@ bool is_within_tolerance(size_t n, const double step_sizes[static n], double tol
 double mean(const double res[], size_t n)
 {
     assert(n != 0);
-    double sum = 0.0;
-    for (size_t i = 0; i < n; ++i)
-    {
-        sum += res[i];
-    }
-    return sum / n;
+    return sum_array(sum_policy(), n, res) / n;
 }
 
 double cost_function(const double errors[], size_t n)
 {
-    assert(n != 0);
-    double sum_of_squared_errs = 0.0;
-    for (size_t i = 0; i < n; ++i)
-    {
-        sum_of_squared_errs += errors[i] * errors[i];
-    }
-    return sum_of_squared_errs / (2.0 * (double)n);
+    return gd_cost(n, errors);
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <cmath>
 #include <cstdlib>  // For rand() and srand()
 #include <ctime>    // For time()
+#include "gradient.h"
 
 // Function to generate random weights
 void initialize_random_weights(std::vector<double>& weights) {
@@ -11,11 +12,12 @@ void initialize_random_weights(std::vector<double>& weights) {
     }
 }
 
-// C++ gradient descent function with default values for parameters
+// C++ gradient descent function with default values for parameters,
+// x holds data_size rows of num_weights - 1 features one after another
 std::vector<double> gradient_descent(
     size_t data_size,
     size_t num_weights,
-    const std::vector<std::vector<double>>& x,
+    const std::vector<double>& x,
     const std::vector<double>& y,
     std::vector<double> weights = {},
     double learn_rate = 0.1,
@@ -29,45 +31,9 @@ std::vector<double> gradient_descent(
     }
 
     std::vector<double> errors(data_size);
-    std::vector<double> step(num_weights);
-    std::vector<double> w_gradients(num_weights, 0.0);
 
-    double inv_data_size = 1.0 / static_cast<double>(data_size);
-
-    for (size_t i = 0; i < n_iter; ++i) {
-        std::fill(w_gradients.begin(), w_gradients.end(), 0.0);
-
-        // Calculating errors and gradients of each weight
-        for (size_t j = 0; j < data_size; ++j) {
-            double h = weights[0];
-            for (size_t k = 1; k < num_weights; ++k) {
-                h += weights[k] * x[j][k - 1];
-            }
-            errors[j] = h - y[j];
-
-            // Handle the bias term separately
-            w_gradients[0] += errors[j];
-
-            for (size_t k = 1; k < num_weights; ++k) {
-                w_gradients[k] += errors[j] * x[j][k - 1];
-            }
-        }
-
-        bool within_tolerance = true;
-
-        // Normalizing gradients, calculating steps, and updating weights
-        for (size_t j = 0; j < num_weights; ++j) {
-            w_gradients[j] *= inv_data_size;
-            step[j] = -learn_rate * w_gradients[j];
-            weights[j] += step[j];
-
-            if (std::fabs(step[j]) > tolerance)
-                within_tolerance = false;
-        }
-
-        if (within_tolerance)
-            break;
-    }
+    gd_matrix_t X = gd_matrix(data_size, num_weights - 1, GD_ROW_MAJOR, x.data());
+    gd_fit(&X, y.data(), weights.data(), learn_rate, n_iter, tolerance, errors.data());
 
     return weights;
 }
@@ -80,7 +46,7 @@ std::vector<double> gradient_descent(
 //     size_t num_weights = 3;
 
 //     // Assuming x and y are initialized with appropriate values
-//     std::vector<std::vector<double>> x(data_size, std::vector<double>(num_weights - 1));
+//     std::vector<double> x(data_size * (num_weights - 1));
 //     std::vector<double> y(data_size);
 
 //     // Call gradient_descent with default parameters
@@ -101,7 +67,7 @@ std::vector<double> gradient_descent(
 
 int main(void)
 {
-    const std::vector<std::vector<double>> x{{5}, {15}, {25}, {35}, {45}, {55}};
+    const std::vector<double> x{5, 15, 25, 35, 45, 55};
     const std::vector<double> y{5, 20, 14, 32, 22, 38};
     // std::vector<double> weights{0.5, 0.5};
 
@@ -116,10 +82,13 @@ int main(void)
         DATA_SIZE,
         N_WEIGHTS,
         x,
-        y
-        );
+        y,
+        {},
+        learn_rate,
+        n_iter,
+        tolerance);
 
-    for (int i = 0; i < weights.size(); ++i)
+    for (size_t i = 0; i < weights.size(); ++i)
     {
         std::cout << weights[i] << " ";
     }
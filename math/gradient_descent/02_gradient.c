@@ -8,15 +8,16 @@ and 2D x-array
 #include <stdlib.h>
 #include <stdbool.h>
 #include <assert.h>
-#include <string.h>
 #include "02_gradient.h"
+#include "gradient.h"
+#include "least_squares.h"
 
 #define DATA_SIZE 6
 #define N_WEIGHTS 2
 
 int main(void)
 {
-    const double x[DATA_SIZE][N_WEIGHTS - 1] = {5, 15, 25, 35, 45, 55};
+    const double x[DATA_SIZE][N_WEIGHTS - 1] = {{5}, {15}, {25}, {35}, {45}, {55}};
     const double y[DATA_SIZE] = {5, 20, 14, 32, 22, 38};
     double weights[N_WEIGHTS] = {0.5, 0.5};
     double learn_rate = 0.0008;
@@ -37,6 +38,15 @@ int main(void)
     show_array(errors, DATA_SIZE);
     printf("Cost funtions: %lf\n", cost_function(errors, DATA_SIZE));
     free(errors);
+
+    // The same fit solved directly
+    gd_matrix_t X = gd_matrix(DATA_SIZE, N_WEIGHTS - 1, GD_ROW_MAJOR, &x[0][0]);
+    double exact[N_WEIGHTS] = {0};
+
+    if (gd_solve_normal(&X, y, exact) == 0)
+        show_array(exact, N_WEIGHTS);
+    if (gd_solve_qr(&X, y, exact) == 0)
+        show_array(exact, N_WEIGHTS);
 }
 
 void show_array(const double *arr, size_t n)
@@ -67,58 +77,11 @@ double *gradient_descent(
     size_t n_iter,
     double tolerance)
 {
-    double *errors = malloc(sizeof(*errors) * data_size);
-    double *step = malloc(sizeof(*step) * num_weights);
-    double *w_gradients = malloc(sizeof(*w_gradients) * num_weights);
+    // The rows of x are contiguous, so x is already a row-major matrix
+    gd_matrix_t X = gd_matrix(data_size, num_weights - 1, GD_ROW_MAJOR, &x[0][0]);
 
+    double *errors = gd_fit(&X, y, weights, learn_rate, n_iter, tolerance, NULL);
     check_mem_alloc(errors);
-    check_mem_alloc(step);
-    check_mem_alloc(w_gradients);
-
-    memset(w_gradients, 0, sizeof(*w_gradients) * num_weights);
-
-    // Reducing division overhead by calculating reciprocal of data size
-    double inv_data_size = 1.0 / (double)data_size;
-
-    for (size_t i = 0; i < n_iter; ++i)
-    {
-        // Calculating errors and gradients of each weight
-        for (size_t j = 0; j < data_size; ++j)
-        {
-            double h = hypothesis(num_weights, weights, x[j]);
-            errors[j] = h - y[j];
-
-            // Handle the bias term separately
-            w_gradients[0] += errors[j];
-
-            for (size_t k = 1; k < num_weights; ++k)
-            {
-                w_gradients[k] += errors[j] * x[j][k - 1];
-            }
-        }
-
-        bool within_tolerance = true;
-
-        // Normalizing gradients, calculating steps and updating weights
-        for (size_t j = 0; j < num_weights; ++j)
-        {
-            w_gradients[j] *= inv_data_size;
-            step[j] = -learn_rate * w_gradients[j];
-            weights[j] += step[j];
-
-            if (fabs(step[j]) > tolerance)
-                within_tolerance = false;
-
-            // Resetting gradients for next iteration
-            w_gradients[j] = 0.0;
-        }
-
-        if (within_tolerance)
-            break;
-    }
-
-    free(step);
-    free(w_gradients);
 
     return errors;
 }
@@ -142,11 +105,5 @@ double hypothesis(
 
 double cost_function(const double errors[], size_t n)
 {
-    assert(n != 0);
-    double sum_of_squared_errs = 0.0;
-    for (size_t i = 0; i < n; ++i)
-    {
-        sum_of_squared_errs += errors[i] * errors[i];
-    }
-    return sum_of_squared_errs / (2.0 * (double)n);
+    return gd_cost(n, errors);
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <assert.h>
 #include <string.h>
 #include <stdint.h>
+#include "gradient.h"
 
 inline double hypothesis(
     size_t n_features,
@@ -41,10 +42,8 @@ double *make_predictions(
         return NULL;
     }
 
-    for (size_t i = 0; i < n_samples; ++i)
-    {
-        y_preds[i] = hypothesis(n_features, X[i], weights);
-    }
+    gd_matrix_t matrix = gd_matrix(n_samples, n_features, GD_ROW_MAJOR, &X[0][0]);
+    gd_predict(&matrix, weights, y_preds);
 
     return y_preds;
 }
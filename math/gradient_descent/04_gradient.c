@@ -0,0 +1,94 @@
+/*
+Performs mini-batch and stochastic gradient descent
+on a dataset read from disk
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "gradient.h"
+#include "minibatch.h"
+
+#define DATA_SIZE 100000
+#define N_FEATURES 2
+#define DATASET "04_gradient.vec"
+
+void check_mem_alloc(void *p);
+
+void show_array(const double *arr, size_t n);
+
+void fit(gd_source_t *source, const gd_matrix_t *X, const double y[], size_t batch_size, double learn_rate);
+
+int main(void)
+{
+    double *x = malloc(sizeof(*x) * DATA_SIZE * N_FEATURES);
+    double *y = malloc(sizeof(*y) * DATA_SIZE);
+    check_mem_alloc(x);
+    check_mem_alloc(y);
+
+    // y = 3 + 2 * x0 - x1 plus noise
+    srand(1);
+    for (size_t i = 0; i < DATA_SIZE; ++i)
+    {
+        x[i * N_FEATURES] = rand() / (double)RAND_MAX;
+        x[i * N_FEATURES + 1] = rand() / (double)RAND_MAX;
+        y[i] = 3 + 2 * x[i * N_FEATURES] - x[i * N_FEATURES + 1] + 0.1 * (rand() / (double)RAND_MAX - 0.5);
+    }
+
+    gd_matrix_t X = gd_matrix(DATA_SIZE, N_FEATURES, GD_ROW_MAJOR, x);
+    if (gd_dataset_save(DATASET, &X, y) != 0)
+        return EXIT_FAILURE;
+
+    gd_source_t *file = gd_source_file(DATASET, N_FEATURES);
+    gd_source_t *map = gd_source_map(DATASET, N_FEATURES);
+    check_mem_alloc(file);
+    check_mem_alloc(map);
+
+    printf("Mini-batch, read from file\n");
+    fit(file, &X, y, 64, 0.1);
+
+    printf("Stochastic, mapped\n");
+    fit(map, &X, y, 1, 0.01);
+
+    gd_source_close(file);
+    gd_source_close(map);
+    unlink(DATASET);
+    free(x);
+    free(y);
+}
+
+void fit(gd_source_t *source, const gd_matrix_t *X, const double y[], size_t batch_size, double learn_rate)
+{
+    double weights[N_FEATURES + 1] = {0.5, 0.5, 0.5};
+    size_t n_epochs = 20;
+    double tolerance = 1e-06;
+    uint64_t seed = 42;
+
+    size_t epochs = gd_fit_batches(source, weights, batch_size, learn_rate, n_epochs, tolerance, seed);
+
+    double *errors = malloc(sizeof(*errors) * DATA_SIZE);
+    check_mem_alloc(errors);
+    gd_errors(X, y, weights, errors);
+
+    show_array(weights, N_FEATURES + 1);
+    printf("Epochs: %zu, cost funtion: %lf\n", epochs, gd_cost(DATA_SIZE, errors));
+    free(errors);
+}
+
+void show_array(const double *arr, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        printf("%lf ", arr[i]);
+    }
+    printf("\n");
+}
+
+void check_mem_alloc(void *p)
+{
+    if (p == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+}
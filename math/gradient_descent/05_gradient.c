@@ -0,0 +1,59 @@
+/*
+Fits the data of 02_gradient with every optimizer
+and compares the steps they take
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "gradient.h"
+#include "optimizer.h"
+
+#define DATA_SIZE 6
+#define N_WEIGHTS 2
+
+void show_array(const double *arr, size_t n);
+
+int main(void)
+{
+    const double x[DATA_SIZE][N_WEIGHTS - 1] = {{5}, {15}, {25}, {35}, {45}, {55}};
+    const double y[DATA_SIZE] = {5, 20, 14, 32, 22, 38};
+    size_t n_iter = 100000;
+    double tolerance = 1e-06;
+
+    gd_matrix_t X = gd_matrix(DATA_SIZE, N_WEIGHTS - 1, GD_ROW_MAJOR, &x[0][0]);
+    const gd_method_t methods[] = {GD_SGD, GD_MOMENTUM, GD_NESTEROV, GD_ADAM, GD_ADAMW, GD_LBFGS};
+
+    for (size_t i = 0; i < sizeof(methods) / sizeof(methods[0]); ++i)
+    {
+        gd_optimizer_config_t config = gd_optimizer_config(methods[i]);
+
+        // The weights are far from order one, so Adam takes larger steps
+        if (methods[i] == GD_ADAM || methods[i] == GD_ADAMW)
+            config.learn_rate = 0.05;
+
+        gd_optimizer_t *optimizer = gd_optimizer_create(&config, N_WEIGHTS);
+        if (optimizer == NULL)
+            return EXIT_FAILURE;
+
+        double weights[N_WEIGHTS] = {0.5, 0.5};
+        size_t steps = gd_fit_optimizer(&X, y, weights, optimizer, n_iter, tolerance);
+
+        double errors[DATA_SIZE];
+        gd_errors(&X, y, weights, errors);
+
+        printf("%-9s steps: %6zu, cost function: %lf, weights: ", gd_method_name(methods[i]), steps,
+               gd_cost(DATA_SIZE, errors));
+        show_array(weights, N_WEIGHTS);
+
+        gd_optimizer_destroy(optimizer);
+    }
+}
+
+void show_array(const double *arr, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        printf("%lf ", arr[i]);
+    }
+    printf("\n");
+}
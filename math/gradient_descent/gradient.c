@@ -0,0 +1,375 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include <assert.h>
+#include "gradient.h"
+#include "../vector/vector_kernels.h"
+#include "../vector/vector_sum.h"
+#include "../vector/vector_parallel.h"
+
+gd_matrix_t gd_matrix(size_t n_samples, size_t n_features, gd_layout_t layout, const double data[])
+{
+    return (gd_matrix_t){.n_samples = n_samples, .n_features = n_features, .layout = layout, .data = data};
+}
+
+size_t gd_block_rows(const gd_matrix_t *X)
+{
+    size_t row_bytes = sizeof(double) * (X->n_features > 0 ? X->n_features : 1);
+    size_t rows = GD_BLOCK_BYTES / row_bytes;
+
+    if (rows < KERNEL_LANES)
+        return KERNEL_LANES;
+    return rows < GD_BLOCK_ROWS ? rows : GD_BLOCK_ROWS;
+}
+
+// Predictions for rows first .. first + len - 1
+static void predict_block(const gd_matrix_t *X, const double weights[], size_t first, size_t len, double out[])
+{
+    size_t n = X->n_samples;
+    size_t m = X->n_features;
+
+    if (X->layout == GD_ROW_MAJOR)
+    {
+        // One dot product along each contiguous row
+        kernel_gemv(len, m, out, X->data + first * m, weights + 1);
+
+        for (size_t i = 0; i < len; ++i)
+            out[i] += weights[0];
+    }
+    else
+    {
+        // Every column of the block is added into its predictions
+        for (size_t i = 0; i < len; ++i)
+            out[i] = weights[0];
+
+        for (size_t k = 0; k < m; ++k)
+            kernel_axpy(len, out, weights[k + 1], X->data + k * n + first);
+    }
+}
+
+// Adds the unnormalized gradient of rows first .. first + len - 1 with errors errors[0 .. len - 1]
+static void gradient_block(const gd_matrix_t *X, const double errors[], size_t first, size_t len, double gradient[])
+{
+    size_t n = X->n_samples;
+    size_t m = X->n_features;
+
+    gradient[0] += kernel_sum(len, errors);
+
+    if (X->layout == GD_ROW_MAJOR)
+    {
+        // Each row scaled by its error is added into the gradient
+        kernel_gemv_t(len, m, gradient + 1, X->data + first * m, errors);
+    }
+    else
+    {
+        for (size_t k = 0; k < m; ++k)
+            gradient[k + 1] += kernel_dot(len, X->data + k * n + first, errors);
+    }
+}
+
+// Rows per task, a whole number of blocks
+static size_t task_rows(const gd_matrix_t *X)
+{
+    return gd_block_rows(X) * GD_TASK_BLOCKS;
+}
+
+static size_t n_tasks(const gd_matrix_t *X)
+{
+    size_t rows = task_rows(X);
+    return (X->n_samples + rows - 1) / rows;
+}
+
+// Doubles per task accumulator, whole cache lines so neighbours never share one
+static size_t partial_stride(const gd_matrix_t *X)
+{
+    size_t per_line = GD_CACHE_LINE / sizeof(double);
+    return (X->n_features + 1 + per_line - 1) / per_line * per_line;
+}
+
+/*
+One sweep over X, split into tasks of task_rows() rows. With weights the
+task writes predictions to out, minus y when y is given. With partials
+it adds the gradient of its rows, from the errors in out, into its own
+accumulator partials + index * stride.
+*/
+typedef struct sweep_t
+{
+    const gd_matrix_t *X;
+    const double *y;
+    const double *weights;
+    double *out;
+    double *partials;
+    size_t stride;
+} sweep_t;
+
+static void sweep_task(void *ctx, size_t index)
+{
+    const sweep_t *job = ctx;
+    const gd_matrix_t *X = job->X;
+    size_t rows = gd_block_rows(X);
+    size_t first = index * task_rows(X);
+    size_t last = first + task_rows(X) < X->n_samples ? first + task_rows(X) : X->n_samples;
+    double *gradient = job->partials != NULL ? job->partials + index * job->stride : NULL;
+
+    if (gradient != NULL)
+    {
+        for (size_t k = 0; k <= X->n_features; ++k)
+            gradient[k] = 0.0;
+    }
+
+    // Both passes over a block before the next, so X is read from memory once
+    for (size_t start = first; start < last; start += rows)
+    {
+        size_t len = last - start < rows ? last - start : rows;
+        double *block = job->out + start;
+
+        if (job->weights != NULL)
+            predict_block(X, job->weights, start, len, block);
+        if (job->y != NULL)
+            kernel_sub(len, block, block, job->y + start);
+        if (gradient != NULL)
+            gradient_block(X, block, start, len, gradient);
+    }
+}
+
+/*
+Runs the tasks on the thread pool when X is large enough, then adds the
+task gradients in a pairwise tree whose shape depends only on the number
+of tasks and scales the sum into gradient. partials holds n_tasks()
+accumulators of partial_stride() doubles, or is NULL when there is no
+gradient to compute.
+*/
+static void sweep(sweep_t *job, double partials[], double gradient[])
+{
+    const gd_matrix_t *X = job->X;
+    size_t tasks = n_tasks(X);
+
+    job->partials = partials;
+    job->stride = partial_stride(X);
+
+    if (tasks > 1 && X->n_samples * (X->n_features + 1) >= parallel_threshold())
+    {
+        parallel_for(tasks, sweep_task, job);
+    }
+    else
+    {
+        for (size_t i = 0; i < tasks; ++i)
+            sweep_task(job, i);
+    }
+
+    if (partials == NULL)
+        return;
+
+    for (size_t step = 1; step < tasks; step *= 2)
+    {
+        for (size_t i = 0; i + step < tasks; i += 2 * step)
+            kernel_add(X->n_features + 1, partials + i * job->stride, partials + i * job->stride,
+                       partials + (i + step) * job->stride);
+    }
+
+    kernel_scale(X->n_features + 1, gradient, partials, 1.0 / (double)X->n_samples);
+}
+
+// Task accumulators for X, NULL on allocation failure
+static double *alloc_partials(const gd_matrix_t *X)
+{
+    size_t bytes = sizeof(double) * n_tasks(X) * partial_stride(X);
+    double *partials = aligned_alloc(GD_CACHE_LINE, bytes > 0 ? bytes : GD_CACHE_LINE);
+
+    if (partials == NULL)
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+    return partials;
+}
+
+void gd_predict(const gd_matrix_t *X, const double weights[], double predictions[])
+{
+    sweep_t job = {.X = X, .weights = weights, .out = predictions};
+    sweep(&job, NULL, NULL);
+}
+
+void gd_errors(const gd_matrix_t *X, const double y[], const double weights[], double errors[])
+{
+    sweep_t job = {.X = X, .y = y, .weights = weights, .out = errors};
+    sweep(&job, NULL, NULL);
+}
+
+int gd_gradient(const gd_matrix_t *X, const double errors[], double gradient[])
+{
+    assert(X->n_samples != 0);
+
+    double *partials = alloc_partials(X);
+    if (partials == NULL)
+        return -1;
+
+    // Only read, the task writes to out when weights are given
+    sweep_t job = {.X = X, .out = (double *)errors};
+    sweep(&job, partials, gradient);
+    free(partials);
+    return 0;
+}
+
+int gd_errors_gradient(const gd_matrix_t *X, const double y[], const double weights[], double errors[],
+                       double gradient[])
+{
+    assert(X->n_samples != 0);
+
+    double *partials = alloc_partials(X);
+    if (partials == NULL)
+        return -1;
+
+    sweep_t job = {.X = X, .y = y, .weights = weights, .out = errors};
+    sweep(&job, partials, gradient);
+    free(partials);
+    return 0;
+}
+
+double gd_cost(size_t n, const double errors[])
+{
+    assert(n != 0);
+    double sum_of_squared_errs = dot_array(sum_policy(), n, errors, errors);
+    return sum_of_squared_errs / (2.0 * (double)n);
+}
+
+struct gd_workspace_t
+{
+    size_t max_samples;
+    size_t n_features;
+    double *errors;
+    double *partials;
+};
+
+gd_workspace_t *gd_workspace_create(size_t max_samples, size_t n_features)
+{
+    gd_workspace_t *workspace = malloc(sizeof(*workspace));
+    if (workspace == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        return NULL;
+    }
+
+    // Task boundaries depend only on the number of features, so fewer samples need no more accumulators
+    gd_matrix_t largest = gd_matrix(max_samples, n_features, GD_ROW_MAJOR, NULL);
+
+    workspace->max_samples = max_samples;
+    workspace->n_features = n_features;
+    workspace->errors = malloc(sizeof(double) * (max_samples > 0 ? max_samples : 1));
+    workspace->partials = workspace->errors != NULL ? alloc_partials(&largest) : NULL;
+
+    if (workspace->errors == NULL || workspace->partials == NULL)
+    {
+        if (workspace->errors == NULL)
+            fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        gd_workspace_destroy(workspace);
+        return NULL;
+    }
+
+    return workspace;
+}
+
+void gd_workspace_destroy(gd_workspace_t *workspace)
+{
+    if (workspace == NULL)
+        return;
+
+    free(workspace->errors);
+    free(workspace->partials);
+    free(workspace);
+}
+
+// Checks that X fits the buffers of workspace
+static void check_workspace(const gd_workspace_t *workspace, const gd_matrix_t *X)
+{
+    assert(X->n_samples != 0 && X->n_samples <= workspace->max_samples);
+    assert(X->n_features == workspace->n_features);
+    (void)workspace;
+    (void)X;
+}
+
+void gd_gradient_with(gd_workspace_t *workspace, const gd_matrix_t *X, const double errors[], double gradient[])
+{
+    check_workspace(workspace, X);
+
+    sweep_t job = {.X = X, .out = (double *)errors};
+    sweep(&job, workspace->partials, gradient);
+}
+
+void gd_errors_gradient_with(gd_workspace_t *workspace, const gd_matrix_t *X, const double y[],
+                             const double weights[], double gradient[])
+{
+    check_workspace(workspace, X);
+
+    sweep_t job = {.X = X, .y = y, .weights = weights, .out = workspace->errors};
+    sweep(&job, workspace->partials, gradient);
+}
+
+const double *gd_workspace_errors(const gd_workspace_t *workspace)
+{
+    return workspace->errors;
+}
+
+double gd_cost_gradient(gd_workspace_t *workspace, const gd_matrix_t *X, const double y[], const double weights[],
+                        double gradient[])
+{
+    gd_errors_gradient_with(workspace, X, y, weights, gradient);
+    return gd_cost(X->n_samples, workspace->errors);
+}
+
+double *gd_fit(const gd_matrix_t *X, const double y[], double weights[], double learn_rate, size_t n_iter,
+               double tolerance, double errors[])
+{
+    size_t num_weights = X->n_features + 1;
+
+    if (X->n_samples == 0)
+    {
+        fprintf(stderr, "%s: no samples\n", __func__);
+        return NULL;
+    }
+
+    // Allocated once, every iteration reuses the pool's threads and these buffers
+    double *gradient = malloc(sizeof(*gradient) * num_weights);
+    double *partials = alloc_partials(X);
+    bool allocated = false;
+
+    if (errors == NULL)
+    {
+        errors = malloc(sizeof(*errors) * X->n_samples);
+        allocated = true;
+    }
+
+    if (gradient == NULL || partials == NULL || errors == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        free(gradient);
+        free(partials);
+        if (allocated)
+            free(errors);
+        return NULL;
+    }
+
+    sweep_t job = {.X = X, .y = y, .weights = weights, .out = errors};
+
+    for (size_t i = 0; i < n_iter; ++i)
+    {
+        sweep(&job, partials, gradient);
+
+        bool within_tolerance = true;
+
+        for (size_t j = 0; j < num_weights; ++j)
+        {
+            double step = -learn_rate * gradient[j];
+            weights[j] += step;
+
+            if (fabs(step) > tolerance)
+                within_tolerance = false;
+        }
+
+        if (within_tolerance)
+            break;
+    }
+
+    free(gradient);
+    free(partials);
+
+    return errors;
+}
@@ -0,0 +1,139 @@
+#ifndef GRADIENT_H_
+
+#define GRADIENT_H_
+
+#include <stddef.h>
+
+/*
+Batch gradient descent for linear regression on a design matrix.
+
+The n_samples x n_features matrix X is stored contiguously, row-major
+(one sample after another) or column-major (one feature after another),
+and the model is
+
+    y = weights[0] + weights[1] * x[0] + ... + weights[n_features] * x[n_features - 1]
+
+so weights holds n_features + 1 values with the bias first. Every
+iteration makes two matrix-vector passes over X, predictions X * w and
+gradient X^T * errors, with the SIMD kernels of vector_kernels.h. Rows are
+processed in blocks of about GD_BLOCK_BYTES, and gd_fit() makes both
+passes over a block while it is still in L2, so X is read from memory
+once per iteration.
+
+    gd_matrix_t X = gd_matrix(n_samples, n_features, GD_ROW_MAJOR, data);
+    double *errors = gd_fit(&X, y, weights, 0.0008, 100000, 1e-06, NULL);
+
+Each sweep is split into tasks of GD_TASK_BLOCKS blocks. When X has at
+least parallel_threshold() elements the tasks run on the persistent
+thread pool of vector_parallel.h, so an iteration costs no thread
+creation. Every task accumulates its gradient in its own buffer, padded
+to whole cache lines of GD_CACHE_LINE bytes so no two threads write to
+the same line. The buffers are added in a fixed pairwise tree, and only
+then are the weights updated, once per iteration.
+
+The block size depends only on the number of features and the task
+boundaries only on the number of samples. Results therefore depend on
+the matrix and its layout, but not on the instruction set or the number
+of threads.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum gd_layout_t
+{
+    GD_ROW_MAJOR,
+    GD_COL_MAJOR
+} gd_layout_t;
+
+typedef struct gd_matrix_t
+{
+    size_t n_samples;
+    size_t n_features;
+    gd_layout_t layout;
+    const double *data;   // n_samples * n_features values
+} gd_matrix_t;
+
+// Bytes of X per block, and most rows per block
+#define GD_BLOCK_BYTES 131072
+#define GD_BLOCK_ROWS 4096
+
+// Blocks per task handed to a thread
+#define GD_TASK_BLOCKS 8
+
+#define GD_CACHE_LINE 64
+
+gd_matrix_t gd_matrix(size_t n_samples, size_t n_features, gd_layout_t layout, const double data[]);
+
+// Rows per block of X, so that a block stays in L2 between the two passes
+size_t gd_block_rows(const gd_matrix_t *X);
+
+// predictions[i] = weights[0] + X[i] . weights[1..n_features]
+void gd_predict(const gd_matrix_t *X, const double weights[], double predictions[]);
+
+// errors[i] = prediction for sample i - y[i]
+void gd_errors(const gd_matrix_t *X, const double y[], const double weights[], double errors[]);
+
+/*
+Gradient of the cost, gradient[0] = mean of errors, gradient[k + 1] =
+X[:, k] . errors / n_samples. Allocates the task accumulators for the
+call and returns -1, with gradient unwritten, when that fails; repeated
+calls should use gd_gradient_with().
+*/
+int gd_gradient(const gd_matrix_t *X, const double errors[], double gradient[]);
+
+// gd_errors() and gd_gradient() in one sweep over X, 0 on success and -1 like gd_gradient()
+int gd_errors_gradient(const gd_matrix_t *X, const double y[], const double weights[], double errors[],
+                       double gradient[]);
+
+// Mean squared error over 2
+double gd_cost(size_t n, const double errors[]);
+
+typedef struct gd_workspace_t gd_workspace_t;
+
+/*
+Buffers for the _with functions and gd_cost_gradient() on up to
+max_samples samples of n_features features, NULL on error. Those never
+allocate; X has at most the max_samples and exactly the n_features of
+the workspace.
+*/
+gd_workspace_t *gd_workspace_create(size_t max_samples, size_t n_features);
+
+void gd_workspace_destroy(gd_workspace_t *workspace);
+
+// gd_gradient() on the accumulators of workspace
+void gd_gradient_with(gd_workspace_t *workspace, const gd_matrix_t *X, const double errors[], double gradient[]);
+
+/*
+gd_errors_gradient() with the errors kept in the workspace. With y NULL
+they are the predictions, and gradient is [1 X]^T [1 X] weights / n_samples.
+*/
+void gd_errors_gradient_with(gd_workspace_t *workspace, const gd_matrix_t *X, const double y[],
+                             const double weights[], double gradient[]);
+
+// Errors of the last sweep of workspace, one per sample of its X
+const double *gd_workspace_errors(const gd_workspace_t *workspace);
+
+/*
+gd_errors_gradient_with() and gd_cost() in one sweep. Writes the
+gradient at weights and returns the cost, the errors stay in the
+workspace.
+*/
+double gd_cost_gradient(gd_workspace_t *workspace, const gd_matrix_t *X, const double y[], const double weights[],
+                        double gradient[]);
+
+/*
+Runs up to n_iter iterations of batch gradient descent on weights, and
+stops after the first update whose steps are all within tolerance. The
+errors of the last iteration are written to errors, which is allocated
+when NULL, and returned.
+*/
+double *gd_fit(const gd_matrix_t *X, const double y[], double weights[], double learn_rate, size_t n_iter,
+               double tolerance, double errors[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,405 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <float.h>
+#include "least_squares.h"
+#include "../vector/vector_kernels.h"
+#include "../vector/vector_parallel.h"
+
+/* ---------------------------- Cholesky ---------------------------- */
+
+int gd_cholesky(size_t n, double a[])
+{
+    for (size_t kb = 0; kb < n; kb += GD_CHOLESKY_BLOCK)
+    {
+        size_t nb = n - kb < GD_CHOLESKY_BLOCK ? n - kb : GD_CHOLESKY_BLOCK;
+        size_t end = kb + nb;
+
+        // Diagonal block, the columns before kb are already subtracted
+        for (size_t j = kb; j < end; ++j)
+        {
+            double *row_j = a + j * n;
+            double d = row_j[j] - kernel_dot(j - kb, row_j + kb, row_j + kb);
+
+            if (!(d > 0.0))
+            {
+                fprintf(stderr, "%s: matrix is not positive definite at column %zu\n", __func__, j);
+                return -1;
+            }
+
+            row_j[j] = sqrt(d);
+            for (size_t i = j + 1; i < end; ++i)
+            {
+                double *row_i = a + i * n;
+                row_i[j] = (row_i[j] - kernel_dot(j - kb, row_i + kb, row_j + kb)) / row_j[j];
+            }
+        }
+
+        // Panel below the diagonal block, solved against its transpose
+        for (size_t i = end; i < n; ++i)
+        {
+            double *row_i = a + i * n;
+            for (size_t j = kb; j < end; ++j)
+            {
+                const double *row_j = a + j * n;
+                row_i[j] = (row_i[j] - kernel_dot(j - kb, row_i + kb, row_j + kb)) / row_j[j];
+            }
+        }
+
+        // Trailing matrix, every entry minus the dot product of two contiguous panel rows
+        for (size_t i = end; i < n; ++i)
+        {
+            double *row_i = a + i * n;
+            for (size_t j = end; j <= i; ++j)
+                row_i[j] -= kernel_dot(nb, row_i + kb, a + j * n + kb);
+        }
+    }
+
+    return 0;
+}
+
+void gd_cholesky_solve(size_t n, const double l[], const double b[], double x[])
+{
+    if (x != b)
+        memcpy(x, b, sizeof(*x) * n);
+
+    // L * z = b, by rows
+    for (size_t i = 0; i < n; ++i)
+        x[i] = (x[i] - kernel_dot(i, l + i * n, x)) / l[i * n + i];
+
+    // L^T * x = z, by columns of L^T, which are the contiguous rows of L
+    for (size_t i = n; i-- > 0;)
+    {
+        x[i] /= l[i * n + i];
+        kernel_axpy(i, x, -x[i], l + i * n);
+    }
+}
+
+/* ---------------------------- Normal equations ---------------------------- */
+
+/*
+Adds [1 X]^T [1 X] to the lower triangle of a and [1 X]^T y to b, one
+block of rows at a time. Row-major blocks are added one column of the
+block at a time with kernel_gemv_t(), which fills whole rows of a;
+column-major blocks use dot products of their contiguous columns.
+*/
+static bool normal_equations(const gd_matrix_t *X, const double y[], double a[], double b[])
+{
+    size_t n = X->n_samples;
+    size_t m = X->n_features;
+    size_t p = m + 1;
+    size_t rows = gd_block_rows(X);
+    double *column = malloc(sizeof(*column) * rows);
+
+    if (column == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        return false;
+    }
+
+    memset(a, 0, sizeof(*a) * p * p);
+    memset(b, 0, sizeof(*b) * p);
+    a[0] = (double)n;
+
+    for (size_t first = 0; first < n; first += rows)
+    {
+        size_t len = n - first < rows ? n - first : rows;
+        const double *y_block = y + first;
+
+        b[0] += kernel_sum(len, y_block);
+
+        if (X->layout == GD_ROW_MAJOR)
+        {
+            const double *block = X->data + first * m;
+
+            kernel_gemv_t(len, m, b + 1, block, y_block);
+            for (size_t k = 0; k < m; ++k)
+            {
+                for (size_t i = 0; i < len; ++i)
+                    column[i] = block[i * m + k];
+
+                a[(k + 1) * p] += kernel_sum(len, column);
+                kernel_gemv_t(len, m, a + (k + 1) * p + 1, block, column);
+            }
+        }
+        else
+        {
+            for (size_t k = 0; k < m; ++k)
+            {
+                const double *col_k = X->data + k * n + first;
+
+                b[k + 1] += kernel_dot(len, col_k, y_block);
+                a[(k + 1) * p] += kernel_sum(len, col_k);
+                for (size_t j = 0; j <= k; ++j)
+                    a[(k + 1) * p + j + 1] += kernel_dot(len, col_k, X->data + j * n + first);
+            }
+        }
+    }
+
+    free(column);
+    return true;
+}
+
+int gd_solve_normal(const gd_matrix_t *X, const double y[], double weights[])
+{
+    size_t p = X->n_features + 1;
+    double *a = malloc(sizeof(*a) * p * p);
+    double *b = malloc(sizeof(*b) * p);
+    int status = -1;
+
+    if (a == NULL || b == NULL)
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+    else if (normal_equations(X, y, a, b) && gd_cholesky(p, a) == 0)
+    {
+        gd_cholesky_solve(p, a, b, weights);
+        status = 0;
+    }
+
+    free(a);
+    free(b);
+    return status;
+}
+
+/* ---------------------------- QR ---------------------------- */
+
+// Reflection of column k applied to the columns after it
+typedef struct reflect_t
+{
+    double *a;          // Column-major n x p
+    size_t n;
+    size_t k;
+    double tau;
+} reflect_t;
+
+// Applies I - tau * v * v^T, v in a[k..n-1] of column k, to a[k..n-1] of column k + 1 + j
+static void reflect_column(void *ctx, size_t j)
+{
+    const reflect_t *r = ctx;
+    const double *v = r->a + r->k * r->n + r->k;
+    double *c = r->a + (r->k + 1 + j) * r->n + r->k;
+    size_t len = r->n - r->k;
+
+    kernel_axpy(len, c, -r->tau * kernel_dot(len, v, c), v);
+}
+
+int gd_solve_qr(const gd_matrix_t *X, const double y[], double weights[])
+{
+    size_t n = X->n_samples;
+    size_t m = X->n_features;
+    size_t p = m + 1;
+
+    if (n < p)
+    {
+        fprintf(stderr, "%s: %zu samples cannot determine %zu weights\n", __func__, n, p);
+        return -1;
+    }
+
+    // [1 X y] column-major, y last so every reflection reaches it
+    double *a = malloc(sizeof(*a) * n * (p + 1));
+    if (a == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        return -1;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+        a[i] = 1.0;
+    for (size_t k = 0; k < m; ++k)
+    {
+        double *col = a + (k + 1) * n;
+        if (X->layout == GD_COL_MAJOR)
+            memcpy(col, X->data + k * n, sizeof(*col) * n);
+        else
+            for (size_t i = 0; i < n; ++i)
+                col[i] = X->data[i * m + k];
+    }
+    memcpy(a + p * n, y, sizeof(*y) * n);
+
+    double largest = 0.0;
+    for (size_t k = 0; k < p; ++k)
+    {
+        double *x = a + k * n + k;
+        size_t len = n - k;
+        double norm = sqrt(kernel_dot(len, x, x));
+        double alpha = x[0] >= 0.0 ? -norm : norm;
+
+        if (norm > 0.0)
+        {
+            // v = x - alpha * e1 overwrites x, v^T v = 2 * norm * (norm + |x[0]|)
+            reflect_t r = {.a = a, .n = n, .k = k, .tau = 1.0 / (norm * (norm + fabs(x[0])))};
+            x[0] -= alpha;
+
+            size_t columns = p - k;
+            if (len * columns >= parallel_threshold())
+                parallel_for(columns, reflect_column, &r);
+            else
+                for (size_t j = 0; j < columns; ++j)
+                    reflect_column(&r, j);
+        }
+
+        // R[k][k]
+        x[0] = alpha;
+        largest = fabs(alpha) > largest ? fabs(alpha) : largest;
+    }
+
+    // R is in the upper triangle of the first p columns, Q^T y in the first p rows of the last
+    const double *qty = a + p * n;
+    int status = 0;
+
+    for (size_t k = p; k-- > 0;)
+    {
+        double r_kk = a[k * n + k];
+        if (fabs(r_kk) <= (double)p * DBL_EPSILON * largest)
+        {
+            fprintf(stderr, "%s: features are linearly dependent at weight %zu\n", __func__, k);
+            status = -1;
+            break;
+        }
+
+        double s = qty[k];
+        for (size_t j = k + 1; j < p; ++j)
+            s -= a[j * n + k] * weights[j];
+        weights[k] = s / r_kk;
+    }
+
+    free(a);
+    return status;
+}
+
+/* ---------------------------- Conjugate gradients ---------------------------- */
+
+size_t gd_cg(size_t n, gd_operator_t apply, void *ctx, const double b[], double x[], size_t max_iter,
+             double tolerance)
+{
+    double *r = malloc(sizeof(*r) * n);
+    double *p = malloc(sizeof(*p) * n);
+    double *q = malloc(sizeof(*q) * n);
+
+    if (r == NULL || p == NULL || q == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        free(r);
+        free(p);
+        free(q);
+        return 0;
+    }
+
+    // r = b - A * x
+    apply(ctx, x, q);
+    kernel_sub(n, r, b, q);
+    memcpy(p, r, sizeof(*p) * n);
+
+    double stop = tolerance * sqrt(kernel_dot(n, b, b));
+    double rr = kernel_dot(n, r, r);
+    size_t iter = 0;
+
+    while (iter < max_iter && sqrt(rr) > stop)
+    {
+        apply(ctx, p, q);
+        double pq = kernel_dot(n, p, q);
+        if (!(pq > 0.0))
+            break;
+
+        double alpha = rr / pq;
+        kernel_axpy(n, x, alpha, p);
+        kernel_axpy(n, r, -alpha, q);
+        ++iter;
+
+        double rr_next = kernel_dot(n, r, r);
+        double beta = rr_next / rr;
+        rr = rr_next;
+
+        // p = r + beta * p
+        kernel_scale(n, p, p, beta);
+        kernel_add(n, p, p, r);
+    }
+
+    free(r);
+    free(p);
+    free(q);
+    return iter;
+}
+
+typedef struct normal_operator_t
+{
+    const gd_matrix_t *X;
+    gd_workspace_t *workspace;
+} normal_operator_t;
+
+// out = [1 X]^T [1 X] in / n_samples, one pass over X for each product
+static void normal_operator(void *ctx, const double in[], double out[])
+{
+    const normal_operator_t *op = ctx;
+    gd_errors_gradient_with(op->workspace, op->X, NULL, in, out);
+}
+
+size_t gd_solve_cg(const gd_matrix_t *X, const double y[], double weights[], size_t max_iter, double tolerance)
+{
+    size_t p = X->n_features + 1;
+    double *b = malloc(sizeof(*b) * p);
+    normal_operator_t op = {.X = X, .workspace = gd_workspace_create(X->n_samples, X->n_features)};
+
+    if (b == NULL || op.workspace == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        free(b);
+        gd_workspace_destroy(op.workspace);
+        return 0;
+    }
+
+    // b = [1 X]^T y / n_samples
+    gd_gradient_with(op.workspace, X, y, b);
+
+    size_t iter = gd_cg(p, normal_operator, &op, b, weights, max_iter, tolerance);
+
+    free(b);
+    gd_workspace_destroy(op.workspace);
+    return iter;
+}
+
+double gd_curvature(const gd_matrix_t *X)
+{
+    if (X->n_samples == 0)
+    {
+        fprintf(stderr, "%s: no samples\n", __func__);
+        return 0.0;
+    }
+
+    size_t p = X->n_features + 1;
+    double *v = malloc(sizeof(*v) * p);
+    double *av = malloc(sizeof(*av) * p);
+    normal_operator_t op = {.X = X, .workspace = gd_workspace_create(X->n_samples, X->n_features)};
+
+    if (v == NULL || av == NULL || op.workspace == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        free(v);
+        free(av);
+        gd_workspace_destroy(op.workspace);
+        return 0.0;
+    }
+
+    // Starts from every weight alike
+    for (size_t k = 0; k < p; ++k)
+        v[k] = 1.0 / sqrt((double)p);
+
+    // Rayleigh quotient of the last iterate, v stays normalised
+    double lambda = 0.0;
+    for (size_t iter = 0; iter < GD_POWER_ITER; ++iter)
+    {
+        normal_operator(&op, v, av);
+        lambda = kernel_dot(p, v, av);
+
+        double norm = sqrt(kernel_dot(p, av, av));
+        if (!(norm > 0.0))
+            break;
+        kernel_scale(p, v, av, 1.0 / norm);
+    }
+
+    free(v);
+    free(av);
+    gd_workspace_destroy(op.workspace);
+    return lambda;
+}
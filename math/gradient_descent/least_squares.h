@@ -0,0 +1,86 @@
+#ifndef LEAST_SQUARES_H_
+
+#define LEAST_SQUARES_H_
+
+#include <stddef.h>
+#include "gradient.h"
+
+/*
+Direct least-squares fits of the linear model of gradient.h.
+
+Each solver finds the weights minimising the cost of gd_fit(), with the
+bias in weights[0], in a fixed amount of work instead of iterating
+towards them with a learning rate:
+
+    gd_solve_normal()  normal equations X^T X w = X^T y by a blocked Cholesky
+                       factorisation. One pass over X, then O(n_features^3).
+                       The fastest, but it squares the condition number of X.
+    gd_solve_qr()      Householder QR of a copy of X. About twice the work
+                       of the normal equations and a copy of X, but accurate
+                       when the features are nearly collinear.
+    gd_solve_cg()      conjugate gradients on the normal equations. Only
+                       products with X and X^T, each one pass over X, and
+                       the weights passed in are the starting point, so a
+                       refit from the previous weights takes a few passes.
+
+gd_curvature() estimates the largest curvature of the cost, and so the
+largest stable learning rate of the iterative fits, in a few passes.
+
+gd_cg() is the matrix-free solver behind gd_solve_cg(). It only calls
+the operator, so sparse or structured systems supply their own product.
+
+The direct solvers return 0 on success and -1, with a message, when the
+system is singular or memory runs out.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Columns per panel of the blocked Cholesky factorisation
+#define GD_CHOLESKY_BLOCK 64
+
+// Power iterations of gd_curvature()
+#define GD_POWER_ITER 10
+
+// Writes A * in to out for a symmetric positive definite A
+typedef void (*gd_operator_t)(void *ctx, const double in[], double out[]);
+
+/*
+Cholesky factorisation of the symmetric positive definite n x n
+row-major matrix a. The lower triangle is read and overwritten with L,
+a = L * L^T; the upper triangle is not used. Returns -1 if a is not
+positive definite.
+*/
+int gd_cholesky(size_t n, double a[]);
+
+// Solves L * L^T * x = b with L from gd_cholesky(), x may be b
+void gd_cholesky_solve(size_t n, const double l[], const double b[], double x[]);
+
+int gd_solve_normal(const gd_matrix_t *X, const double y[], double weights[]);
+
+int gd_solve_qr(const gd_matrix_t *X, const double y[], double weights[]);
+
+/*
+Conjugate gradients for A * x = b, starting from x. Stops once the
+residual is at most tolerance * |b| or after max_iter iterations, and
+returns the number of iterations.
+*/
+size_t gd_cg(size_t n, gd_operator_t apply, void *ctx, const double b[], double x[], size_t max_iter,
+             double tolerance);
+
+// gd_cg() on the normal equations, weights are the starting point
+size_t gd_solve_cg(const gd_matrix_t *X, const double y[], double weights[], size_t max_iter, double tolerance);
+
+/*
+Largest eigenvalue of [1 X]^T [1 X] / n_samples, the Hessian of the
+cost, by GD_POWER_ITER steps of power iteration. Gradient descent is
+stable for learning rates below 2 / gd_curvature(). Returns 0 on error.
+*/
+double gd_curvature(const gd_matrix_t *X);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
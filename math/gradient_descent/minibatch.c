@@ -0,0 +1,662 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "minibatch.h"
+#include "../vector/vector.h"
+#include "../vector/vector_io.h"
+
+typedef enum source_kind_t
+{
+    SOURCE_FILE,
+    SOURCE_MAP,
+    SOURCE_MEMORY
+} source_kind_t;
+
+struct gd_source_t
+{
+    source_kind_t kind;
+    size_t n_samples;
+    size_t n_features;
+    bool busy;                  // A set of batches is open
+    int fd;                     // SOURCE_FILE
+    const vector_t *map;        // SOURCE_MAP, records in map->arr
+    gd_matrix_t X;              // SOURCE_MEMORY
+    const double *y;
+};
+
+typedef struct slot_t
+{
+    double *x;
+    double *y;
+    size_t rows;
+    size_t epoch;
+} slot_t;
+
+struct gd_batches_t
+{
+    gd_source_t *source;
+    size_t batch_size;
+    size_t block_rows;          // Samples per slot, a multiple of batch_size
+    size_t n_epochs;
+    uint64_t seed;
+
+    slot_t slots[GD_RING_SLOTS];
+    double *staging;            // Records read from a file, owned by the producer
+    size_t *perm;               // Shuffle of a block, owned by the producer
+
+    pthread_t producer;
+    pthread_mutex_t lock;
+    pthread_cond_t filled;
+    pthread_cond_t freed;
+    size_t head;                // Next slot to fill
+    size_t tail;                // Next slot to hand out
+    size_t count;               // Filled slots, including the one handed out
+    bool held;                  // The consumer holds slots[tail]
+    size_t offset;              // First row of slots[tail] handed out last
+    bool done;
+    bool stop;
+    bool failed;
+};
+
+// Doubles per record of a dataset file
+#define RECORD(source) ((source)->n_features + 1)
+
+/* ---------------------------- Sources ---------------------------- */
+
+static gd_source_t *new_source(source_kind_t kind, size_t n_samples, size_t n_features)
+{
+    gd_source_t *s = calloc(1, sizeof(*s));
+    if (s == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        return NULL;
+    }
+
+    s->kind = kind;
+    s->n_samples = n_samples;
+    s->n_features = n_features;
+    s->fd = -1;
+    return s;
+}
+
+static bool whole_records(size_t length, size_t n_features, const char *path, const char *caller)
+{
+    if (length % (n_features + 1) != 0)
+    {
+        fprintf(stderr, "%s: %s does not hold records of %zu features and a target\n", caller, path, n_features);
+        return false;
+    }
+    return true;
+}
+
+gd_source_t *gd_source_file(const char *path, size_t n_features)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        perror(path);
+        return NULL;
+    }
+
+    struct stat st;
+    vector_file_header_t h;
+
+    if (fstat(fd, &st) != 0 || pread(fd, &h, sizeof(h), 0) != (ssize_t)sizeof(h) ||
+        memcmp(h.magic, VECTOR_FILE_MAGIC, sizeof(h.magic)) != 0 || h.version != VECTOR_FILE_VERSION ||
+        h.dtype != VECTOR_DTYPE_F64 || h.length > ((size_t)st.st_size - VECTOR_FILE_HEADER) / sizeof(double))
+    {
+        fprintf(stderr, "%s: %s is not a readable vector file\n", __func__, path);
+        close(fd);
+        return NULL;
+    }
+
+    if (!whole_records(h.length, n_features, path, __func__))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    gd_source_t *s = new_source(SOURCE_FILE, h.length / (n_features + 1), n_features);
+    if (s == NULL)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    s->fd = fd;
+    return s;
+}
+
+gd_source_t *gd_source_map(const char *path, size_t n_features)
+{
+    const vector_t *map = vector_map(path);
+    if (map == NULL)
+        return NULL;
+
+    if (!whole_records(map->size, n_features, path, __func__))
+    {
+        vector_unmap(map);
+        return NULL;
+    }
+
+    gd_source_t *s = new_source(SOURCE_MAP, map->size / (n_features + 1), n_features);
+    if (s == NULL)
+    {
+        vector_unmap(map);
+        return NULL;
+    }
+
+    s->map = map;
+    return s;
+}
+
+gd_source_t *gd_source_memory(const gd_matrix_t *X, const double y[])
+{
+    gd_source_t *s = new_source(SOURCE_MEMORY, X->n_samples, X->n_features);
+    if (s == NULL)
+        return NULL;
+
+    s->X = *X;
+    s->y = y;
+    return s;
+}
+
+void gd_source_close(gd_source_t *source)
+{
+    if (source == NULL)
+        return;
+
+    if (source->kind == SOURCE_FILE)
+        close(source->fd);
+    else if (source->kind == SOURCE_MAP)
+        vector_unmap(source->map);
+
+    free(source);
+}
+
+size_t gd_source_samples(const gd_source_t *source)
+{
+    return source->n_samples;
+}
+
+size_t gd_source_features(const gd_source_t *source)
+{
+    return source->n_features;
+}
+
+static double element(const gd_matrix_t *X, size_t i, size_t k)
+{
+    if (X->layout == GD_ROW_MAJOR)
+        return X->data[i * X->n_features + k];
+    return X->data[k * X->n_samples + i];
+}
+
+int gd_dataset_save(const char *path, const gd_matrix_t *X, const double y[])
+{
+    size_t m = X->n_features;
+    vector_t *v = vector_map_create(path, X->n_samples * (m + 1));
+    if (v == NULL)
+        return -1;
+
+    for (size_t i = 0; i < X->n_samples; ++i)
+    {
+        double *record = v->arr + i * (m + 1);
+        for (size_t k = 0; k < m; ++k)
+            record[k] = element(X, i, k);
+        record[m] = y[i];
+    }
+
+    int status = vector_sync(v);
+    vector_unmap(v);
+    return status;
+}
+
+/* ---------------------------- Shuffling ---------------------------- */
+
+static uint64_t mix(uint64_t x)
+{
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// splitmix64
+static uint64_t next_random(uint64_t *state)
+{
+    *state += 0x9e3779b97f4a7c15ULL;
+    return mix(*state);
+}
+
+// Uniform in [0, n)
+static size_t random_below(uint64_t *state, size_t n)
+{
+    return (size_t)(((unsigned __int128)next_random(state) * n) >> 64);
+}
+
+/*
+Random permutation of [0, n) that is evaluated one index at a time: a
+four round Feistel network on the smallest even number of bits covering
+n, walking the cycle until the result falls below n.
+*/
+typedef struct block_order_t
+{
+    size_t n;
+    unsigned half;
+    uint64_t mask;
+    uint64_t keys[4];
+} block_order_t;
+
+static void block_order_init(block_order_t *order, size_t n, uint64_t seed)
+{
+    unsigned bits = 2;
+    while (bits < 64 && ((uint64_t)1 << bits) < n)
+        bits += 2;
+
+    order->n = n;
+    order->half = bits / 2;
+    order->mask = ((uint64_t)1 << order->half) - 1;
+    for (size_t r = 0; r < 4; ++r)
+        order->keys[r] = next_random(&seed);
+}
+
+static size_t block_order_at(const block_order_t *order, size_t i)
+{
+    uint64_t v = i;
+    do
+    {
+        uint64_t left = v >> order->half, right = v & order->mask;
+        for (size_t r = 0; r < 4; ++r)
+        {
+            uint64_t t = left ^ (mix(right ^ order->keys[r]) & order->mask);
+            left = right;
+            right = t;
+        }
+        v = (left << order->half) | right;
+    } while (v >= order->n);
+
+    return (size_t)v;
+}
+
+/* ---------------------------- Producer ---------------------------- */
+
+// Reads len records from first on into staging, restarting short reads
+static bool read_records(gd_source_t *s, size_t first, size_t len, double staging[])
+{
+    size_t bytes = len * RECORD(s) * sizeof(double);
+    off_t offset = VECTOR_FILE_HEADER + (off_t)(first * RECORD(s) * sizeof(double));
+    unsigned char *out = (unsigned char *)staging;
+
+    while (bytes > 0)
+    {
+        ssize_t got = pread(s->fd, out, bytes, offset);
+        if (got <= 0)
+        {
+            perror(__func__);
+            return false;
+        }
+        out += got;
+        offset += got;
+        bytes -= (size_t)got;
+    }
+    return true;
+}
+
+// Copies samples first .. first + len - 1 into slot in the order of b->perm
+static bool fill_slot(gd_batches_t *b, slot_t *slot, size_t first, size_t len)
+{
+    gd_source_t *s = b->source;
+    size_t m = s->n_features;
+
+    if (s->kind == SOURCE_MEMORY)
+    {
+        for (size_t i = 0; i < len; ++i)
+        {
+            double *row = slot->x + b->perm[i] * m;
+            for (size_t k = 0; k < m; ++k)
+                row[k] = element(&s->X, first + i, k);
+            slot->y[b->perm[i]] = s->y[first + i];
+        }
+        return true;
+    }
+
+    const double *records;
+    if (s->kind == SOURCE_MAP)
+    {
+        records = s->map->arr + first * RECORD(s);
+    }
+    else
+    {
+        if (!read_records(s, first, len, b->staging))
+            return false;
+        records = b->staging;
+    }
+
+    for (size_t i = 0; i < len; ++i)
+    {
+        memcpy(slot->x + b->perm[i] * m, records + i * RECORD(s), sizeof(double) * m);
+        slot->y[b->perm[i]] = records[i * RECORD(s) + m];
+    }
+    return true;
+}
+
+static void finish(gd_batches_t *b, bool failed)
+{
+    pthread_mutex_lock(&b->lock);
+    b->done = true;
+    b->failed = failed;
+    pthread_cond_signal(&b->filled);
+    pthread_mutex_unlock(&b->lock);
+}
+
+static void *produce(void *arg)
+{
+    gd_batches_t *b = arg;
+    size_t n = b->source->n_samples;
+    size_t n_blocks = (n + b->block_rows - 1) / b->block_rows;
+
+    for (size_t epoch = 0; epoch < b->n_epochs; ++epoch)
+    {
+        uint64_t state = mix(b->seed) ^ mix(epoch + 1);
+        block_order_t order;
+        block_order_init(&order, n_blocks, next_random(&state));
+
+        for (size_t i = 0; i < n_blocks; ++i)
+        {
+            size_t first = block_order_at(&order, i) * b->block_rows;
+            size_t len = n - first < b->block_rows ? n - first : b->block_rows;
+
+            // Fisher-Yates shuffle of the samples within the block
+            for (size_t j = 0; j < len; ++j)
+                b->perm[j] = j;
+            for (size_t j = len; j > 1; --j)
+            {
+                size_t r = random_below(&state, j);
+                size_t t = b->perm[j - 1];
+                b->perm[j - 1] = b->perm[r];
+                b->perm[r] = t;
+            }
+
+            pthread_mutex_lock(&b->lock);
+            while (b->count == GD_RING_SLOTS && !b->stop)
+                pthread_cond_wait(&b->freed, &b->lock);
+            bool stop = b->stop;
+            pthread_mutex_unlock(&b->lock);
+
+            if (stop)
+                return NULL;
+
+            // The slot at head is not visible to the consumer until count is raised
+            slot_t *slot = &b->slots[b->head];
+            if (!fill_slot(b, slot, first, len))
+            {
+                finish(b, true);
+                return NULL;
+            }
+            slot->rows = len;
+            slot->epoch = epoch;
+
+            pthread_mutex_lock(&b->lock);
+            b->head = (b->head + 1) % GD_RING_SLOTS;
+            ++b->count;
+            pthread_cond_signal(&b->filled);
+            pthread_mutex_unlock(&b->lock);
+        }
+    }
+
+    finish(b, false);
+    return NULL;
+}
+
+/* ---------------------------- Batches ---------------------------- */
+
+static void free_batches(gd_batches_t *b)
+{
+    for (size_t i = 0; i < GD_RING_SLOTS; ++i)
+    {
+        free(b->slots[i].x);
+        free(b->slots[i].y);
+    }
+    free(b->staging);
+    free(b->perm);
+    free(b);
+}
+
+gd_batches_t *gd_batches_open(gd_source_t *source, size_t batch_size, size_t n_epochs, uint64_t seed)
+{
+    if (batch_size == 0 || source->n_samples == 0)
+    {
+        fprintf(stderr, "%s: batch_size and the number of samples must be positive\n", __func__);
+        return NULL;
+    }
+
+    if (source->busy)
+    {
+        fprintf(stderr, "%s: source already has open batches\n", __func__);
+        return NULL;
+    }
+
+    gd_batches_t *b = calloc(1, sizeof(*b));
+    if (b == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        return NULL;
+    }
+
+    if (batch_size > source->n_samples)
+        batch_size = source->n_samples;
+
+    size_t block_rows = (GD_BLOCK_SAMPLES + batch_size - 1) / batch_size * batch_size;
+    if (block_rows > source->n_samples)
+        block_rows = source->n_samples;
+
+    b->source = source;
+    b->batch_size = batch_size;
+    b->block_rows = block_rows;
+    b->n_epochs = n_epochs;
+    b->seed = seed;
+
+    size_t m = source->n_features;
+    bool ok = true;
+    for (size_t i = 0; i < GD_RING_SLOTS; ++i)
+    {
+        b->slots[i].x = malloc(sizeof(double) * block_rows * (m > 0 ? m : 1));
+        b->slots[i].y = malloc(sizeof(double) * block_rows);
+        ok = ok && b->slots[i].x != NULL && b->slots[i].y != NULL;
+    }
+    b->perm = malloc(sizeof(*b->perm) * block_rows);
+    ok = ok && b->perm != NULL;
+    if (source->kind == SOURCE_FILE)
+    {
+        b->staging = malloc(sizeof(double) * block_rows * RECORD(source));
+        ok = ok && b->staging != NULL;
+    }
+
+    if (!ok)
+    {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        free_batches(b);
+        return NULL;
+    }
+
+    pthread_mutex_init(&b->lock, NULL);
+    pthread_cond_init(&b->filled, NULL);
+    pthread_cond_init(&b->freed, NULL);
+
+    if (pthread_create(&b->producer, NULL, produce, b) != 0)
+    {
+        fprintf(stderr, "%s: Could not start the producer thread\n", __func__);
+        pthread_mutex_destroy(&b->lock);
+        pthread_cond_destroy(&b->filled);
+        pthread_cond_destroy(&b->freed);
+        free_batches(b);
+        return NULL;
+    }
+
+    source->busy = true;
+    return b;
+}
+
+// Hands out rows offset .. offset + batch_size - 1 of slots[tail]
+static void hand_out(const gd_batches_t *b, gd_batch_t *batch)
+{
+    const slot_t *slot = &b->slots[b->tail];
+    size_t rows = slot->rows - b->offset < b->batch_size ? slot->rows - b->offset : b->batch_size;
+    size_t m = b->source->n_features;
+
+    batch->X = gd_matrix(rows, m, GD_ROW_MAJOR, slot->x + b->offset * m);
+    batch->y = slot->y + b->offset;
+    batch->epoch = slot->epoch;
+}
+
+bool gd_batches_next(gd_batches_t *b, gd_batch_t *batch)
+{
+    // The rest of the held block needs no locking
+    if (b->held && b->offset + b->batch_size < b->slots[b->tail].rows)
+    {
+        b->offset += b->batch_size;
+        hand_out(b, batch);
+        return true;
+    }
+
+    pthread_mutex_lock(&b->lock);
+
+    if (b->held)
+    {
+        b->tail = (b->tail + 1) % GD_RING_SLOTS;
+        --b->count;
+        b->held = false;
+        pthread_cond_signal(&b->freed);
+    }
+
+    while (b->count == 0 && !b->done)
+        pthread_cond_wait(&b->filled, &b->lock);
+
+    if (b->count == 0)
+    {
+        pthread_mutex_unlock(&b->lock);
+        return false;
+    }
+
+    b->held = true;
+    b->offset = 0;
+    pthread_mutex_unlock(&b->lock);
+
+    hand_out(b, batch);
+    return true;
+}
+
+bool gd_batches_failed(const gd_batches_t *b)
+{
+    // Only set by the producer before it exits, read once next() has returned false
+    return b->failed;
+}
+
+void gd_batches_close(gd_batches_t *b)
+{
+    if (b == NULL)
+        return;
+
+    pthread_mutex_lock(&b->lock);
+    b->stop = true;
+    pthread_cond_signal(&b->freed);
+    pthread_mutex_unlock(&b->lock);
+
+    pthread_join(b->producer, NULL);
+
+    pthread_mutex_destroy(&b->lock);
+    pthread_cond_destroy(&b->filled);
+    pthread_cond_destroy(&b->freed);
+
+    b->source->busy = false;
+    free_batches(b);
+}
+
+/* ---------------------------- Training ---------------------------- */
+
+size_t gd_fit_batches(gd_source_t *source, double weights[], size_t batch_size, double learn_rate, size_t n_epochs,
+                      double tolerance, uint64_t seed)
+{
+    gd_optimizer_config_t config = gd_optimizer_config(GD_SGD);
+    config.learn_rate = learn_rate;
+
+    gd_optimizer_t *optimizer = gd_optimizer_create(&config, source->n_features + 1);
+    if (optimizer == NULL)
+        return 0;
+
+    size_t epochs = gd_fit_batches_with(source, weights, batch_size, optimizer, n_epochs, tolerance, seed);
+    gd_optimizer_destroy(optimizer);
+    return epochs;
+}
+
+size_t gd_fit_batches_with(gd_source_t *source, double weights[], size_t batch_size, gd_optimizer_t *optimizer,
+                           size_t n_epochs, double tolerance, uint64_t seed)
+{
+    if (gd_optimizer_method(optimizer) == GD_LBFGS)
+    {
+        fprintf(stderr, "%s: lbfgs needs the same cost every step, fit the whole dataset instead\n", __func__);
+        return 0;
+    }
+
+    // No curvature to take the learning rate from without a pass over the source
+    if (!(gd_optimizer_learn_rate(optimizer) > 0.0))
+    {
+        fprintf(stderr, "%s: %s needs a positive learn_rate\n", __func__,
+                gd_method_name(gd_optimizer_method(optimizer)));
+        return 0;
+    }
+
+    gd_batches_t *batches = gd_batches_open(source, batch_size, n_epochs, seed);
+    if (batches == NULL)
+        return 0;
+
+    // Batches have at most batch_size samples, so no step allocates
+    gd_least_squares_t problem = {.workspace = gd_workspace_create(batch_size, source->n_features)};
+    if (problem.workspace == NULL)
+    {
+        gd_batches_close(batches);
+        return 0;
+    }
+
+    gd_optimizer_reset(optimizer);
+
+    size_t epochs = 0;
+    bool within_tolerance = false;
+    gd_batch_t batch;
+
+    while (gd_batches_next(batches, &batch))
+    {
+        // First batch of a new epoch
+        if (batch.epoch == epochs)
+        {
+            if (within_tolerance)
+                break;
+            ++epochs;
+            within_tolerance = true;
+        }
+
+        problem.X = &batch.X;
+        problem.y = batch.y;
+
+        if (gd_optimizer_step(optimizer, gd_least_squares, &problem, weights) > tolerance)
+            within_tolerance = false;
+    }
+
+    bool failed = gd_batches_failed(batches);
+    gd_batches_close(batches);
+    gd_workspace_destroy(problem.workspace);
+
+    if (failed)
+    {
+        fprintf(stderr, "%s: reading the source failed\n", __func__);
+        return 0;
+    }
+
+    return epochs;
+}
@@ -0,0 +1,122 @@
+#ifndef MINIBATCH_H_
+
+#define MINIBATCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "gradient.h"
+#include "optimizer.h"
+
+/*
+Mini-batch and stochastic gradient descent on datasets larger than memory.
+
+A dataset file is a vector file (vector_io.h) whose payload is n_samples
+records of n_features + 1 doubles, the features of a sample followed by
+its target. gd_source_file() reads the records with pread() as they are
+needed, gd_source_map() maps the file and leaves paging to the kernel,
+and gd_source_memory() wraps a matrix that is already in memory.
+
+Batches are assembled by a background thread into a ring of GD_RING_SLOTS
+buffers, so the next batches are read and shuffled while the current one
+is computed. Each slot holds a block of consecutive samples, a whole
+number of batches and at least GD_BLOCK_SAMPLES. Every epoch visits the
+blocks in a new random order and shuffles the samples inside each block
+before splitting it into batches, so the source is read a block at a
+time and no per-sample index is kept. A batch_size of 1 gives stochastic
+gradient descent. The order depends only on the seed, so runs are
+repeatable.
+
+    gd_source_t *source = gd_source_file("train.vec", n_features);
+    gd_fit_batches(source, weights, 256, 0.01, 20, 1e-06, 42);
+    gd_source_close(source);
+
+The batches can also be consumed directly:
+
+    gd_batches_t *batches = gd_batches_open(source, 256, n_epochs, seed);
+    gd_batch_t batch;
+    while (gd_batches_next(batches, &batch))
+        ...use batch.X and batch.y until the next call...
+    gd_batches_close(batches);
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Blocks being read ahead plus the one being computed
+#define GD_RING_SLOTS 4
+
+// Fewest samples per block, shuffled together
+#define GD_BLOCK_SAMPLES 4096
+
+typedef struct gd_source_t gd_source_t;
+
+typedef struct gd_batches_t gd_batches_t;
+
+typedef struct gd_batch_t
+{
+    gd_matrix_t X;      // Row-major, X.n_samples <= batch_size
+    const double *y;
+    size_t epoch;       // Counting from 0
+} gd_batch_t;
+
+// Reads the dataset file at path as needed, NULL on error
+gd_source_t *gd_source_file(const char *path, size_t n_features);
+
+// Maps the dataset file at path, NULL on error
+gd_source_t *gd_source_map(const char *path, size_t n_features);
+
+// Samples of X with targets y, both must outlive the source
+gd_source_t *gd_source_memory(const gd_matrix_t *X, const double y[]);
+
+void gd_source_close(gd_source_t *source);
+
+size_t gd_source_samples(const gd_source_t *source);
+
+size_t gd_source_features(const gd_source_t *source);
+
+// Writes X and y to path as a dataset file, returns 0 on success
+int gd_dataset_save(const char *path, const gd_matrix_t *X, const double y[]);
+
+/*
+Starts the background thread producing n_epochs epochs of batches.
+Only one set of batches may be open on a source at a time. NULL on
+error.
+*/
+gd_batches_t *gd_batches_open(gd_source_t *source, size_t batch_size, size_t n_epochs, uint64_t seed);
+
+/*
+Hands out the next batch and releases the previous one. Returns false
+after the last batch or when the source could not be read.
+*/
+bool gd_batches_next(gd_batches_t *batches, gd_batch_t *batch);
+
+// True if reading the source failed
+bool gd_batches_failed(const gd_batches_t *batches);
+
+// Stops the background thread, batches may be closed before the last one
+void gd_batches_close(gd_batches_t *batches);
+
+/*
+Runs up to n_epochs epochs of mini-batch gradient descent on weights,
+one update per batch, and stops after the first epoch whose steps were
+all within tolerance. Returns the number of epochs run, 0 on error.
+*/
+size_t gd_fit_batches(gd_source_t *source, double weights[], size_t batch_size, double learn_rate, size_t n_epochs,
+                      double tolerance, uint64_t seed);
+
+/*
+gd_fit_batches() with one step of optimizer per batch instead of a
+fixed learning rate. The optimizer is reset first and needs a positive
+learn_rate; GD_LBFGS is refused, its line search needs the same cost at
+every step.
+*/
+size_t gd_fit_batches_with(gd_source_t *source, double weights[], size_t batch_size, gd_optimizer_t *optimizer,
+                           size_t n_epochs, double tolerance, uint64_t seed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
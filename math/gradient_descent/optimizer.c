@@ -0,0 +1,574 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <float.h>
+#include "optimizer.h"
+#include "least_squares.h"
+#include "../vector/vector_kernels.h"
+
+typedef double (*step_function_t)(gd_optimizer_t *opt, gd_objective_t objective, void *ctx, double weights[]);
+
+typedef struct method_t
+{
+    const char *name;
+    step_function_t step;
+} method_t;
+
+struct gd_optimizer_t
+{
+    gd_optimizer_config_t config;
+    const method_t *method;
+    size_t n;
+    size_t steps;               // Since the last reset
+    double *gradient;           // At the weights of the step
+    double *first;              // Velocity, or Adam's mean gradient
+    double *second;             // Adam's mean squared gradient
+
+    // L-BFGS
+    double *s;                  // history changes of the weights, n each, the oldest overwritten first
+    double *y;                  // and of the gradient
+    double *rho;                // 1 / s . y of each pair
+    double *alpha;
+    double *direction;
+    double *trial;              // Weights tried by the line search
+    double *trial_gradient;
+    double *best_gradient;      // At the lowest cost of the line search so far
+    size_t pairs;               // Pairs kept, at most history
+    size_t newest;
+    double cost;                // At the weights, once evaluated
+    bool evaluated;
+
+    double *state;              // The one allocation all the vectors are in
+};
+
+double gd_least_squares(void *ctx, const double weights[], double gradient[])
+{
+    const gd_least_squares_t *problem = ctx;
+    return gd_cost_gradient(problem->workspace, problem->X, problem->y, weights, gradient);
+}
+
+/* ---------------------------- First order methods ---------------------------- */
+
+static double sgd_step(gd_optimizer_t *opt, gd_objective_t objective, void *ctx, double weights[])
+{
+    double largest = 0.0;
+
+    objective(ctx, weights, opt->gradient);
+    for (size_t j = 0; j < opt->n; ++j)
+    {
+        double step = -opt->config.learn_rate * opt->gradient[j];
+        weights[j] += step;
+        largest = fmax(largest, fabs(step));
+    }
+
+    return largest;
+}
+
+static double momentum_step(gd_optimizer_t *opt, gd_objective_t objective, void *ctx, double weights[])
+{
+    const double *g = opt->gradient;
+    double *velocity = opt->first;
+    double mu = opt->config.momentum;
+    bool nesterov = opt->config.method == GD_NESTEROV;
+    double largest = 0.0;
+
+    objective(ctx, weights, opt->gradient);
+    for (size_t j = 0; j < opt->n; ++j)
+    {
+        velocity[j] = mu * velocity[j] + g[j];
+
+        // Nesterov looks ahead by the next velocity, momentum * velocity, without a second evaluation
+        double step = -opt->config.learn_rate * (nesterov ? g[j] + mu * velocity[j] : velocity[j]);
+        weights[j] += step;
+        largest = fmax(largest, fabs(step));
+    }
+
+    return largest;
+}
+
+static double adam_step(gd_optimizer_t *opt, gd_objective_t objective, void *ctx, double weights[])
+{
+    const gd_optimizer_config_t *c = &opt->config;
+    const double *g = opt->gradient;
+    double *mean = opt->first;
+    double *mean_square = opt->second;
+    double largest = 0.0;
+
+    objective(ctx, weights, opt->gradient);
+    ++opt->steps;
+
+    // Both means start at zero, dividing by these removes the bias towards it
+    double correction1 = 1.0 - pow(c->beta1, (double)opt->steps);
+    double correction2 = 1.0 - pow(c->beta2, (double)opt->steps);
+
+    for (size_t j = 0; j < opt->n; ++j)
+    {
+        mean[j] = c->beta1 * mean[j] + (1.0 - c->beta1) * g[j];
+        mean_square[j] = c->beta2 * mean_square[j] + (1.0 - c->beta2) * g[j] * g[j];
+
+        double update = mean[j] / correction1 / (sqrt(mean_square[j] / correction2) + c->epsilon);
+
+        // Decoupled decay shrinks the weights themselves, never the bias in weights[0]
+        if (c->method == GD_ADAMW && j > 0)
+            update += c->weight_decay * weights[j];
+
+        double step = -c->learn_rate * update;
+        weights[j] += step;
+        largest = fmax(largest, fabs(step));
+    }
+
+    return largest;
+}
+
+/* ---------------------------- L-BFGS ---------------------------- */
+
+static double *pair_s(const gd_optimizer_t *opt, size_t k)
+{
+    return opt->s + k * opt->n;
+}
+
+static double *pair_y(const gd_optimizer_t *opt, size_t k)
+{
+    return opt->y + k * opt->n;
+}
+
+// direction = -H * gradient, H the inverse Hessian estimate from the pairs kept
+static void two_loop(gd_optimizer_t *opt)
+{
+    size_t n = opt->n;
+    size_t h = opt->config.history;
+    double *q = opt->direction;
+
+    kernel_scale(n, q, opt->gradient, -1.0);
+    if (opt->pairs == 0)
+        return;
+
+    // Newest to oldest
+    for (size_t i = 0; i < opt->pairs; ++i)
+    {
+        size_t k = (opt->newest + h - i) % h;
+        opt->alpha[k] = opt->rho[k] * kernel_dot(n, pair_s(opt, k), q);
+        kernel_axpy(n, q, -opt->alpha[k], pair_y(opt, k));
+    }
+
+    // The initial estimate is s . y / y . y of the newest pair times the identity
+    const double *y_new = pair_y(opt, opt->newest);
+    kernel_scale(n, q, q, 1.0 / (opt->rho[opt->newest] * kernel_dot(n, y_new, y_new)));
+
+    // Oldest to newest
+    for (size_t i = opt->pairs; i-- > 0;)
+    {
+        size_t k = (opt->newest + h - i) % h;
+        double beta = opt->rho[k] * kernel_dot(n, pair_y(opt, k), q);
+        kernel_axpy(n, q, opt->alpha[k] - beta, pair_s(opt, k));
+    }
+}
+
+static void swap_gradients(double **a, double **b)
+{
+    double *t = *a;
+    *a = *b;
+    *b = t;
+}
+
+// Step at the minimum of the cubic through the costs and slopes at a and b, bisection where it fails
+static double cubic_step(double a, double f_a, double slope_a, double b, double f_b, double slope_b)
+{
+    double d1 = slope_a + slope_b - 3.0 * (f_a - f_b) / (a - b);
+    double d2 = sqrt(d1 * d1 - slope_a * slope_b) * (b > a ? 1.0 : -1.0);
+    double t = b - (b - a) * (slope_b + d2 - d1) / (slope_b - slope_a + 2.0 * d2);
+
+    // Keeps away from the ends, so the bracket shrinks by a tenth at least
+    double lo = fmin(a, b);
+    double width = fabs(b - a);
+    if (!(t >= lo + 0.1 * width && t <= lo + 0.9 * width))
+        t = 0.5 * (a + b);
+    return t;
+}
+
+/*
+Line search from weights along direction for a step t meeting the strong
+Wolfe conditions, the cost at most cost + c1 * t * slope and the slope
+at most c2 times as steep as the slope at t = 0. Doubles t until the
+step is bracketed, then narrows the bracket with cubic interpolation, as
+in Nocedal and Wright, algorithms 3.5 and 3.6. Leaves the weights in
+trial, their gradient in trial_gradient and their cost in *cost, and
+returns t, or the step of lowest cost if no step met the conditions
+within max_evals evaluations. Returns 0 if no step lowered the cost.
+*/
+static double line_search(gd_optimizer_t *opt, gd_objective_t objective, void *ctx, const double weights[],
+                          double t, double *cost)
+{
+    const gd_optimizer_config_t *c = &opt->config;
+    size_t n = opt->n;
+    double f0 = opt->cost;
+    double slope0 = kernel_dot(n, opt->gradient, opt->direction);
+
+    // lo has the lowest cost with sufficient decrease so far, and the slope at lo points into the bracket
+    double t_lo = 0.0, f_lo = f0, slope_lo = slope0;
+    double t_hi = INFINITY, f_hi = 0.0, slope_hi = 0.0;
+
+    for (size_t eval = 0; eval < c->max_evals; ++eval)
+    {
+        kernel_scale(n, opt->trial, opt->direction, t);
+        kernel_add(n, opt->trial, opt->trial, weights);
+
+        double f = objective(ctx, opt->trial, opt->trial_gradient);
+        double slope = kernel_dot(n, opt->trial_gradient, opt->direction);
+
+        if (!(f <= f0 + c->c1 * t * slope0) || f >= f_lo)
+        {
+            t_hi = t;
+            f_hi = f;
+            slope_hi = slope;
+        }
+        else
+        {
+            if (fabs(slope) <= -c->c2 * slope0)
+            {
+                *cost = f;
+                return t;
+            }
+
+            if (slope * (t_hi - t_lo) >= 0.0)
+            {
+                t_hi = t_lo;
+                f_hi = f_lo;
+                slope_hi = slope_lo;
+            }
+
+            t_lo = t;
+            f_lo = f;
+            slope_lo = slope;
+            swap_gradients(&opt->best_gradient, &opt->trial_gradient);
+        }
+
+        t = isinf(t_hi) ? 2.0 * t : cubic_step(t_lo, f_lo, slope_lo, t_hi, f_hi, slope_hi);
+    }
+
+    if (t_lo == 0.0)
+        return 0.0;
+
+    kernel_scale(n, opt->trial, opt->direction, t_lo);
+    kernel_add(n, opt->trial, opt->trial, weights);
+    swap_gradients(&opt->best_gradient, &opt->trial_gradient);
+    *cost = f_lo;
+    return t_lo;
+}
+
+static double lbfgs_step(gd_optimizer_t *opt, gd_objective_t objective, void *ctx, double weights[])
+{
+    size_t n = opt->n;
+    double cost = 0.0;
+    double t = 0.0;
+
+    if (!opt->evaluated)
+    {
+        opt->cost = objective(ctx, weights, opt->gradient);
+        opt->evaluated = true;
+    }
+
+    while (t == 0.0)
+    {
+        two_loop(opt);
+
+        double length = 1.0;
+        if (opt->pairs == 0 || !(kernel_dot(n, opt->gradient, opt->direction) < 0.0))
+        {
+            // Steepest descent, the first step learn_rate long
+            double norm = sqrt(kernel_dot(n, opt->gradient, opt->gradient));
+            if (!(norm > 0.0))
+                return 0.0;
+
+            opt->pairs = 0;
+            kernel_scale(n, opt->direction, opt->gradient, -1.0);
+            length = opt->config.learn_rate / norm;
+        }
+
+        t = line_search(opt, objective, ctx, weights, length, &cost);
+
+        if (t == 0.0)
+        {
+            // Nothing lowers the cost along the gradient itself
+            if (opt->pairs == 0)
+                return 0.0;
+
+            // Otherwise the history misleads, start again from steepest descent
+            opt->pairs = 0;
+        }
+    }
+
+    /*
+    The new pair, built in the direction and best_gradient the line search
+    is done with. It is kept only while s . y is positive, so the estimate
+    stays positive definite; a rejected pair leaves the oldest one intact.
+    */
+    double *s = opt->direction;
+    double *y = opt->best_gradient;
+
+    kernel_sub(n, s, opt->trial, weights);
+    kernel_sub(n, y, opt->trial_gradient, opt->gradient);
+
+    double sy = kernel_dot(n, s, y);
+    if (sy > DBL_EPSILON * kernel_dot(n, y, y))
+    {
+        size_t k = (opt->newest + 1) % opt->config.history;
+
+        memcpy(pair_s(opt, k), s, sizeof(*s) * n);
+        memcpy(pair_y(opt, k), y, sizeof(*y) * n);
+        opt->rho[k] = 1.0 / sy;
+        opt->newest = k;
+        opt->pairs += opt->pairs < opt->config.history;
+    }
+
+    double largest = 0.0;
+    for (size_t j = 0; j < n; ++j)
+        largest = fmax(largest, fabs(s[j]));
+
+    memcpy(weights, opt->trial, sizeof(*weights) * n);
+    swap_gradients(&opt->gradient, &opt->trial_gradient);
+    opt->cost = cost;
+
+    return largest;
+}
+
+/* ---------------------------- Optimizers ---------------------------- */
+
+// Indexed by gd_method_t
+static const method_t methods[] = {
+    [GD_SGD] = {"sgd", sgd_step},
+    [GD_MOMENTUM] = {"momentum", momentum_step},
+    [GD_NESTEROV] = {"nesterov", momentum_step},
+    [GD_ADAM] = {"adam", adam_step},
+    [GD_ADAMW] = {"adamw", adam_step},
+    [GD_LBFGS] = {"lbfgs", lbfgs_step},
+};
+
+#define N_METHODS (sizeof(methods) / sizeof(methods[0]))
+
+gd_optimizer_config_t gd_optimizer_config(gd_method_t method)
+{
+    gd_optimizer_config_t config = {
+        .method = method,
+        .learn_rate = 0.0,
+        .momentum = 0.9,
+        .beta1 = 0.9,
+        .beta2 = 0.999,
+        .epsilon = 1e-08,
+        .weight_decay = 0.0,
+        .history = 10,
+        .c1 = 1e-04,
+        .c2 = 0.9,
+        .max_evals = 20,
+    };
+
+    switch (method)
+    {
+    case GD_ADAM:
+        config.learn_rate = 0.001;
+        break;
+    case GD_ADAMW:
+        config.learn_rate = 0.001;
+        config.weight_decay = 0.01;
+        break;
+    case GD_LBFGS:
+        config.learn_rate = 1.0;
+        break;
+    default:
+        break;
+    }
+
+    return config;
+}
+
+const char *gd_method_name(gd_method_t method)
+{
+    return (size_t)method < N_METHODS ? methods[method].name : "unknown";
+}
+
+// Doubles of state besides the gradient
+static size_t state_size(const gd_optimizer_config_t *config, size_t n)
+{
+    switch (config->method)
+    {
+    case GD_MOMENTUM:
+    case GD_NESTEROV:
+        return n;
+    case GD_ADAM:
+    case GD_ADAMW:
+        return 2 * n;
+    case GD_LBFGS:
+        return config->history * (2 * n + 2) + 4 * n;
+    default:
+        return 0;
+    }
+}
+
+gd_optimizer_t *gd_optimizer_create(const gd_optimizer_config_t *config, size_t n_weights)
+{
+    if ((size_t)config->method >= N_METHODS)
+    {
+        fprintf(stderr, "%s: unknown method %d\n", __func__, (int)config->method);
+        return NULL;
+    }
+
+    bool needs_rate = config->method != GD_SGD && config->method != GD_MOMENTUM && config->method != GD_NESTEROV;
+    if (config->learn_rate < 0.0 || (needs_rate && !(config->learn_rate > 0.0)))
+    {
+        fprintf(stderr, "%s: %s needs a positive learn_rate\n", __func__, gd_method_name(config->method));
+        return NULL;
+    }
+
+    if (config->method == GD_LBFGS && (config->history == 0 || config->max_evals == 0))
+    {
+        fprintf(stderr, "%s: lbfgs needs a history and max_evals of at least 1\n", __func__);
+        return NULL;
+    }
+
+    gd_optimizer_t *opt = calloc(1, sizeof(*opt));
+    double *state = malloc(sizeof(*state) * (n_weights + state_size(config, n_weights) + 1));
+
+    if (opt == NULL || state == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        free(opt);
+        free(state);
+        return NULL;
+    }
+
+    size_t n = n_weights;
+    size_t h = config->history;
+
+    opt->config = *config;
+    opt->method = &methods[config->method];
+    opt->n = n;
+    opt->state = state;
+    opt->gradient = state;
+    state += n;
+
+    switch (config->method)
+    {
+    case GD_MOMENTUM:
+    case GD_NESTEROV:
+        opt->first = state;
+        break;
+    case GD_ADAM:
+    case GD_ADAMW:
+        opt->first = state;
+        opt->second = state + n;
+        break;
+    case GD_LBFGS:
+        opt->s = state;
+        opt->y = opt->s + h * n;
+        opt->rho = opt->y + h * n;
+        opt->alpha = opt->rho + h;
+        opt->direction = opt->alpha + h;
+        opt->trial = opt->direction + n;
+        opt->trial_gradient = opt->trial + n;
+        opt->best_gradient = opt->trial_gradient + n;
+        break;
+    default:
+        break;
+    }
+
+    gd_optimizer_reset(opt);
+    return opt;
+}
+
+void gd_optimizer_destroy(gd_optimizer_t *optimizer)
+{
+    if (optimizer == NULL)
+        return;
+
+    free(optimizer->state);
+    free(optimizer);
+}
+
+void gd_optimizer_reset(gd_optimizer_t *optimizer)
+{
+    size_t n = optimizer->n;
+
+    if (optimizer->first != NULL)
+        memset(optimizer->first, 0, sizeof(double) * n);
+    if (optimizer->second != NULL)
+        memset(optimizer->second, 0, sizeof(double) * n);
+
+    optimizer->steps = 0;
+    optimizer->pairs = 0;
+    optimizer->newest = 0;
+    optimizer->evaluated = false;
+}
+
+gd_method_t gd_optimizer_method(const gd_optimizer_t *optimizer)
+{
+    return optimizer->config.method;
+}
+
+double gd_optimizer_learn_rate(const gd_optimizer_t *optimizer)
+{
+    return optimizer->config.learn_rate;
+}
+
+void gd_optimizer_set_learn_rate(gd_optimizer_t *optimizer, double learn_rate)
+{
+    optimizer->config.learn_rate = learn_rate;
+}
+
+double gd_optimizer_step(gd_optimizer_t *optimizer, gd_objective_t objective, void *ctx, double weights[])
+{
+    return optimizer->method->step(optimizer, objective, ctx, weights);
+}
+
+size_t gd_fit_optimizer(const gd_matrix_t *X, const double y[], double weights[], gd_optimizer_t *optimizer,
+                        size_t n_iter, double tolerance)
+{
+    if (X->n_samples == 0)
+    {
+        fprintf(stderr, "%s: no samples\n", __func__);
+        return 0;
+    }
+
+    if (X->n_features + 1 != optimizer->n)
+    {
+        fprintf(stderr, "%s: the optimizer has %zu weights, the model %zu\n", __func__, optimizer->n,
+                X->n_features + 1);
+        return 0;
+    }
+
+    gd_least_squares_t problem = {.X = X, .y = y, .workspace = gd_workspace_create(X->n_samples, X->n_features)};
+    if (problem.workspace == NULL)
+        return 0;
+
+    // A learning rate of 0 comes from the curvature of this X, stable for any
+    // data, and is put back on exit so the next fit measures its own
+    const double configured_rate = optimizer->config.learn_rate;
+    if (configured_rate == 0.0)
+    {
+        double curvature = gd_curvature(X);
+        if (!(curvature > 0.0))
+        {
+            fprintf(stderr, "%s: no learning rate for data without curvature\n", __func__);
+            gd_workspace_destroy(problem.workspace);
+            return 0;
+        }
+        optimizer->config.learn_rate = 1.0 / curvature;
+    }
+
+    gd_optimizer_reset(optimizer);
+
+    size_t steps = 0;
+    while (steps < n_iter)
+    {
+        double change = gd_optimizer_step(optimizer, gd_least_squares, &problem, weights);
+        ++steps;
+
+        if (!(change > tolerance))
+            break;
+    }
+
+    optimizer->config.learn_rate = configured_rate;
+    gd_workspace_destroy(problem.workspace);
+    return steps;
+}
@@ -0,0 +1,133 @@
+#ifndef OPTIMIZER_H_
+
+#define OPTIMIZER_H_
+
+#include <stddef.h>
+#include "gradient.h"
+
+/*
+Optimizers for the weights of the linear model of gradient.h, or of any
+differentiable cost given as a gd_objective_t.
+
+    GD_SGD        weights -= learn_rate * gradient, the update of gd_fit()
+    GD_MOMENTUM   heavy ball, velocity = momentum * velocity + gradient
+    GD_NESTEROV   the same velocity, stepping along the gradient at the
+                  point the velocity is about to carry the weights to
+    GD_ADAM       per weight steps from running means of the gradient and
+                  of its square, corrected for their start at zero
+    GD_ADAMW      Adam with weight decay applied to the weights directly,
+                  not through the gradient, and not to the bias
+    GD_LBFGS      quasi-Newton steps from the last history changes of the
+                  weights and gradient, each found by a line search that
+                  meets the strong Wolfe conditions
+
+gd_optimizer_create() allocates all the state an optimizer keeps between
+steps, and gd_optimizer_step() never allocates. gd_fit_optimizer() fits
+X and y with the cost and gradient of gd_cost_gradient(), one sweep over
+X per evaluation:
+
+    gd_optimizer_config_t config = gd_optimizer_config(GD_LBFGS);
+    gd_optimizer_t *optimizer = gd_optimizer_create(&config, n_features + 1);
+    size_t steps = gd_fit_optimizer(&X, y, weights, optimizer, 100, 1e-09);
+    gd_optimizer_destroy(optimizer);
+
+No method needs its learning rate tuned to the data. A learn_rate of 0,
+the default of GD_SGD, GD_MOMENTUM and GD_NESTEROV, is replaced by
+1 / gd_curvature(X) for the length of each gd_fit_optimizer() call, so
+an optimizer reused on other data measures that data's curvature. Adam's
+steps are about learn_rate in every weight whatever the scale of the
+data, so its default suits weights of order one. L-BFGS scales its steps from the
+curvature it has seen, and its first line search starts with a step of
+length learn_rate down the gradient.
+
+L-BFGS keeps the cost and gradient of the point its line search accepted
+for the next step, so its objective must not change between steps; call
+gd_optimizer_reset() after changing it. Mini-batches change it every
+step, which is why gd_fit_batches_with() of minibatch.h only takes the
+first order methods.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum gd_method_t
+{
+    GD_SGD,
+    GD_MOMENTUM,
+    GD_NESTEROV,
+    GD_ADAM,
+    GD_ADAMW,
+    GD_LBFGS
+} gd_method_t;
+
+typedef struct gd_optimizer_config_t
+{
+    gd_method_t method;
+    double learn_rate;
+    double momentum;        // GD_MOMENTUM and GD_NESTEROV
+    double beta1;           // Adam, decay of the mean gradient
+    double beta2;           // Adam, decay of the mean squared gradient
+    double epsilon;         // Adam, added to the root mean square
+    double weight_decay;    // GD_ADAMW, per unit of learn_rate
+    size_t history;         // GD_LBFGS, pairs of changes kept
+    double c1;              // GD_LBFGS, sufficient decrease
+    double c2;              // GD_LBFGS, curvature
+    size_t max_evals;       // GD_LBFGS, evaluations per line search
+} gd_optimizer_config_t;
+
+typedef struct gd_optimizer_t gd_optimizer_t;
+
+// Writes the gradient of the cost at weights to gradient and returns the cost
+typedef double (*gd_objective_t)(void *ctx, const double weights[], double gradient[]);
+
+// Context of gd_least_squares(), the cost of gradient.h on X and y
+typedef struct gd_least_squares_t
+{
+    const gd_matrix_t *X;
+    const double *y;
+    gd_workspace_t *workspace;
+} gd_least_squares_t;
+
+// gd_objective_t of the linear model, a gd_cost_gradient() with a gd_least_squares_t
+double gd_least_squares(void *ctx, const double weights[], double gradient[]);
+
+// Default settings of method
+gd_optimizer_config_t gd_optimizer_config(gd_method_t method);
+
+const char *gd_method_name(gd_method_t method);
+
+// Optimizer of n_weights weights with all its state allocated, NULL on error
+gd_optimizer_t *gd_optimizer_create(const gd_optimizer_config_t *config, size_t n_weights);
+
+void gd_optimizer_destroy(gd_optimizer_t *optimizer);
+
+// Forgets the state of previous steps, as if just created
+void gd_optimizer_reset(gd_optimizer_t *optimizer);
+
+gd_method_t gd_optimizer_method(const gd_optimizer_t *optimizer);
+
+double gd_optimizer_learn_rate(const gd_optimizer_t *optimizer);
+
+void gd_optimizer_set_learn_rate(gd_optimizer_t *optimizer, double learn_rate);
+
+/*
+One update of weights for the cost objective(ctx, ...). Returns the
+largest change of a weight, 0 when L-BFGS finds no step that lowers the
+cost.
+*/
+double gd_optimizer_step(gd_optimizer_t *optimizer, gd_objective_t objective, void *ctx, double weights[]);
+
+/*
+Runs up to n_iter steps of optimizer on the cost of X and y, starting
+from weights, and stops after the first step that changes no weight by
+more than tolerance. Returns the number of steps, 0 on error.
+*/
+size_t gd_fit_optimizer(const gd_matrix_t *X, const double y[], double weights[], gd_optimizer_t *optimizer,
+                        size_t n_iter, double tolerance);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,97 @@
+/*
+Checks that gd_fit() gives the same bits for the weights with any number
+of threads, in both layouts of X.
+
+    make test
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "gradient.h"
+#include "../vector/vector_parallel.h"
+
+#define N_SAMPLES 300007
+#define N_FEATURES 3
+#define N_ITER 20
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok)
+    {
+        fprintf(stderr, "FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+static void fit(const gd_matrix_t *X, const double y[], double weights[N_FEATURES + 1])
+{
+    for (size_t k = 0; k <= N_FEATURES; ++k)
+        weights[k] = 0.5;
+
+    double *errors = gd_fit(X, y, weights, 0.01, N_ITER, 0.0, NULL);
+    if (errors == NULL)
+        exit(EXIT_FAILURE);
+    free(errors);
+}
+
+int main(void)
+{
+    double *rows = malloc(sizeof(double) * N_SAMPLES * N_FEATURES);
+    double *columns = malloc(sizeof(double) * N_SAMPLES * N_FEATURES);
+    double *y = malloc(sizeof(double) * N_SAMPLES);
+    if (rows == NULL || columns == NULL || y == NULL)
+        return EXIT_FAILURE;
+
+    for (size_t i = 0; i < N_SAMPLES; ++i)
+    {
+        y[i] = 1.0;
+        for (size_t k = 0; k < N_FEATURES; ++k)
+        {
+            double value = sin((double)(i * N_FEATURES + k));
+            rows[i * N_FEATURES + k] = value;
+            columns[k * N_SAMPLES + i] = value;
+            y[i] += (double)(k + 1) * value;
+        }
+    }
+
+    const gd_matrix_t X[] = {
+        gd_matrix(N_SAMPLES, N_FEATURES, GD_ROW_MAJOR, rows),
+        gd_matrix(N_SAMPLES, N_FEATURES, GD_COL_MAJOR, columns),
+    };
+    const size_t threads[] = {2, 4, 7, 8};
+
+    // Every sweep goes to the pool once it has more than one task
+    parallel_set_threshold(0);
+
+    for (size_t l = 0; l < sizeof(X) / sizeof(X[0]); ++l)
+    {
+        double expected[N_FEATURES + 1];
+        parallel_set_num_threads(1);
+        fit(&X[l], y, expected);
+
+        for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t)
+        {
+            double weights[N_FEATURES + 1];
+            parallel_set_num_threads(threads[t]);
+            fit(&X[l], y, weights);
+
+            char what[80];
+            snprintf(what, sizeof(what), "%s weights on %zu threads", l == 0 ? "row-major" : "column-major",
+                     threads[t]);
+            check(memcmp(weights, expected, sizeof(expected)) == 0, what);
+        }
+    }
+
+    free(rows);
+    free(columns);
+    free(y);
+
+    if (failures == 0)
+        printf("test_gradient: all checks passed\n");
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,23 +1,74 @@
 #include <stdio.h>
 #include <math.h>
 #include "../vector/vector.h"
+#include "../vector/vector_generator.h"
+#include "quadrature.h"
 #include <stdlib.h>
 
 double trapz(double(f)(double), double a, double b, size_t n);
 
+static double sine(double x, void *params)
+{
+    (void)params;
+    return sin(x);
+}
+
+// Integrand sin(k x) with k taken from the problem's parameters
+static void sines(size_t n, const double x[], const size_t problem[], double fx[], void *params)
+{
+    const double *k = params;
+    for (size_t i = 0; i < n; ++i)
+        fx[i] = sin(k[problem[i]] * x[i]);
+}
+
+static void print_result(const char *name, quad_result_t r)
+{
+    printf("%-15s %.15g  error %.3g  evaluations %zu%s\n", name, r.value, r.error, r.n_evals,
+           r.converged ? "" : "  (not converged)");
+}
+
 int main(void)
 {
     double a = 0;
     double b = PI;
     double n = 10000;
+    double tol = 1e-10;
 
-    vector_t *x = linspace(a, b, n);
-    vector_t *y = function_like(x, sin);
+    vector_gen_t x = gen_linspace(a, b, n);
+    vector_t *y = gen_function_like(x, sin);
 
     printf("array: %.15g\n", trapz(sin, a, b, n));
-    printf("vector: %.15g\n", trapezoidal_rule(y, x));
+    printf("vector: %.15g\n", gen_trapezoidal_rule(y, x));
+
+    print_result("simpson", simpson(sine, NULL, a, b, tol));
+    print_result("romberg", romberg(sine, NULL, a, b, tol));
+    print_result("gauss_legendre", gauss_legendre(sine, NULL, a, b, 8, tol));
+    print_result("gauss_kronrod", gauss_kronrod(sine, NULL, a, b, tol));
+
+    // simpson_sampled() accepts any sampling, so it takes stored abscissae
+    vector_t *xs = gen_to_vector(x);
+    print_result("simpson_sampled", simpson_sampled(y, xs, tol));
+
+    // Many small problems in one call: the integral of sin(k x) over [0, 1]
+    size_t m = 100000;
+    double *k = malloc(sizeof(double) * m);
+    double *lo = calloc(m, sizeof(double));
+    double *hi = malloc(sizeof(double) * m);
+    quad_result_t *results = malloc(sizeof(quad_result_t) * m);
+    for (size_t i = 0; i < m; ++i)
+    {
+        k[i] = 1.0 + (double)i / (double)m;
+        hi[i] = 1.0;
+    }
+
+    gauss_kronrod_batch(sines, k, m, lo, hi, tol, results);
+    print_result("batch[last]", results[m - 1]);
 
-    free(x);
+    free(k);
+    free(lo);
+    free(hi);
+    free(results);
+    free(xs);
     free(y);
 }
 
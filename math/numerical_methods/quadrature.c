@@ -0,0 +1,633 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "quadrature.h"
+#include "../vector/vector_parallel.h"
+
+// Refinements done before an error estimate is trusted, so an integrand
+// that happens to vanish at the first few abscissae is not taken as zero
+#define QUAD_MIN_LEVELS 4
+
+#define KRONROD_POINTS 15
+
+static quad_result_t failed(void)
+{
+    quad_result_t r = {NAN, INFINITY, 0, false};
+    return r;
+}
+
+quad_result_t simpson(quad_function_t f, void *params, double a, double b, double tol)
+{
+    if (f == NULL)
+    {
+        fprintf(stderr, "%s: Null function\n", __func__);
+        return failed();
+    }
+
+    quad_result_t r = {0.0, INFINITY, 3, false};
+
+    // Composite Simpson is h/3 * (ends + 4 * odd + 2 * even); halving h
+    // turns the odd points into even ones and adds a new set of odd ones
+    double ends = f(a, params) + f(b, params);
+    double odd = f((a + b) / 2.0, params);
+    double even = 0.0;
+    double previous = (b - a) / 6.0 * (ends + 4.0 * odd);
+    size_t n = 2;
+
+    for (size_t level = 1; level <= QUAD_MAX_LEVELS; ++level)
+    {
+        n *= 2;
+        double h = (b - a) / (double)n;
+        even += odd;
+        odd = 0.0;
+        for (size_t i = 1; i < n; i += 2)
+            odd += f(a + h * (double)i, params);
+        r.n_evals += n / 2;
+
+        r.value = h / 3.0 * (ends + 4.0 * odd + 2.0 * even);
+        r.error = fabs(r.value - previous) / 15.0;
+        previous = r.value;
+
+        if (level >= QUAD_MIN_LEVELS && r.error <= tol)
+        {
+            r.converged = true;
+            break;
+        }
+    }
+    return r;
+}
+
+quad_result_t romberg(quad_function_t f, void *params, double a, double b, double tol)
+{
+    if (f == NULL)
+    {
+        fprintf(stderr, "%s: Null function\n", __func__);
+        return failed();
+    }
+
+    quad_result_t r = {0.0, INFINITY, 2, false};
+
+    // Two rows of the Romberg table, row k starts with the trapezoidal
+    // rule on 2^k subintervals
+    double previous[QUAD_MAX_LEVELS + 1], current[QUAD_MAX_LEVELS + 1];
+    previous[0] = (b - a) / 2.0 * (f(a, params) + f(b, params));
+    size_t n = 1;
+
+    for (size_t k = 1; k <= QUAD_MAX_LEVELS; ++k)
+    {
+        double h = (b - a) / (double)(2 * n);
+        double midpoints = 0.0;
+        for (size_t i = 0; i < n; ++i)
+            midpoints += f(a + h * (double)(2 * i + 1), params);
+        r.n_evals += n;
+        n *= 2;
+
+        current[0] = previous[0] / 2.0 + h * midpoints;
+        double factor = 1.0;
+        for (size_t j = 1; j <= k; ++j)
+        {
+            factor *= 4.0;
+            current[j] = current[j - 1] + (current[j - 1] - previous[j - 1]) / (factor - 1.0);
+        }
+
+        r.value = current[k];
+        r.error = fabs(current[k] - previous[k - 1]);
+
+        if (k >= QUAD_MIN_LEVELS && r.error <= tol)
+        {
+            r.converged = true;
+            break;
+        }
+
+        for (size_t j = 0; j <= k; ++j)
+            previous[j] = current[j];
+    }
+    return r;
+}
+
+// Nodes and weights of the order point rule on [-1, 1] by Newton's method
+static void legendre_rule(size_t order, double nodes[], double weights[])
+{
+    for (size_t i = 0; i < (order + 1) / 2; ++i)
+    {
+        double z = cos(PI * ((double)i + 0.75) / ((double)order + 0.5));
+        double dp = 1.0;
+
+        for (int iteration = 0; iteration < 100; ++iteration)
+        {
+            // Legendre polynomial and its derivative by the three term recurrence
+            double p0 = 1.0, p1 = z;
+            for (size_t k = 2; k <= order; ++k)
+            {
+                double p2 = ((2.0 * k - 1.0) * z * p1 - (k - 1.0) * p0) / (double)k;
+                p0 = p1;
+                p1 = p2;
+            }
+            dp = (double)order * (z * p1 - p0) / (z * z - 1.0);
+
+            double step = p1 / dp;
+            z -= step;
+            if (fabs(step) < 1e-15)
+                break;
+        }
+
+        double w = 2.0 / ((1.0 - z * z) * dp * dp);
+        nodes[i] = -z;
+        nodes[order - 1 - i] = z;
+        weights[i] = w;
+        weights[order - 1 - i] = w;
+    }
+}
+
+quad_result_t gauss_legendre(quad_function_t f, void *params, double a, double b, size_t order, double tol)
+{
+    if (f == NULL || order == 0 || order > QUAD_MAX_ORDER)
+    {
+        fprintf(stderr, "%s: Null function or order not in 1..%d\n", __func__, QUAD_MAX_ORDER);
+        return failed();
+    }
+
+    double nodes[QUAD_MAX_ORDER], weights[QUAD_MAX_ORDER];
+    legendre_rule(order, nodes, weights);
+
+    quad_result_t r = {0.0, INFINITY, 0, false};
+    double previous = 0.0;
+    size_t panels = 1;
+
+    for (size_t level = 0; level <= QUAD_MAX_LEVELS; ++level, panels *= 2)
+    {
+        double h = (b - a) / (double)panels;
+        double total = 0.0;
+
+        for (size_t p = 0; p < panels; ++p)
+        {
+            double mid = a + h * ((double)p + 0.5);
+            double panel = 0.0;
+            for (size_t i = 0; i < order; ++i)
+                panel += weights[i] * f(mid + h / 2.0 * nodes[i], params);
+            total += h / 2.0 * panel;
+        }
+        r.n_evals += panels * order;
+        r.value = total;
+
+        if (level > 0)
+        {
+            r.error = fabs(total - previous);
+            if (level >= QUAD_MIN_LEVELS && r.error <= tol)
+            {
+                r.converged = true;
+                break;
+            }
+        }
+        previous = total;
+    }
+    return r;
+}
+
+vector_t *gauss_legendre_nodes(size_t order, double a, double b)
+{
+    if (order == 0 || order > QUAD_MAX_ORDER)
+    {
+        fprintf(stderr, "%s: Order not in 1..%d\n", __func__, QUAD_MAX_ORDER);
+        return NULL;
+    }
+
+    double nodes[QUAD_MAX_ORDER], weights[QUAD_MAX_ORDER];
+    legendre_rule(order, nodes, weights);
+
+    vector_t *v = empty(order);
+    if (v == NULL)
+        return NULL;
+
+    for (size_t i = 0; i < order; ++i)
+        v->arr[i] = (a + b) / 2.0 + (b - a) / 2.0 * nodes[i];
+    return v;
+}
+
+vector_t *gauss_legendre_weights(size_t order, double a, double b)
+{
+    if (order == 0 || order > QUAD_MAX_ORDER)
+    {
+        fprintf(stderr, "%s: Order not in 1..%d\n", __func__, QUAD_MAX_ORDER);
+        return NULL;
+    }
+
+    double nodes[QUAD_MAX_ORDER], weights[QUAD_MAX_ORDER];
+    legendre_rule(order, nodes, weights);
+
+    vector_t *v = empty(order);
+    if (v == NULL)
+        return NULL;
+
+    for (size_t i = 0; i < order; ++i)
+        v->arr[i] = (b - a) / 2.0 * weights[i];
+    return v;
+}
+
+// Kronrod abscissae on [0, 1), the odd ones are the Gauss abscissae
+static const double xgk[8] = {
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245, 0.000000000000000000000000000000000,
+};
+
+static const double wgk[8] = {
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714,
+};
+
+// Gauss weights for xgk[1], xgk[3], xgk[5] and xgk[7]
+static const double wg[4] = {
+    0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975, 0.417959183673469387755102040816327,
+};
+
+typedef struct interval_t
+{
+    double a, b;
+    double value, error;
+} interval_t;
+
+// Abscissae of the 15 point rule on [a, b], the center first, then pairs
+static void kronrod_abscissae(double a, double b, double x[KRONROD_POINTS])
+{
+    double center = (a + b) / 2.0;
+    double half = (b - a) / 2.0;
+
+    x[0] = center;
+    for (size_t j = 0; j < 7; ++j)
+    {
+        x[2 * j + 1] = center - half * xgk[j];
+        x[2 * j + 2] = center + half * xgk[j];
+    }
+}
+
+// G7K15 from the integrand at kronrod_abscissae(), the error estimate is
+// the Gauss/Kronrod difference
+static interval_t kronrod_rule(double a, double b, const double fx[KRONROD_POINTS])
+{
+    double half = (b - a) / 2.0;
+    double kronrod = wgk[7] * fx[0];
+    double gauss = wg[3] * fx[0];
+
+    for (size_t j = 0; j < 7; ++j)
+    {
+        double pair = fx[2 * j + 1] + fx[2 * j + 2];
+        kronrod += wgk[j] * pair;
+        if (j % 2 == 1)
+            gauss += wg[j / 2] * pair;
+    }
+
+    interval_t in = {a, b, kronrod * half, fabs((kronrod - gauss) * half)};
+    return in;
+}
+
+// Subintervals of one adaptive integration and its running result
+typedef struct kronrod_state_t
+{
+    interval_t *intervals;
+    size_t n, capacity;
+    quad_result_t result;
+} kronrod_state_t;
+
+static void kronrod_init(kronrod_state_t *s, double a, double b, const double fx[KRONROD_POINTS])
+{
+    s->capacity = 16;
+    s->intervals = malloc(sizeof(interval_t) * s->capacity);
+    if (s->intervals == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation falied\n", __func__);
+        exit(1);
+    }
+
+    s->intervals[0] = kronrod_rule(a, b, fx);
+    s->n = 1;
+    s->result = (quad_result_t){0.0, INFINITY, KRONROD_POINTS, false};
+}
+
+/*
+Totals the subintervals into s->result. Returns true when the
+integration is over, because it converged or cannot split any further,
+and otherwise stores the subinterval to bisect next in worst.
+*/
+static bool kronrod_done(kronrod_state_t *s, double tol, size_t *worst)
+{
+    quad_result_t *r = &s->result;
+    *worst = 0;
+    r->value = 0.0;
+    r->error = 0.0;
+    for (size_t i = 0; i < s->n; ++i)
+    {
+        r->value += s->intervals[i].value;
+        r->error += s->intervals[i].error;
+        if (s->intervals[i].error > s->intervals[*worst].error)
+            *worst = i;
+    }
+
+    if (r->error <= tol)
+    {
+        r->converged = true;
+        return true;
+    }
+
+    // Out of room, or the worst interval is too narrow to split further
+    interval_t w = s->intervals[*worst];
+    double mid = (w.a + w.b) / 2.0;
+    return s->n == QUAD_MAX_INTERVALS || mid <= fmin(w.a, w.b) || mid >= fmax(w.a, w.b);
+}
+
+// Replaces interval worst by its halves, x holds both halves' abscissae
+static void kronrod_split_abscissae(const kronrod_state_t *s, size_t worst, double x[2 * KRONROD_POINTS])
+{
+    interval_t w = s->intervals[worst];
+    double mid = (w.a + w.b) / 2.0;
+    kronrod_abscissae(w.a, mid, x);
+    kronrod_abscissae(mid, w.b, x + KRONROD_POINTS);
+}
+
+static void kronrod_split(kronrod_state_t *s, size_t worst, const double fx[2 * KRONROD_POINTS])
+{
+    if (s->n == s->capacity)
+    {
+        s->capacity *= 2;
+        interval_t *grown = realloc(s->intervals, sizeof(interval_t) * s->capacity);
+        if (grown == NULL)
+        {
+            fprintf(stderr, "%s: Memory allocation falied\n", __func__);
+            exit(1);
+        }
+        s->intervals = grown;
+    }
+
+    interval_t w = s->intervals[worst];
+    double mid = (w.a + w.b) / 2.0;
+    s->intervals[worst] = kronrod_rule(w.a, mid, fx);
+    s->intervals[s->n++] = kronrod_rule(mid, w.b, fx + KRONROD_POINTS);
+    s->result.n_evals += 2 * KRONROD_POINTS;
+}
+
+quad_result_t gauss_kronrod(quad_function_t f, void *params, double a, double b, double tol)
+{
+    if (f == NULL)
+    {
+        fprintf(stderr, "%s: Null function\n", __func__);
+        return failed();
+    }
+
+    double x[2 * KRONROD_POINTS], fx[2 * KRONROD_POINTS];
+    kronrod_abscissae(a, b, x);
+    for (size_t i = 0; i < KRONROD_POINTS; ++i)
+        fx[i] = f(x[i], params);
+
+    kronrod_state_t s;
+    kronrod_init(&s, a, b, fx);
+
+    size_t worst;
+    while (!kronrod_done(&s, tol, &worst))
+    {
+        kronrod_split_abscissae(&s, worst, x);
+        for (size_t i = 0; i < 2 * KRONROD_POINTS; ++i)
+            fx[i] = f(x[i], params);
+        kronrod_split(&s, worst, fx);
+    }
+
+    free(s.intervals);
+    return s.result;
+}
+
+typedef struct batch_job_t
+{
+    quad_batch_function_t f;
+    void *params;
+    size_t n_problems;
+    const double *a, *b;
+    double tol;
+    quad_result_t *results;
+} batch_job_t;
+
+/*
+Integrates one block of problems. Every round collects the abscissae of
+all unfinished problems, evaluates them in a single call to f and then
+advances each problem, so the callback always sees a wide batch.
+*/
+static void batch_block(void *ctx, size_t block)
+{
+    const batch_job_t *job = ctx;
+    size_t first = block * QUAD_BATCH_BLOCK;
+    size_t count = job->n_problems - first < QUAD_BATCH_BLOCK ? job->n_problems - first : QUAD_BATCH_BLOCK;
+
+    kronrod_state_t states[QUAD_BATCH_BLOCK];
+    size_t active[QUAD_BATCH_BLOCK], worst[QUAD_BATCH_BLOCK];
+    size_t problem[QUAD_BATCH_BLOCK * 2 * KRONROD_POINTS];
+    double x[QUAD_BATCH_BLOCK * 2 * KRONROD_POINTS], fx[QUAD_BATCH_BLOCK * 2 * KRONROD_POINTS];
+
+    size_t n = 0;
+    for (size_t k = 0; k < count; ++k)
+    {
+        kronrod_abscissae(job->a[first + k], job->b[first + k], x + n);
+        for (size_t i = 0; i < KRONROD_POINTS; ++i)
+            problem[n++] = first + k;
+    }
+    job->f(n, x, problem, fx, job->params);
+
+    size_t n_active = 0;
+    for (size_t k = 0; k < count; ++k)
+    {
+        kronrod_init(&states[k], job->a[first + k], job->b[first + k], fx + k * KRONROD_POINTS);
+        active[n_active++] = k;
+    }
+
+    while (n_active > 0)
+    {
+        // Retire the finished problems, queue the others' next bisection
+        size_t still_active = 0;
+        n = 0;
+        for (size_t j = 0; j < n_active; ++j)
+        {
+            size_t k = active[j];
+            if (kronrod_done(&states[k], job->tol, &worst[k]))
+            {
+                job->results[first + k] = states[k].result;
+                free(states[k].intervals);
+                continue;
+            }
+
+            kronrod_split_abscissae(&states[k], worst[k], x + n);
+            for (size_t i = 0; i < 2 * KRONROD_POINTS; ++i)
+                problem[n++] = first + k;
+            active[still_active++] = k;
+        }
+        n_active = still_active;
+
+        if (n_active == 0)
+            break;
+
+        job->f(n, x, problem, fx, job->params);
+        for (size_t j = 0; j < n_active; ++j)
+            kronrod_split(&states[active[j]], worst[active[j]], fx + j * 2 * KRONROD_POINTS);
+    }
+}
+
+void gauss_kronrod_batch(quad_batch_function_t f, void *params, size_t n_problems, const double a[],
+                         const double b[], double tol, quad_result_t results[])
+{
+    if (f == NULL || a == NULL || b == NULL || results == NULL)
+    {
+        fprintf(stderr, "%s: Null function or array\n", __func__);
+        return;
+    }
+
+    batch_job_t job = {f, params, n_problems, a, b, tol, results};
+    parallel_for((n_problems + QUAD_BATCH_BLOCK - 1) / QUAD_BATCH_BLOCK, batch_block, &job);
+}
+
+// Simpson's rule on n samples at x[index[0]], x[index[1]], ...
+static double simpson_indexed(const double y[], const double x[], const size_t index[], size_t n)
+{
+    double integral = 0.0;
+    size_t i = 0;
+
+    // Non-uniform Simpson over pairs of subintervals
+    for (; i + 2 < n; i += 2)
+    {
+        double y0 = y[index[i]], y1 = y[index[i + 1]], y2 = y[index[i + 2]];
+        double h0 = x[index[i + 1]] - x[index[i]];
+        double h1 = x[index[i + 2]] - x[index[i + 1]];
+        double h = h0 + h1;
+
+        integral += h / 6.0 * ((2.0 - h1 / h0) * y0 + h * h / (h0 * h1) * y1 + (2.0 - h0 / h1) * y2);
+    }
+
+    if (i + 1 < n)
+    {
+        if (n == 2)
+        {
+            // A single subinterval leaves only the trapezoidal rule
+            integral += (y[index[0]] + y[index[1]]) * (x[index[1]] - x[index[0]]) / 2.0;
+        }
+        else
+        {
+            // Odd subinterval count, the last one is integrated using the
+            // parabola through the last three samples
+            double y0 = y[index[n - 3]], y1 = y[index[n - 2]], y2 = y[index[n - 1]];
+            double h0 = x[index[n - 2]] - x[index[n - 3]];
+            double h1 = x[index[n - 1]] - x[index[n - 2]];
+
+            integral += (2.0 * h1 * h1 + 3.0 * h0 * h1) / (6.0 * (h0 + h1)) * y2 +
+                        (h1 * h1 + 3.0 * h0 * h1) / (6.0 * h0) * y1 - h1 * h1 * h1 / (6.0 * h0 * (h0 + h1)) * y0;
+        }
+    }
+    return integral;
+}
+
+// Checks that y and x are usable sampled data of at least n samples
+static bool check_samples(const vector_t *y, const vector_t *x, size_t n, const char *caller)
+{
+    if (y == NULL || x == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", caller);
+        return false;
+    }
+
+    if (y->size != x->size || y->size < n)
+    {
+        fprintf(stderr, "%s: Different size vectors or fewer than %zu samples\n", caller, n);
+        return false;
+    }
+    return true;
+}
+
+quad_result_t simpson_sampled(const vector_t *y, const vector_t *x, double tol)
+{
+    if (!check_samples(y, x, 2, __func__))
+        return failed();
+
+    size_t n = y->size;
+    size_t *index = malloc(sizeof(size_t) * n);
+    if (index == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation falied\n", __func__);
+        exit(1);
+    }
+
+    for (size_t i = 0; i < n; ++i)
+        index[i] = i;
+    double fine = simpson_indexed(y->arr, x->arr, index, n);
+
+    // Every other sample, keeping the last one so both cover [x0, xn]
+    size_t m = 0;
+    for (size_t i = 0; i < n; i += 2)
+        index[m++] = i;
+    if (index[m - 1] != n - 1)
+        index[m++] = n - 1;
+    double coarse = simpson_indexed(y->arr, x->arr, index, m);
+
+    free(index);
+
+    // Two samples leave nothing to compare against
+    quad_result_t r = {fine, n > 2 ? fabs(fine - coarse) / 15.0 : INFINITY, n, false};
+    r.converged = r.error <= tol;
+    return r;
+}
+
+quad_result_t romberg_sampled(const vector_t *y, const vector_t *x, double tol)
+{
+    if (!check_samples(y, x, 2, __func__))
+        return failed();
+
+    size_t n = y->size;
+    size_t levels = 0;
+    while (((size_t)1 << levels) < n - 1)
+        ++levels;
+
+    if (((size_t)1 << levels) != n - 1 || levels > QUAD_MAX_LEVELS)
+    {
+        fprintf(stderr, "%s: Need 2^k + 1 samples\n", __func__);
+        return failed();
+    }
+
+    double h = (x->arr[n - 1] - x->arr[0]) / (double)(n - 1);
+    for (size_t i = 1; i < n; ++i)
+    {
+        if (fabs(x->arr[i] - x->arr[i - 1] - h) > 1e-8 * fabs(h))
+        {
+            fprintf(stderr, "%s: Samples are not uniformly spaced\n", __func__);
+            return failed();
+        }
+    }
+
+    // Row k of the table uses every 2^(levels - k)th sample
+    double previous[QUAD_MAX_LEVELS + 1], current[QUAD_MAX_LEVELS + 1];
+    size_t stride = n - 1;
+    previous[0] = h * (double)stride / 2.0 * (y->arr[0] + y->arr[n - 1]);
+
+    quad_result_t r = {previous[0], INFINITY, n, false};
+
+    for (size_t k = 1; k <= levels; ++k)
+    {
+        stride /= 2;
+        double midpoints = 0.0;
+        for (size_t i = stride; i < n - 1; i += 2 * stride)
+            midpoints += y->arr[i];
+
+        current[0] = previous[0] / 2.0 + h * (double)stride * midpoints;
+        double factor = 1.0;
+        for (size_t j = 1; j <= k; ++j)
+        {
+            factor *= 4.0;
+            current[j] = current[j - 1] + (current[j - 1] - previous[j - 1]) / (factor - 1.0);
+        }
+
+        r.value = current[k];
+        r.error = fabs(current[k] - previous[k - 1]);
+
+        for (size_t j = 0; j <= k; ++j)
+            previous[j] = current[j];
+    }
+
+    r.converged = r.error <= tol;
+    return r;
+}
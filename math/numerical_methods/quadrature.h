@@ -0,0 +1,106 @@
+#ifndef QUADRATURE_H_
+
+#define QUADRATURE_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "../vector/vector.h"
+
+/*
+Numerical integration to a requested absolute tolerance.
+
+The integrators refine until their error estimate drops to tol or a
+refinement limit is hit, and report what they got either way:
+
+    quad_result_t r = gauss_kronrod(f, params, a, b, 1e-10);
+    if (!r.converged)
+        ...r.value is the best estimate, r.error how far off it may be...
+
+The integrand takes the abscissa and an opaque params pointer, which is
+passed through untouched, so one function can serve a family of
+integrands. Simpson and Romberg also accept sampled vector_t data. The
+Gauss rules pick their own abscissae, which gauss_legendre_nodes() and
+gauss_legendre_weights() expose for data sampled there.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef double (*quad_function_t)(double x, void *params);
+
+typedef struct quad_result_t
+{
+    double value;
+    double error;   // Estimated absolute error of value
+    size_t n_evals; // Integrand evaluations used
+    bool converged; // error <= tol
+} quad_result_t;
+
+// Simpson and Romberg stop after 2^QUAD_MAX_LEVELS subintervals
+#define QUAD_MAX_LEVELS 20
+
+// Largest number of points per panel for gauss_legendre()
+#define QUAD_MAX_ORDER 64
+
+// Largest number of subintervals gauss_kronrod() splits the range into
+#define QUAD_MAX_INTERVALS 2048
+
+// Composite Simpson's rule, doubling the subintervals until two estimates agree
+quad_result_t simpson(quad_function_t f, void *params, double a, double b, double tol);
+
+// Romberg integration, Richardson extrapolation of the trapezoidal rule
+quad_result_t romberg(quad_function_t f, void *params, double a, double b, double tol);
+
+/*
+Composite Gauss–Legendre with order points per panel, doubling the
+panels until two estimates agree. Like simpson() and romberg() it
+refines a few times before trusting the estimate. order is at most
+QUAD_MAX_ORDER.
+*/
+quad_result_t gauss_legendre(quad_function_t f, void *params, double a, double b, size_t order, double tol);
+
+// Adaptive 7 point Gauss, 15 point Kronrod, bisecting the worst subinterval
+quad_result_t gauss_kronrod(quad_function_t f, void *params, double a, double b, double tol);
+
+/*
+Integrand for many problems at once: fx[i] is the integrand of problem
+problem[i] at x[i], for i < n. params is passed through as in
+quad_function_t and usually holds per-problem data indexed by problem[i].
+The abscissae of one problem are consecutive.
+*/
+typedef void (*quad_batch_function_t)(size_t n, const double x[], const size_t problem[], double fx[], void *params);
+
+// Problems integrated together, a callback gets up to 30 abscissae per problem
+#define QUAD_BATCH_BLOCK 64
+
+/*
+gauss_kronrod() for every problem i < n_problems over [a[i], b[i]],
+writing results[i]. Blocks of QUAD_BATCH_BLOCK problems are spread over
+the thread pool of vector_parallel.h, so f must be safe to call from
+several threads. Each result is the same as gauss_kronrod() would give.
+*/
+void gauss_kronrod_batch(quad_batch_function_t f, void *params, size_t n_problems, const double a[],
+                         const double b[], double tol, quad_result_t results[]);
+
+// Gauss–Legendre nodes of the given order mapped onto [a, b]
+vector_t *gauss_legendre_nodes(size_t order, double a, double b);
+
+// Weights matching gauss_legendre_nodes(), so the integral is dot(weights, y)
+vector_t *gauss_legendre_weights(size_t order, double a, double b);
+
+/*
+Simpson's rule over samples y at possibly non-uniform abscissae x. The
+error estimate compares against the rule on every other sample. Sampled
+data cannot be refined, so converged only says whether error <= tol.
+*/
+quad_result_t simpson_sampled(const vector_t *y, const vector_t *x, double tol);
+
+// Romberg over 2^k + 1 uniformly spaced samples
+quad_result_t romberg_sampled(const vector_t *y, const vector_t *x, double tol);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
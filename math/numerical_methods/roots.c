@@ -0,0 +1,312 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+#include "roots.h"
+#include "../vector/vector_parallel.h"
+
+// Grid points sampled, or brackets refined, per thread pool task
+#define ROOT_BLOCK 1024
+
+static root_t not_bracketed(const char *caller)
+{
+    fprintf(stderr, "%s: Root not bracketed\n", caller);
+    root_t r = {NAN, NAN, 0, 0, false};
+    return r;
+}
+
+// +1 if f rises through zero going from a to b in increasing x, else -1
+static int crossing(double a, double b, double fa, double fb)
+{
+    return (fb > fa) == (b > a) ? 1 : -1;
+}
+
+// Brent's method from known end point values (Brent 1973, zeroin)
+static root_t brent_known(root_function_t f, void *params, double a, double b, double fa, double fb, double tol)
+{
+    root_t r = {b, fb, crossing(a, b, fa, fb), 0, false};
+
+    double c = b, fc = fb;
+    double d = b - a, e = d;
+
+    for (int iteration = 0; iteration < ROOT_MAX_ITERATIONS; ++iteration)
+    {
+        // Keep the root between b and c, with b the better estimate
+        if ((fb > 0.0) == (fc > 0.0))
+        {
+            c = a;
+            fc = fa;
+            d = e = b - a;
+        }
+        if (fabs(fc) < fabs(fb))
+        {
+            a = b;
+            b = c;
+            c = a;
+            fa = fb;
+            fb = fc;
+            fc = fa;
+        }
+
+        double tol1 = 2.0 * DBL_EPSILON * fabs(b) + tol / 2.0;
+        double m = (c - b) / 2.0;
+
+        if (fabs(m) <= tol1 || fb == 0.0)
+        {
+            r.converged = true;
+            break;
+        }
+
+        if (fabs(e) >= tol1 && fabs(fa) > fabs(fb))
+        {
+            // Secant or inverse quadratic interpolation
+            double s = fb / fa, p, q;
+            if (a == c)
+            {
+                p = 2.0 * m * s;
+                q = 1.0 - s;
+            }
+            else
+            {
+                double qa = fa / fc, rb = fb / fc;
+                p = s * (2.0 * m * qa * (qa - rb) - (b - a) * (rb - 1.0));
+                q = (qa - 1.0) * (rb - 1.0) * (s - 1.0);
+            }
+
+            if (p > 0.0)
+                q = -q;
+            else
+                p = -p;
+
+            // Accept the step only if it stays well inside the bracket
+            if (2.0 * p < fmin(3.0 * m * q - fabs(tol1 * q), fabs(e * q)))
+            {
+                e = d;
+                d = p / q;
+            }
+            else
+            {
+                d = e = m;
+            }
+        }
+        else
+        {
+            d = e = m;
+        }
+
+        a = b;
+        fa = fb;
+        b += fabs(d) > tol1 ? d : (m > 0.0 ? tol1 : -tol1);
+        fb = f(b, params);
+        ++r.n_evals;
+    }
+
+    r.x = b;
+    r.fx = fb;
+    return r;
+}
+
+root_t brent(root_function_t f, void *params, double a, double b, double tol)
+{
+    double fa = f(a, params), fb = f(b, params);
+
+    if ((fa > 0.0 && fb > 0.0) || (fa < 0.0 && fb < 0.0))
+        return not_bracketed(__func__);
+
+    if (fa == 0.0)
+    {
+        root_t r = {a, 0.0, 0, 2, true};
+        return r;
+    }
+
+    root_t r = brent_known(f, params, a, b, fa, fb, tol);
+    r.n_evals += 2;
+    return r;
+}
+
+// Newton's method from known end point values, bisecting whenever the
+// step would leave the bracket or is not shrinking fast enough
+static root_t newton_known(root_function_t f, root_function_t df, void *params, double a, double b, double fa,
+                           double fb, double tol)
+{
+    root_t r = {0.0, 0.0, crossing(a, b, fa, fb), 0, false};
+
+    if (fb == 0.0)
+    {
+        r.x = b;
+        r.converged = true;
+        return r;
+    }
+
+    // f(lo) < 0 < f(hi)
+    double lo = fa < 0.0 ? a : b;
+    double hi = fa < 0.0 ? b : a;
+
+    double x = (a + b) / 2.0;
+    double dx_old = fabs(b - a), dx = dx_old;
+    double fx = f(x, params), dfx = df(x, params);
+    r.n_evals += 2;
+
+    for (int iteration = 0; iteration < ROOT_MAX_ITERATIONS && fx != 0.0; ++iteration)
+    {
+        if (((x - hi) * dfx - fx) * ((x - lo) * dfx - fx) > 0.0 || fabs(2.0 * fx) > fabs(dx_old * dfx))
+        {
+            dx_old = dx;
+            dx = (hi - lo) / 2.0;
+            x = lo + dx;
+        }
+        else
+        {
+            dx_old = dx;
+            dx = fx / dfx;
+            x -= dx;
+        }
+
+        fx = f(x, params);
+        dfx = df(x, params);
+        r.n_evals += 2;
+
+        if (fx < 0.0)
+            lo = x;
+        else
+            hi = x;
+
+        if (fabs(dx) <= 2.0 * DBL_EPSILON * fabs(x) + tol / 2.0)
+            break;
+    }
+
+    r.x = x;
+    r.fx = fx;
+    r.converged = fx == 0.0 || fabs(dx) <= 2.0 * DBL_EPSILON * fabs(x) + tol / 2.0;
+    return r;
+}
+
+root_t newton_bracketed(root_function_t f, root_function_t df, void *params, double a, double b, double tol)
+{
+    double fa = f(a, params), fb = f(b, params);
+
+    if ((fa > 0.0 && fb > 0.0) || (fa < 0.0 && fb < 0.0))
+        return not_bracketed(__func__);
+
+    if (fa == 0.0)
+    {
+        root_t r = {a, 0.0, 0, 2, true};
+        return r;
+    }
+
+    root_t r = newton_known(f, df, params, a, b, fa, fb, tol);
+    r.n_evals += 2;
+    return r;
+}
+
+typedef struct root_job_t
+{
+    root_function_t f, df;
+    void *params;
+    double a, b;
+    size_t n_grid;
+    double tol;
+    double *fgrid;      // f at every grid point
+    size_t *brackets;   // Grid index of each root, a sign change or an exact zero
+    root_t *roots;
+    size_t n_brackets;
+} root_job_t;
+
+static double grid_point(const root_job_t *job, size_t i)
+{
+    if (i == job->n_grid - 1)
+        return job->b;
+    return job->a + (job->b - job->a) * (double)i / (double)(job->n_grid - 1);
+}
+
+static void sample_block(void *ctx, size_t block)
+{
+    root_job_t *job = ctx;
+    size_t end = (block + 1) * ROOT_BLOCK < job->n_grid ? (block + 1) * ROOT_BLOCK : job->n_grid;
+
+    for (size_t i = block * ROOT_BLOCK; i < end; ++i)
+        job->fgrid[i] = job->f(grid_point(job, i), job->params);
+}
+
+static void refine_block(void *ctx, size_t block)
+{
+    root_job_t *job = ctx;
+    size_t end = (block + 1) * ROOT_BLOCK < job->n_brackets ? (block + 1) * ROOT_BLOCK : job->n_brackets;
+
+    for (size_t k = block * ROOT_BLOCK; k < end; ++k)
+    {
+        size_t i = job->brackets[k];
+        double x0 = grid_point(job, i), f0 = job->fgrid[i];
+
+        if (f0 == 0.0)
+        {
+            // Exact zero on the grid, its neighbours tell the direction
+            double left = i > 0 ? job->fgrid[i - 1] : 0.0;
+            double right = i + 1 < job->n_grid ? job->fgrid[i + 1] : 0.0;
+            root_t r = {x0, 0.0, left < 0.0 && right > 0.0 ? 1 : (left > 0.0 && right < 0.0 ? -1 : 0), 0, true};
+            job->roots[k] = r;
+            continue;
+        }
+
+        double x1 = grid_point(job, i + 1), f1 = job->fgrid[i + 1];
+        if (job->df != NULL)
+            job->roots[k] = newton_known(job->f, job->df, job->params, x0, x1, f0, f1, job->tol);
+        else
+            job->roots[k] = brent_known(job->f, job->params, x0, x1, f0, f1, job->tol);
+    }
+}
+
+size_t find_roots(root_function_t f, root_function_t df, void *params, double a, double b, size_t n_grid,
+                  double tol, root_t roots[], size_t max_roots)
+{
+    if (f == NULL || n_grid < 2 || (roots == NULL && max_roots > 0))
+    {
+        fprintf(stderr, "%s: Null function or output, or fewer than 2 grid points\n", __func__);
+        return 0;
+    }
+
+    root_job_t job = {f, df, params, a, b, n_grid, tol, NULL, NULL, roots, 0};
+    job.fgrid = malloc(sizeof(double) * n_grid);
+    job.brackets = malloc(sizeof(size_t) * ((max_roots < n_grid ? max_roots : n_grid) + 1));
+
+    if (job.fgrid == NULL || job.brackets == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation falied\n", __func__);
+        exit(1);
+    }
+
+    parallel_for((n_grid + ROOT_BLOCK - 1) / ROOT_BLOCK, sample_block, &job);
+
+    size_t found = 0;
+    for (size_t i = 0; i < n_grid; ++i)
+    {
+        double f0 = job.fgrid[i];
+        bool root = f0 == 0.0;
+
+        // A zero at the next point is counted there, not as a sign change here
+        if (!root && i + 1 < n_grid)
+        {
+            double f1 = job.fgrid[i + 1];
+            root = (f0 < 0.0 && f1 > 0.0) || (f0 > 0.0 && f1 < 0.0);
+        }
+
+        if (root)
+        {
+            if (found < max_roots)
+                job.brackets[job.n_brackets++] = i;
+            ++found;
+        }
+    }
+
+    parallel_for((job.n_brackets + ROOT_BLOCK - 1) / ROOT_BLOCK, refine_block, &job);
+
+    free(job.fgrid);
+    free(job.brackets);
+    return found;
+}
+
+size_t find_extrema(root_function_t df, root_function_t d2f, void *params, double a, double b, size_t n_grid,
+                    double tol, root_t extrema[], size_t max_extrema)
+{
+    return find_roots(df, d2f, params, a, b, n_grid, tol, extrema, max_extrema);
+}
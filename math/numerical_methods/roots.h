@@ -0,0 +1,71 @@
+#ifndef ROOTS_H_
+
+#define ROOTS_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+Root and extremum finding by bracketing and refinement.
+
+find_roots() samples f on a coarse uniform grid over [a, b], brackets
+every sign change and refines each bracket with Brent's method, or with
+Newton's method safeguarded by bisection when the derivative is given.
+The grid only has to be fine enough to separate the roots; accuracy
+comes from the refinement, which stops at tol or at machine precision
+when tol is 0. Grid sampling and refinement run on the thread pool of
+vector_parallel.h, so the functions must be safe to call from several
+threads.
+
+    root_t roots[16];
+    size_t n = find_roots(f, df, params, 0, 10, 100, 0.0, roots, 16);
+
+Extrema are the roots of the derivative. A root's direction tells a
+minimum of f (df rising through zero) from a maximum.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef double (*root_function_t)(double x, void *params);
+
+typedef struct root_t
+{
+    double x;
+    double fx;       // f(x), 0 or as close as the arithmetic allows
+    int direction;   // +1 where f crosses from negative to positive, -1 the other way, 0 if unknown
+    size_t n_evals;  // Function and derivative evaluations spent refining
+    bool converged;  // Bracket narrowed to tolerance
+} root_t;
+
+// Iteration limit of the refinement methods
+#define ROOT_MAX_ITERATIONS 200
+
+// Brent's method on [a, b], f(a) and f(b) must differ in sign
+root_t brent(root_function_t f, void *params, double a, double b, double tol);
+
+// Newton's method kept inside [a, b] by bisection, f(a) and f(b) must differ in sign
+root_t newton_bracketed(root_function_t f, root_function_t df, void *params, double a, double b, double tol);
+
+/*
+Finds the roots of f in [a, b] from n_grid >= 2 samples. The first
+max_roots roots, in increasing order, are written to roots and the total
+number found is returned. df may be NULL, which selects Brent's method.
+*/
+size_t find_roots(root_function_t f, root_function_t df, void *params, double a, double b, size_t n_grid,
+                  double tol, root_t roots[], size_t max_roots);
+
+/*
+Finds the extrema of a function from its derivative df, as the roots of
+df. d2f, the second derivative, may be NULL. direction is +1 at minima
+and -1 at maxima.
+*/
+size_t find_extrema(root_function_t df, root_function_t d2f, void *params, double a, double b, size_t n_grid,
+                    double tol, root_t extrema[], size_t max_extrema);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
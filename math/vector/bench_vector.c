@@ -0,0 +1,514 @@
+/*
+Benchmarks every public function in vector.h, and the float32 and
+summation variants of the hot ones, over a sweep of sizes.
+
+    ./bench_vector [options]
+
+    --min N          smallest size (default 1e2)
+    --max N          largest size (default 1e8)
+    --reps N         timed repetitions per case (default 5)
+    --filter TEXT    only run cases whose name contains TEXT
+    --isa NAME       cap the kernels at scalar, sse2, avx2 or avx512
+    --json FILE      write the results as JSON to FILE
+    --compare FILE   compare against a saved JSON baseline
+    --tolerance X    allowed slowdown before a case counts as a
+                     regression (default 0.10, i.e. 10%)
+
+Sizes go up by powers of ten. Each case gets one untimed warm-up run and
+is then timed --reps times; the fastest run is reported as ns/element
+and GB/s, where the byte count is the data the function must read and
+write. With --compare the exit status is 1 if any case regressed.
+VECTOR_SUM selects the summation policy of the plain reductions.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "vector.h"
+#include "vector_kernels.h"
+#include "vector_scan.h"
+#include "vector_generator.h"
+#include "vector_sum.h"
+#include "vector_types.h"
+
+typedef struct bench_data_t
+{
+    size_t n;
+    vector_t *x;
+    vector_t *y;
+    vector_t *z;
+    vector_t *out;
+    double *raw;
+    vector_f32_t *xf;
+    vector_f32_t *yf;
+    vector_f32_t *outf;
+    double sink;
+} bench_data_t;
+
+typedef struct bench_case_t
+{
+    const char *name;
+    size_t bytes_per_element;
+    size_t max_size; // 0 for no limit
+    void (*run)(bench_data_t *d);
+} bench_case_t;
+
+typedef struct bench_result_t
+{
+    char name[64];
+    size_t size;
+    double ns_per_element;
+    double gb_per_s;
+} bench_result_t;
+
+static double plus(double a, double b)
+{
+    return a + b;
+}
+
+/* ---------------------------- Cases ----------------------------- */
+
+static void run_empty(bench_data_t *d) { free_vector(empty(d->n)); }
+static void run_empty_like(bench_data_t *d) { free_vector(empty_like(d->x)); }
+static void run_zeros(bench_data_t *d) { free_vector(zeros(d->n)); }
+static void run_zeros_like(bench_data_t *d) { free_vector(zeros_like(d->x)); }
+static void run_arange(bench_data_t *d) { free_vector(arange(0.0, (double)d->n, 1.0)); }
+static void run_linspace(bench_data_t *d) { free_vector(linspace(0.0, 1.0, d->n)); }
+static void run_gradient(bench_data_t *d) { free_vector(gradient(d->y, d->x)); }
+static void run_apply_function(bench_data_t *d) { apply_function(d->out, fabs); }
+static void run_function_like(bench_data_t *d) { free_vector(function_like(d->x, fabs)); }
+static void run_get_copy(bench_data_t *d) { free_vector(get_copy(d->x)); }
+static void run_get_result(bench_data_t *d) { free_vector(get_result(d->x, d->y, plus)); }
+static void run_from_array(bench_data_t *d) { free_vector(from_array(d->raw, d->n)); }
+static void run_to_array(bench_data_t *d) { free(to_array(d->x)); }
+static void run_trapezoidal_rule(bench_data_t *d) { d->sink += trapezoidal_rule(d->y, d->x); }
+static void run_reduce(bench_data_t *d) { d->sink += reduce(plus, d->x); }
+static void run_add(bench_data_t *d) { free_vector(add(d->x, d->y)); }
+static void run_subtract(bench_data_t *d) { free_vector(subtract(d->x, d->y)); }
+static void run_multiply(bench_data_t *d) { free_vector(multiply(d->x, d->y)); }
+static void run_divide(bench_data_t *d) { free_vector(divide(d->x, d->y)); }
+static void run_multiply_add(bench_data_t *d) { free_vector(multiply_add(d->x, d->y, d->z)); }
+static void run_scale(bench_data_t *d) { scale(d->out, 1.0); }
+static void run_axpy(bench_data_t *d) { axpy(0.0, d->x, d->out); }
+static void run_dot(bench_data_t *d) { d->sink += dot(d->x, d->y); }
+static void run_sum(bench_data_t *d) { d->sink += sum(d->x); }
+static void run_linspace_into(bench_data_t *d) { linspace_into(d->out, 0.0, 1.0); }
+static void run_arange_into(bench_data_t *d) { arange_into(d->out, 0.0, (double)d->n, 1.0); }
+static void run_gradient_into(bench_data_t *d) { gradient_into(d->out, d->y, d->x); }
+static void run_function_like_into(bench_data_t *d) { function_like_into(d->out, d->x, fabs); }
+static void run_get_copy_into(bench_data_t *d) { get_copy_into(d->out, d->x); }
+static void run_get_result_into(bench_data_t *d) { get_result_into(d->out, d->x, d->y, plus); }
+static void run_from_array_into(bench_data_t *d) { from_array_into(d->out, d->raw); }
+static void run_add_into(bench_data_t *d) { add_into(d->out, d->x, d->y); }
+static void run_subtract_into(bench_data_t *d) { subtract_into(d->out, d->x, d->y); }
+static void run_multiply_into(bench_data_t *d) { multiply_into(d->out, d->x, d->y); }
+static void run_divide_into(bench_data_t *d) { divide_into(d->out, d->x, d->y); }
+static void run_multiply_add_into(bench_data_t *d) { multiply_add_into(d->out, d->x, d->y, d->z); }
+static void run_cumsum_into(bench_data_t *d) { cumsum_into(d->out, d->x); }
+static void run_cumtrapz_into(bench_data_t *d) { cumtrapz_into(d->out, d->y, d->x); }
+static void run_gen_function_like_into(bench_data_t *d) { gen_function_like_into(d->out, gen_linspace(0.0, 1.0, d->n), fabs); }
+static void run_gen_trapezoidal_rule(bench_data_t *d) { d->sink += gen_trapezoidal_rule(d->y, gen_linspace(0.0, 1.0, d->n)); }
+static void run_sum_compensated(bench_data_t *d) { d->sink += sum_with(SUM_COMPENSATED, d->x); }
+static void run_sum_pairwise(bench_data_t *d) { d->sink += sum_with(SUM_PAIRWISE, d->x); }
+static void run_sum_reproducible(bench_data_t *d) { d->sink += sum_with(SUM_REPRODUCIBLE, d->x); }
+static void run_dot_reproducible(bench_data_t *d) { d->sink += dot_with(SUM_REPRODUCIBLE, d->x, d->y); }
+static void run_trapz_reproducible(bench_data_t *d) { d->sink += trapezoidal_rule_with(SUM_REPRODUCIBLE, d->y, d->x); }
+
+static void run_add_into_f32(bench_data_t *d) { add_into_f32(d->outf, d->xf, d->yf); }
+static void run_multiply_add_into_f32(bench_data_t *d) { multiply_add_into_f32(d->outf, d->xf, d->yf, d->xf); }
+static void run_axpy_f32(bench_data_t *d) { axpy_f32(0.0f, d->xf, d->outf); }
+static void run_dot_f32(bench_data_t *d) { d->sink += dot_f32(d->xf, d->yf); }
+static void run_sum_f32(bench_data_t *d) { d->sink += sum_f32(d->xf); }
+static void run_to_f32_into(bench_data_t *d) { to_f32_into(d->outf, d->x); }
+static void run_to_f64_into(bench_data_t *d) { to_f64_into(d->out, d->xf); }
+
+static void run_get_ve(bench_data_t *d)
+{
+    double s = 0.0;
+    for (size_t i = 0; i < d->n; ++i)
+        s += get_ve(d->x, (int)i);
+    d->sink += s;
+}
+
+// print_vector() output is sent to /dev/null while it is timed
+static void run_print_vector(bench_data_t *d)
+{
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+
+    print_vector(d->x);
+
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(null);
+    close(saved);
+}
+
+#define D sizeof(double)
+#define F sizeof(float)
+
+static const bench_case_t cases[] = {
+    {"empty", 0, 0, run_empty},
+    {"empty_like", 0, 0, run_empty_like},
+    {"zeros", D, 0, run_zeros},
+    {"zeros_like", D, 0, run_zeros_like},
+    {"arange", D, 0, run_arange},
+    {"linspace", D, 0, run_linspace},
+    {"gradient", 3 * D, 0, run_gradient},
+    {"apply_function", 2 * D, 0, run_apply_function},
+    {"function_like", 2 * D, 0, run_function_like},
+    {"print_vector", D, 1000000, run_print_vector},
+    {"get_copy", 2 * D, 0, run_get_copy},
+    {"get_result", 3 * D, 0, run_get_result},
+    {"from_array", 2 * D, 0, run_from_array},
+    {"to_array", 2 * D, 0, run_to_array},
+    {"trapezoidal_rule", 2 * D, 0, run_trapezoidal_rule},
+    {"reduce", D, 0, run_reduce},
+    {"get_ve", D, 0, run_get_ve},
+    {"add", 3 * D, 0, run_add},
+    {"subtract", 3 * D, 0, run_subtract},
+    {"multiply", 3 * D, 0, run_multiply},
+    {"divide", 3 * D, 0, run_divide},
+    {"multiply_add", 4 * D, 0, run_multiply_add},
+    {"scale", 2 * D, 0, run_scale},
+    {"axpy", 3 * D, 0, run_axpy},
+    {"dot", 2 * D, 0, run_dot},
+    {"sum", D, 0, run_sum},
+    {"linspace_into", D, 0, run_linspace_into},
+    {"arange_into", D, 0, run_arange_into},
+    {"gradient_into", 3 * D, 0, run_gradient_into},
+    {"function_like_into", 2 * D, 0, run_function_like_into},
+    {"get_copy_into", 2 * D, 0, run_get_copy_into},
+    {"get_result_into", 3 * D, 0, run_get_result_into},
+    {"from_array_into", 2 * D, 0, run_from_array_into},
+    {"add_into", 3 * D, 0, run_add_into},
+    {"subtract_into", 3 * D, 0, run_subtract_into},
+    {"multiply_into", 3 * D, 0, run_multiply_into},
+    {"divide_into", 3 * D, 0, run_divide_into},
+    {"multiply_add_into", 4 * D, 0, run_multiply_add_into},
+    {"cumsum_into", 2 * D, 0, run_cumsum_into},
+    {"cumtrapz_into", 3 * D, 0, run_cumtrapz_into},
+    {"gen_function_like_into", D, 0, run_gen_function_like_into},
+    {"gen_trapezoidal_rule", D, 0, run_gen_trapezoidal_rule},
+    {"sum_compensated", D, 0, run_sum_compensated},
+    {"sum_pairwise", D, 0, run_sum_pairwise},
+    {"sum_reproducible", D, 0, run_sum_reproducible},
+    {"dot_reproducible", 2 * D, 0, run_dot_reproducible},
+    {"trapz_reproducible", 2 * D, 0, run_trapz_reproducible},
+    {"add_into_f32", 3 * F, 0, run_add_into_f32},
+    {"multiply_add_into_f32", 4 * F, 0, run_multiply_add_into_f32},
+    {"axpy_f32", 3 * F, 0, run_axpy_f32},
+    {"dot_f32", 2 * F, 0, run_dot_f32},
+    {"sum_f32", F, 0, run_sum_f32},
+    {"to_f32_into", D + F, 0, run_to_f32_into},
+    {"to_f64_into", D + F, 0, run_to_f64_into},
+};
+
+#undef D
+#undef F
+
+/* --------------------------- Harness ---------------------------- */
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static bool make_data(bench_data_t *d, size_t n)
+{
+    memset(d, 0, sizeof(*d));
+    d->n = n;
+    d->x = linspace(1.0, 2.0, n);
+    d->y = empty(n);
+    d->z = empty(n);
+    d->out = zeros(n);
+    d->raw = malloc(sizeof(double) * n);
+    d->xf = linspace_f32(1.0f, 2.0f, n);
+    d->yf = empty_f32(n);
+    d->outf = zeros_f32(n);
+
+    if (d->x == NULL || d->y == NULL || d->z == NULL || d->out == NULL || d->raw == NULL ||
+        d->xf == NULL || d->yf == NULL || d->outf == NULL)
+        return false;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        d->y->arr[i] = sin((double)i);
+        d->z->arr[i] = 0.5;
+        d->raw[i] = (double)i;
+        d->yf->arr[i] = (float)d->y->arr[i];
+    }
+    return true;
+}
+
+static void free_data(bench_data_t *d)
+{
+    free_vector(d->x);
+    free_vector(d->y);
+    free_vector(d->z);
+    free_vector(d->out);
+    free(d->raw);
+    free_vector_f32(d->xf);
+    free_vector_f32(d->yf);
+    free_vector_f32(d->outf);
+}
+
+static bench_result_t time_case(const bench_case_t *c, bench_data_t *d, size_t reps)
+{
+    // Small sizes are batched so each timed run lasts long enough to measure
+    size_t batch = 1;
+    while (batch * d->n < 1000000)
+        batch *= 10;
+
+    c->run(d);
+
+    double best = INFINITY;
+    for (size_t r = 0; r < reps; ++r)
+    {
+        double start = now_seconds();
+        for (size_t b = 0; b < batch; ++b)
+            c->run(d);
+        double elapsed = (now_seconds() - start) / (double)batch;
+
+        if (elapsed < best)
+            best = elapsed;
+    }
+
+    bench_result_t result;
+    snprintf(result.name, sizeof(result.name), "%s", c->name);
+    result.size = d->n;
+    result.ns_per_element = best * 1e9 / (double)d->n;
+    result.gb_per_s = c->bytes_per_element * (double)d->n / best * 1e-9;
+    return result;
+}
+
+/*
+Results are written one per line so the baseline reader below only has
+to understand files this program wrote.
+*/
+static bool write_json(const char *path, const bench_result_t results[], size_t n)
+{
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL)
+    {
+        perror(path);
+        return false;
+    }
+
+    fprintf(fp, "{\n  \"isa\": \"%s\",\n  \"results\": [\n", kernel_isa_name(kernel_isa()));
+    for (size_t i = 0; i < n; ++i)
+    {
+        fprintf(fp, "    {\"name\": \"%s\", \"size\": %zu, \"ns_per_element\": %.6g, \"gb_per_s\": %.6g}%s\n",
+                results[i].name, results[i].size, results[i].ns_per_element, results[i].gb_per_s,
+                i + 1 < n ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+
+    return fclose(fp) == 0;
+}
+
+static bench_result_t *read_json(const char *path, size_t *n)
+{
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL)
+    {
+        perror(path);
+        return NULL;
+    }
+
+    size_t capacity = 64;
+    bench_result_t *results = malloc(sizeof(*results) * capacity);
+    char line[512];
+    *n = 0;
+
+    while (results != NULL && fgets(line, sizeof(line), fp) != NULL)
+    {
+        bench_result_t r;
+        if (sscanf(line, " {\"name\": \"%63[^\"]\", \"size\": %zu, \"ns_per_element\": %lf, \"gb_per_s\": %lf",
+                   r.name, &r.size, &r.ns_per_element, &r.gb_per_s) != 4)
+            continue;
+
+        if (*n == capacity)
+        {
+            capacity *= 2;
+            bench_result_t *grown = realloc(results, sizeof(*results) * capacity);
+            if (grown == NULL)
+            {
+                free(results);
+                results = NULL;
+                break;
+            }
+            results = grown;
+        }
+        results[(*n)++] = r;
+    }
+
+    fclose(fp);
+    return results;
+}
+
+// Prints the comparison and returns the number of regressions
+static size_t compare(const bench_result_t base[], size_t n_base, const bench_result_t results[], size_t n,
+                      double tolerance)
+{
+    size_t regressions = 0;
+
+    fprintf(stderr, "\n%-20s %12s %12s %12s %9s\n", "case", "size", "base ns/el", "ns/el", "change");
+    for (size_t i = 0; i < n; ++i)
+    {
+        for (size_t j = 0; j < n_base; ++j)
+        {
+            if (strcmp(base[j].name, results[i].name) != 0 || base[j].size != results[i].size)
+                continue;
+
+            double change = results[i].ns_per_element / base[j].ns_per_element - 1.0;
+            bool regressed = change > tolerance;
+            regressions += regressed;
+
+            fprintf(stderr, "%-20s %12zu %12.4g %12.4g %+8.1f%%%s\n", results[i].name, results[i].size,
+                    base[j].ns_per_element, results[i].ns_per_element, 100.0 * change,
+                    regressed ? "  REGRESSION" : "");
+            break;
+        }
+    }
+    return regressions;
+}
+
+static size_t parse_size(const char *s)
+{
+    return (size_t)strtod(s, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t min_size = 100, max_size = 100000000, reps = 5;
+    const char *filter = NULL, *json = NULL, *baseline = NULL;
+    double tolerance = 0.10;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (value == NULL)
+        {
+            fprintf(stderr, "%s: Missing value for %s\n", argv[0], arg);
+            return 2;
+        }
+        else if (strcmp(arg, "--min") == 0)
+            min_size = parse_size(value);
+        else if (strcmp(arg, "--max") == 0)
+            max_size = parse_size(value);
+        else if (strcmp(arg, "--reps") == 0)
+            reps = parse_size(value);
+        else if (strcmp(arg, "--filter") == 0)
+            filter = value;
+        else if (strcmp(arg, "--json") == 0)
+            json = value;
+        else if (strcmp(arg, "--compare") == 0)
+            baseline = value;
+        else if (strcmp(arg, "--tolerance") == 0)
+            tolerance = strtod(value, NULL);
+        else if (strcmp(arg, "--isa") == 0)
+        {
+            kernel_isa_t isa = ISA_SCALAR;
+            while (isa <= ISA_AVX512 && strcmp(value, kernel_isa_name(isa)) != 0)
+                ++isa;
+
+            if (isa > ISA_AVX512)
+            {
+                fprintf(stderr, "%s: Unknown ISA %s\n", argv[0], value);
+                return 2;
+            }
+            kernel_select_isa(isa);
+        }
+        else
+        {
+            fprintf(stderr, "%s: Unknown option %s\n", argv[0], arg);
+            return 2;
+        }
+        ++i;
+    }
+
+    if (min_size < 3 || reps == 0)
+    {
+        fprintf(stderr, "%s: --min must be at least 3 and --reps at least 1\n", argv[0]);
+        return 2;
+    }
+
+    const size_t n_cases = sizeof(cases) / sizeof(cases[0]);
+    size_t capacity = 0, n_results = 0;
+    for (size_t n = min_size; n <= max_size; n *= 10)
+        capacity += n_cases;
+
+    bench_result_t *results = malloc(sizeof(*results) * (capacity > 0 ? capacity : 1));
+    if (results == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation failed\n", argv[0]);
+        return 1;
+    }
+
+    fprintf(stderr, "isa: %s\n%-20s %12s %12s %10s\n", kernel_isa_name(kernel_isa()), "case", "size", "ns/element",
+            "GB/s");
+
+    for (size_t n = min_size; n <= max_size; n *= 10)
+    {
+        bench_data_t d;
+        if (!make_data(&d, n))
+        {
+            fprintf(stderr, "%s: Could not allocate vectors of %zu elements\n", argv[0], n);
+            free_data(&d);
+            break;
+        }
+
+        for (size_t c = 0; c < n_cases; ++c)
+        {
+            if (filter != NULL && strstr(cases[c].name, filter) == NULL)
+                continue;
+            if (cases[c].max_size != 0 && n > cases[c].max_size)
+                continue;
+
+            bench_result_t r = time_case(&cases[c], &d, reps);
+            results[n_results++] = r;
+            fprintf(stderr, "%-20s %12zu %12.4g %10.3g\n", r.name, r.size, r.ns_per_element, r.gb_per_s);
+        }
+
+        free_data(&d);
+    }
+
+    int status = 0;
+
+    if (json != NULL && !write_json(json, results, n_results))
+        status = 1;
+
+    if (baseline != NULL)
+    {
+        size_t n_base = 0;
+        bench_result_t *base = read_json(baseline, &n_base);
+        if (base == NULL)
+        {
+            status = 1;
+        }
+        else
+        {
+            size_t regressions = compare(base, n_base, results, n_results, tolerance);
+            fprintf(stderr, "\n%zu regression%s beyond %.0f%%\n", regressions, regressions == 1 ? "" : "s",
+                    100.0 * tolerance);
+            if (regressions > 0)
+                status = 1;
+            free(base);
+        }
+    }
+
+    free(results);
+    return status;
+}
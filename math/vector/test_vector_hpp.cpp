@@ -0,0 +1,141 @@
+/*
+Checks that vec::vector owns heap storage inside an arena scope, and
+that fused expressions give the same bits as the C calls they replace.
+
+    make test
+*/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "vector.hpp"
+#include "vector_arena.h"
+#include "vector_kernels.h"
+#include "vector_sum.h"
+
+static int failures = 0;
+
+static void check(bool ok, const char* what)
+{
+    if (!ok)
+    {
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+static bool same_bits(const vec::vector& fused, const vector_t* c)
+{
+    return c != NULL && fused.size() == c->size &&
+           std::memcmp(fused.data(), c->arr, sizeof(double) * c->size) == 0;
+}
+
+static bool same_bits(double fused, double c)
+{
+    return std::memcmp(&fused, &c, sizeof(double)) == 0;
+}
+
+// C callbacks equivalent to the fused expressions below
+static double c_sin(double t) { return std::sin(t); }
+static double c_exp(double t) { return std::exp(t); }
+static double c_gauss(double t) { return std::exp(-(t * t)); }
+static double c_poly(double t) { return t * t + 1.0; }
+static double c_residual(double a, double b) { return (a - b) * (a - b); }
+static double c_max(double a, double b) { return std::fmax(a, b); }
+
+// Fused expressions against the C functions, on a size with a partial last group of eight
+static void check_fused()
+{
+    const size_t n = 1003;
+    vector_t* x = linspace(-2.0, 3.0, n);
+    vector_t* y_hat = function_like(x, c_sin);
+    vec::vector y(n);
+    for (size_t i = 0; i < n; ++i)
+        y[i] = std::cos(static_cast<double>(i));
+
+    vec::ref xr(x), y_hat_r(y_hat);
+
+    vector_t* c = function_like(x, c_sin);
+    check(same_bits(vec::vector(vec::sin(xr)), c), "sin against function_like");
+    free_vector(c);
+
+    c = function_like(x, c_exp);
+    check(same_bits(vec::vector(vec::exp(xr)), c), "exp against function_like");
+    free_vector(c);
+
+    c = function_like(x, c_gauss);
+    check(same_bits(vec::vector(vec::exp(-vec::square(xr))), c), "exp(-x^2) against function_like");
+    free_vector(c);
+
+    // Residuals materialised by the C calls, then summed by the kernel
+    vector_t* r = subtract(y.get(), y_hat);
+    vector_t* r2 = multiply(r, r);
+    const double fused_sum = vec::sum((y - y_hat_r) * (y - y_hat_r));
+    check(same_bits(fused_sum, kernel_sum(r2->size, r2->arr)), "sum of squared residuals against kernel_sum");
+    check(same_bits(fused_sum, sum_with(SUM_NAIVE, r2)), "sum of squared residuals against sum under SUM_NAIVE");
+    free_vector(r);
+    free_vector(r2);
+
+    c = function_like(x, c_poly);
+    check(same_bits(vec::vector(vec::map(xr, [](double t) { return t * t + 1.0; })), c),
+          "map of a lambda against function_like");
+    free_vector(c);
+
+    c = get_result(y.get(), y_hat, c_residual);
+    check(same_bits(vec::vector(vec::zip(y, y_hat_r, [](double a, double b) { return (a - b) * (a - b); })), c),
+          "zip of a lambda against get_result");
+    free_vector(c);
+
+    check(same_bits(vec::reduce(xr, -INFINITY, [](double a, double b) { return std::fmax(a, b); }), reduce(c_max, x)),
+          "reduce of a lambda against reduce");
+
+    vec::vector applied(xr);
+    vec::apply(applied, [](double t) { return t * t + 1.0; });
+    c = function_like(x, c_poly);
+    check(same_bits(applied, c), "apply of a lambda against function_like");
+    free_vector(c);
+
+    free_vector(x);
+    free_vector(y_hat);
+}
+
+int main()
+{
+    vector_arena_t* arena = arena_create(0);
+    vector_arena_t* previous = arena_use(arena);
+
+    {
+        vec::vector x(4);
+        for (size_t i = 0; i < x.size(); ++i)
+            x[i] = static_cast<double>(i);
+
+        vec::vector copy(x);
+        vec::vector y = 2.0 * x + copy;
+        vec::vector none(0);
+
+        // Resizing assignment from an expression that reads the target
+        none = y + 1.0;
+        y = y * y;
+
+        check(y.size() == 4 && y[3] == 81.0, "expression inside arena_use");
+        check(none.size() == 4 && none[3] == 10.0, "resizing assignment");
+    }
+
+    // C constructors still allocate from the arena inside the scope
+    vector_t* from_arena = empty(4);
+    check(from_arena != NULL, "arena allocation");
+    arena_release(arena, from_arena);
+
+    arena_use(previous);
+    arena_destroy(arena);
+
+    vec::vector adopted = vec::vector::adopt(zeros(3));
+    check(adopted.size() == 3 && adopted[2] == 0.0, "adopt");
+
+    check_fused();
+
+    if (failures == 0)
+        std::printf("test_vector_hpp: all checks passed\n");
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,150 @@
+/*
+Instantiates the macros of vector_inline.h for vector_t and vector_f32_t
+and checks their results, in-place use, arena allocation and overlap
+rejection.
+
+    make test
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "vector_inline.h"
+#include "vector_types.h"
+#include "vector_arena.h"
+
+DEFINE_VECTOR_MAP(square, vector_t, double, x, x * x)
+DEFINE_VECTOR_MAP(ones, vector_t, double, x, 1.0)
+DEFINE_VECTOR_ZIP(hypot2, vector_t, double, a, b, a * a + b * b)
+DEFINE_VECTOR_REDUCE(sum_abs, vector_t, double, x, fabs(x), 0.0, a, b, a + b)
+DEFINE_VECTOR_REDUCE(count, vector_t, double, x, 1.0, 0.0, a, b, a + b)
+
+DEFINE_VECTOR_MAP(half_f32, vector_f32_t, float, x, x * 0.5f)
+DEFINE_VECTOR_ZIP(diff_f32, vector_f32_t, float, a, b, a - b)
+DEFINE_VECTOR_REDUCE(max_f32, vector_f32_t, float, x, x, -INFINITY, a, b, fmaxf(a, b))
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok)
+    {
+        fprintf(stderr, "FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+static double c_square(double x)
+{
+    return x * x;
+}
+
+static double c_hypot2(double a, double b)
+{
+    return a * a + b * b;
+}
+
+static bool same_bits(const vector_t *a, const vector_t *b)
+{
+    return a != NULL && b != NULL && a->size == b->size && memcmp(a->arr, b->arr, sizeof(double) * a->size) == 0;
+}
+
+static void check_f64(void)
+{
+    // 19 elements, so the reductions have a partial last group of eight
+    vector_t *x = linspace(-3.0, 6.0, 19);
+    vector_t *y = linspace(1.0, 2.0, 19);
+
+    vector_t *fused = square(x);
+    vector_t *c = function_like(x, c_square);
+    check(same_bits(fused, c), "map against function_like");
+    free_vector(fused);
+
+    fused = hypot2(x, y);
+    vector_t *c2 = get_result(x, y, c_hypot2);
+    check(same_bits(fused, c2), "zip against get_result");
+    free_vector(fused);
+    free_vector(c2);
+
+    vector_t *all_ones = ones(x);
+    check(all_ones != NULL && all_ones->arr[0] == 1.0 && all_ones->arr[18] == 1.0, "map ignoring its element");
+    free_vector(all_ones);
+
+    check(count(x) == 19.0, "reduce ignoring its element");
+    check(sum_abs(x) == 3.0 + 2.5 + 2.0 + 1.5 + 1.0 + 0.5 + 0.0 + 0.5 + 1.0 + 1.5 + 2.0 + 2.5 + 3.0 + 3.5 + 4.0 +
+                            4.5 + 5.0 + 5.5 + 6.0,
+          "reduce");
+
+    vector_t *in_place = get_copy(x);
+    square_apply(in_place);
+    check(same_bits(in_place, c), "apply in place");
+    check(hypot2_into(in_place, in_place, y) != NULL, "zip into its first input");
+    free_vector(in_place);
+    free_vector(c);
+
+    // shifted's data starts two elements into base's
+    vector_t *base = malloc(sizeof(vector_t) + sizeof(double) * 24);
+    base->size = 19;
+    memcpy(base->arr, x->arr, sizeof(double) * 19);
+    vector_t *shifted = (vector_t *)&base->arr[1];
+    shifted->size = 19;
+    check(square_into(shifted, base) == NULL, "map rejects a partial overlap");
+    check(hypot2_into(shifted, y, base) == NULL, "zip rejects a partial overlap");
+    free(base);
+
+    // vector_t results come from empty(), and so from the active arena
+    vector_arena_t *arena = arena_create(0);
+    vector_arena_t *previous = arena_use(arena);
+    arena_mark_t before = arena_mark(arena);
+    vector_t *from_arena = square(x);
+    arena_mark_t after = arena_mark(arena);
+    check(before.chunk != after.chunk || before.used != after.used, "map allocates from the arena");
+    arena_release(arena, from_arena);
+    arena_use(previous);
+    arena_destroy(arena);
+
+    free_vector(x);
+    free_vector(y);
+}
+
+static void check_f32(void)
+{
+    vector_f32_t *x = linspace_f32(-4.0f, 14.0f, 10);
+    vector_f32_t *y = linspace_f32(0.0f, 9.0f, 10);
+
+    vector_f32_t *half = half_f32(x);
+    check(half != NULL && half->arr[0] == -2.0f && half->arr[9] == 7.0f, "f32 map");
+
+    vector_f32_t *diff = diff_f32(x, y);
+    check(diff != NULL && diff->arr[0] == -4.0f && diff->arr[9] == 5.0f, "f32 zip");
+
+    check(max_f32(x) == 14.0f, "f32 reduce");
+
+    half_f32_apply(x);
+    check(memcmp(x->arr, half->arr, sizeof(float) * x->size) == 0, "f32 apply in place");
+
+    vector_f32_t *base = malloc(sizeof(vector_f32_t) + sizeof(float) * 16);
+    base->size = 10;
+    vector_f32_t *shifted = (vector_f32_t *)&base->arr[2];
+    shifted->size = 10;
+    check(half_f32_into(shifted, base) == NULL, "f32 map rejects a partial overlap");
+    check(diff_f32_into(shifted, base, y) == NULL, "f32 zip rejects a partial overlap");
+    free(base);
+
+    // Other vector types are malloc'd like the rest of their family
+    free_vector_f32(half);
+    free_vector_f32(diff);
+    free_vector_f32(x);
+    free_vector_f32(y);
+}
+
+int main(void)
+{
+    check_f64();
+    check_f32();
+
+    if (failures == 0)
+        printf("test_vector_inline: all checks passed\n");
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
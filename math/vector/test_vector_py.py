@@ -0,0 +1,73 @@
+"""
+Checks that operations on from_numpy() views run on the viewed memory
+without copying it through view_to_vector().
+
+    make test
+"""
+
+import ctypes
+import sys
+
+import vector
+
+failures = 0
+
+
+def check(ok, what):
+    global failures
+    if not ok:
+        print(f"FAILED: {what}", file=sys.stderr)
+        failures += 1
+
+
+class Strided:
+    """Every step-th double of a ctypes array, as NumPy's a[::step] would be"""
+
+    def __init__(self, values, step):
+        self.buf = (ctypes.c_double * len(values))(*values)
+        self.step = step
+
+    @property
+    def __array_interface__(self):
+        return {"shape": ((len(self.buf) + self.step - 1) // self.step,),
+                "typestr": vector._TYPESTR,
+                "data": (ctypes.addressof(self.buf), False),
+                "strides": (self.step * ctypes.sizeof(ctypes.c_double),),
+                "version": 3}
+
+
+def no_copy(view):
+    raise AssertionError("view_to_vector called")
+
+
+x = vector.linspace(0, 2, 33)
+y = x.map(lambda t: t * t)
+
+# A Vector has an __array_interface__, so it stands in for a NumPy array
+vx = vector.from_numpy(x)
+vy = vector.from_numpy(y)
+
+copy = vector.lib.view_to_vector
+vector.lib.view_to_vector = no_copy
+try:
+    check(vy.sum() == y.sum(), "sum")
+    check(vector.dot(vy, vx) == y @ x, "dot of views")
+    check(vector.dot(y, vx) == y @ x, "dot of a vector and a view")
+    check(vector.trapezoidal_rule(vy, vx) == y.trapz(x), "trapz")
+    check(list(vector.gradient(vy, vx)) == list(y.gradient(x)), "gradient")
+    check(list(y.gradient(vx)) == list(y.gradient(x)), "gradient of a vector over a view")
+    check(list(vy + vx) == list(y + x), "add")
+    check(list(x * vy) == list(x * y), "multiply by a view")
+    check(vy.reduce(max) == 4.0, "reduce")
+
+    every_other = vector.from_numpy(Strided([float(i) for i in range(9)], 2))
+    check(every_other.sum() == 0.0 + 2.0 + 4.0 + 6.0 + 8.0, "strided sum")
+    check(list(every_other.map(lambda t: -t)) == [-0.0, -2.0, -4.0, -6.0, -8.0], "strided map")
+finally:
+    vector.lib.view_to_vector = copy
+
+check(list(vy.to_vector()) == list(y), "to_vector copies")
+
+if failures == 0:
+    print("test_vector_py: all checks passed")
+sys.exit(0 if failures == 0 else 1)
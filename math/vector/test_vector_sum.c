@@ -0,0 +1,104 @@
+/*
+Checks that the binned sum of SUM_REPRODUCIBLE gives the same bits for
+any split of the terms, whether the parts are summed on one thread or on
+the pool with any number of threads, and merged in any order.
+
+    make test
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "vector_sum.h"
+#include "vector_parallel.h"
+
+#define N_TERMS 100003
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok)
+    {
+        fprintf(stderr, "FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+static bool same_bits(double a, double b)
+{
+    return memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+typedef struct split_t
+{
+    const double *x;
+    size_t block;
+    sum_binned_t *parts;
+} split_t;
+
+static void sum_block(void *ctx, size_t index)
+{
+    const split_t *split = ctx;
+    size_t first = index * split->block;
+    size_t len = N_TERMS - first < split->block ? N_TERMS - first : split->block;
+
+    sum_binned_init(&split->parts[index]);
+    sum_binned_add(&split->parts[index], len, split->x + first);
+}
+
+// Sums blocks of block terms on the pool and merges them last to first
+static double split_sum(const double x[], size_t block)
+{
+    size_t n_blocks = (N_TERMS + block - 1) / block;
+    split_t split = {x, block, malloc(sizeof(sum_binned_t) * n_blocks)};
+    if (split.parts == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        exit(EXIT_FAILURE);
+    }
+
+    parallel_for(n_blocks, sum_block, &split);
+
+    sum_binned_t total;
+    sum_binned_init(&total);
+    for (size_t i = n_blocks; i-- > 0;)
+        sum_binned_merge(&total, &split.parts[i]);
+
+    free(split.parts);
+    return sum_binned_value(&total);
+}
+
+int main(void)
+{
+    double *x = malloc(sizeof(*x) * N_TERMS);
+    if (x == NULL)
+        return EXIT_FAILURE;
+
+    // Terms spread over twenty decades with both signs, so the order of additions matters naively
+    for (size_t i = 0; i < N_TERMS; ++i)
+        x[i] = sin((double)i) * pow(10.0, (double)(i % 20) - 10.0);
+
+    const double expected = sum_array(SUM_REPRODUCIBLE, N_TERMS, x);
+    const size_t blocks[] = {1, 7, 512, 4096, 33333, N_TERMS};
+    const size_t threads[] = {1, 2, 4, 8};
+
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t)
+    {
+        parallel_set_num_threads(threads[t]);
+
+        for (size_t b = 0; b < sizeof(blocks) / sizeof(blocks[0]); ++b)
+        {
+            char what[80];
+            snprintf(what, sizeof(what), "binned sum of blocks of %zu on %zu threads", blocks[b], threads[t]);
+            check(same_bits(split_sum(x, blocks[b]), expected), what);
+        }
+    }
+
+    free(x);
+
+    if (failures == 0)
+        printf("test_vector_sum: all checks passed\n");
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -3,13 +3,31 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
 #include "vector.h"
+#include "vector_kernels.h"
+#include "vector_sum.h"
+#include "vector_arena.h"
 
+// Allocates a vector of n elements from the active arena, or with malloc
+static vector_t *alloc_vector(size_t n)
+{
+    vector_arena_t *arena = arena_active();
+
+    if (arena != NULL)
+        return arena_empty(arena, n);
+
+    vector_t *v = malloc(sizeof(*v) + sizeof(double) * n);
+    if (v != NULL)
+        v->size = n;
 
+    return v;
+}
 
 vector_t *empty(size_t n)
 {
-    vector_t *v = malloc(sizeof(*v) + sizeof(double) * n);
+    vector_t *v = alloc_vector(n);
     if (v == NULL)
     {
         fprintf(stderr, "%s: Memory allocationd failed\n", __func__);
@@ -23,7 +41,7 @@ vector_t *empty_like(const vector_t *u)
     if (u == NULL)
         return NULL;
 
-    vector_t *v = malloc(sizeof(*v) + sizeof(double) * u->size);
+    vector_t *v = alloc_vector(u->size);
 
     if (v == NULL)
     {
@@ -41,7 +59,7 @@ vector_t *zeros_like(const vector_t *u)
     if (u == NULL)
         return NULL;
 
-    vector_t *v = malloc(sizeof(*v) + sizeof(double) * u->size);
+    vector_t *v = alloc_vector(u->size);
 
     if (v == NULL)
     {
@@ -50,18 +68,14 @@ vector_t *zeros_like(const vector_t *u)
     }
 
     v->size = u->size;
-
-    for (size_t i = 0; i < v->size; ++i)
-    {
-        v->arr[i] = 0;
-    }
+    memset(v->arr, 0, sizeof(double) * v->size);
 
     return v;
 }
 
 vector_t *zeros(size_t n)
 {
-    vector_t *v = malloc(sizeof(*v) + sizeof(double) * n);
+    vector_t *v = alloc_vector(n);
 
     if (v == NULL)
     {
@@ -70,38 +84,56 @@ vector_t *zeros(size_t n)
     }
 
     v->size = n;
-
-    for (size_t i = 0; i < v->size; ++i)
-    {
-        v->arr[i] = 0;
-    }
+    memset(v->arr, 0, sizeof(double) * v->size);
 
     return v;
 }
 
 vector_t *linspace(double start, double end, size_t n)
 {
-    double step = (end - start) / (n - 1.0);
-    assert(step != 0);
+    // Checked before allocating, linspace_into() would leave the vector to the caller
+    if (n == 0)
+    {
+        fprintf(stderr, "%s: Empty vector\n", __func__);
+        return NULL;
+    }
 
-    vector_t *v = malloc(sizeof(*v) + sizeof(double) * n);
+    vector_t *v = alloc_vector(n);
     if (v == NULL)
     {
         return NULL;
     }
 
-    v->arr[0] = start;
-    v->size = n;
+    return linspace_into(v, start, end);
+}
 
-    for (size_t i = 1; i < n; ++i)
+vector_t *linspace_into(vector_t *out, double start, double end)
+{
+    if (out == NULL || out->size == 0)
     {
-        v->arr[i] = v->arr[i - 1] + step;
+        fprintf(stderr, "%s: Null or empty vector\n", __func__);
+        return NULL;
     }
 
-    return v;
+    const size_t n = out->size;
+    double step = (end - start) / (n - 1.0);
+    assert(step != 0);
+
+    if (n == 1)
+    {
+        out->arr[0] = start;
+        return out;
+    }
+
+    // Closed form start + i * step, so the error does not grow along the vector
+    kernel_ramp(n, out->arr, start, step, 0);
+    out->arr[n - 1] = end;
+
+    return out;
 }
 
-vector_t *arange(double start, double end, double step)
+// Number of terms arange() produces
+static size_t arange_terms(double start, double end, double step)
 {
     assert(step != 0);
     step > 0 ? assert(end > start) : assert(start > end);
@@ -109,7 +141,12 @@ vector_t *arange(double start, double end, double step)
 
     assert(N_TERMS > 0); // Extra check
 
-    vector_t *v = malloc(sizeof(*v) + sizeof(double) * N_TERMS);
+    return N_TERMS;
+}
+
+vector_t *arange(double start, double end, double step)
+{
+    vector_t *v = alloc_vector(arange_terms(start, end, step));
 
     if (v == NULL)
     {
@@ -117,22 +154,42 @@ vector_t *arange(double start, double end, double step)
         exit(1);
     }
 
-    v->size = N_TERMS;
+    return arange_into(v, start, end, step);
+}
 
-    for (size_t i = 0; i < v->size; ++i)
+vector_t *arange_into(vector_t *out, double start, double end, double step)
+{
+    if (out == NULL)
     {
-        v->arr[i] = start + i * step;
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
     }
 
-    return v;
+    if (out->size != arange_terms(start, end, step))
+    {
+        fprintf(stderr, "%s: Output vector has the wrong size\n", __func__);
+        return NULL;
+    }
+
+    kernel_ramp(out->size, out->arr, start, step, 0);
+
+    return out;
+}
+
+// True when the data of a and b overlap without being the same array
+static bool partially_overlaps(const vector_t *a, const vector_t *b)
+{
+    const double *a_end = a->arr + a->size;
+    const double *b_end = b->arr + b->size;
+
+    return a->arr != b->arr && a->arr < b_end && b->arr < a_end;
 }
 
 vector_t *gradient(const vector_t *y, const vector_t *x)
 {
     assert(y->size == x->size && y->size > 2);
 
-    vector_t *v = malloc(sizeof(*v) + sizeof(double) * y->size);
-    const size_t n = y->size;
+    vector_t *v = alloc_vector(y->size);
 
     if (v == NULL)
     {
@@ -140,24 +197,81 @@ vector_t *gradient(const vector_t *y, const vector_t *x)
         exit(1);
     }
 
-    v->size = y->size;
+    return gradient_into(v, y, x);
+}
+
+#define GRADIENT_TILE 512
 
-    // Forward difference for first point
-    v->arr[0] = (y->arr[1] - y->arr[0]) / (x->arr[1] - x->arr[0]);
+/*
+In-place central differences. Each tile is computed into a buffer from
+the original values and written back one tile later, once the next tile
+no longer needs the values it overwrites.
+*/
+static void gradient_interior_in_place(size_t n, double out[], const double y[], const double x[])
+{
+    double tiles[2][GRADIENT_TILE + 2];
+    size_t pending_start = 0, pending_len = 0;
+    int t = 0;
 
-    // Central difference for the interior points
-    for (size_t i = 1; i < v->size - 1; ++i)
+    for (size_t start = 1; start + 1 < n; start += GRADIENT_TILE, t ^= 1)
+    {
+        size_t len = n - 1 - start < GRADIENT_TILE ? n - 1 - start : GRADIENT_TILE;
+
+        // Writes tiles[t][1..len] from y[start - 1 .. start + len]
+        kernel_gradient_interior(len + 2, tiles[t], y + start - 1, x + start - 1);
+
+        if (pending_len > 0)
+            memcpy(out + pending_start, tiles[t ^ 1] + 1, sizeof(double) * pending_len);
+
+        pending_start = start;
+        pending_len = len;
+    }
+
+    if (pending_len > 0)
+        memcpy(out + pending_start, tiles[t ^ 1] + 1, sizeof(double) * pending_len);
+}
+
+vector_t *gradient_into(vector_t *out, const vector_t *y, const vector_t *x)
+{
+    if (out == NULL || y == NULL || x == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    if (y->size != x->size || out->size != y->size || y->size < 3)
+    {
+        fprintf(stderr, "%s: Vectors must have the same size of at least 3\n", __func__);
+        return NULL;
+    }
+
+    if (partially_overlaps(out, y) || partially_overlaps(out, x))
     {
-        v->arr[i] = (y->arr[i + 1] - y->arr[i - 1]) / (x->arr[i + 1] - x->arr[i - 1]);
+        fprintf(stderr, "%s: Output partially overlaps an input\n", __func__);
+        return NULL;
     }
 
+    const size_t n = y->size;
+
+    // Forward difference for first point
+    double first = (y->arr[1] - y->arr[0]) / (x->arr[1] - x->arr[0]);
+
     // Backward difference for last point
-    v->arr[n - 1] = (y->arr[n - 1] - y->arr[n - 2]) / (x->arr[n - 1] - x->arr[n - 2]);
+    double last = (y->arr[n - 1] - y->arr[n - 2]) / (x->arr[n - 1] - x->arr[n - 2]);
 
-    return v;
+    // Central difference for the interior points
+    if (out == y || out == x)
+        gradient_interior_in_place(n, out->arr, y->arr, x->arr);
+    else
+        kernel_gradient_interior(n, out->arr, y->arr, x->arr);
+
+    out->arr[0] = first;
+    out->arr[n - 1] = last;
+
+    return out;
 }
 
-vector_t *from_array(double arr[static 1], size_t size)
+vector_t *from_array(double arr[], size_t size)
 {
     if (arr == NULL)
     {
@@ -165,7 +279,7 @@ vector_t *from_array(double arr[static 1], size_t size)
         return NULL;
     }
 
-    vector_t *v = malloc(sizeof(*v) + sizeof(double) * size);
+    vector_t *v = alloc_vector(size);
 
     if (v == NULL)
     {
@@ -173,14 +287,20 @@ vector_t *from_array(double arr[static 1], size_t size)
         exit(1);
     }
 
-    v->size = size;
+    return from_array_into(v, arr);
+}
 
-    for (size_t i = 0; i < v->size; ++i)
+vector_t *from_array_into(vector_t *out, const double arr[])
+{
+    if (out == NULL || arr == NULL)
     {
-        v->arr[i] = arr[i];
+        fprintf(stderr, "%s: Null vector or array\n", __func__);
+        return NULL;
     }
 
-    return v;
+    memmove(out->arr, arr, sizeof(double) * out->size);
+
+    return out;
 }
 
 void apply_function(vector_t *v, double (*function)(double))
@@ -205,7 +325,7 @@ vector_t *function_like(const vector_t *u, double (*function)(double))
         return NULL;
     }
 
-    vector_t *v = malloc(sizeof(*v) + sizeof(double) * u->size);
+    vector_t *v = alloc_vector(u->size);
 
     if (v == NULL)
     {
@@ -213,14 +333,29 @@ vector_t *function_like(const vector_t *u, double (*function)(double))
         exit(1);
     }
 
-    v->size = u->size;
+    return function_like_into(v, u, function);
+}
 
-    for (size_t i = 0; i < v->size; ++i)
+vector_t *function_like_into(vector_t *out, const vector_t *u, double (*function)(double))
+{
+    if (out == NULL || u == NULL)
     {
-        v->arr[i] = function(u->arr[i]);
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
     }
 
-    return v;
+    if (out->size != u->size || partially_overlaps(out, u))
+    {
+        fprintf(stderr, "%s: Output has a different size or partially overlaps the input\n", __func__);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < out->size; ++i)
+    {
+        out->arr[i] = function(u->arr[i]);
+    }
+
+    return out;
 }
 
 vector_t *get_copy(const vector_t *u)
@@ -231,7 +366,7 @@ vector_t *get_copy(const vector_t *u)
         return NULL;
     }
 
-    vector_t *v = malloc(sizeof(*v) + sizeof(double) * u->size);
+    vector_t *v = alloc_vector(u->size);
 
     if (v == NULL)
     {
@@ -239,14 +374,50 @@ vector_t *get_copy(const vector_t *u)
         exit(1);
     }
 
-    v->size = u->size;
+    return get_copy_into(v, u);
+}
 
-    for (size_t i = 0; i < v->size; ++i)
+vector_t *get_copy_into(vector_t *out, const vector_t *u)
+{
+    if (out == NULL || u == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    if (out->size != u->size)
     {
-        v->arr[i] = u->arr[i];
+        fprintf(stderr, "%s: Different size vectors\n", __func__);
+        return NULL;
     }
 
-    return v;
+    memmove(out->arr, u->arr, sizeof(double) * out->size);
+
+    return out;
+}
+
+// Checks the output and operands of an element-wise operation
+static bool check_elementwise(const vector_t *out, const vector_t *x, const vector_t *y, const char *caller)
+{
+    if (out == NULL || x == NULL || y == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", caller);
+        return false;
+    }
+
+    if (x->size != y->size || out->size != x->size)
+    {
+        fprintf(stderr, "%s: Different size vectors\n", caller);
+        return false;
+    }
+
+    if (partially_overlaps(out, x) || partially_overlaps(out, y))
+    {
+        fprintf(stderr, "%s: Output partially overlaps an input\n", caller);
+        return false;
+    }
+
+    return true;
 }
 
 vector_t *get_result(const vector_t *x, const vector_t *y, double (*function)(double, double))
@@ -263,7 +434,7 @@ vector_t *get_result(const vector_t *x, const vector_t *y, double (*function)(do
         return NULL;
     }
 
-    vector_t *v = malloc(sizeof(*v) + sizeof(double) * x->size);
+    vector_t *v = alloc_vector(x->size);
 
     if (v == NULL)
     {
@@ -271,14 +442,20 @@ vector_t *get_result(const vector_t *x, const vector_t *y, double (*function)(do
         exit(1);
     }
 
-    v->size = x->size;
+    return get_result_into(v, x, y, function);
+}
 
-    for (size_t i = 0; i < v->size; ++i)
+vector_t *get_result_into(vector_t *out, const vector_t *x, const vector_t *y, double (*function)(double, double))
+{
+    if (!check_elementwise(out, x, y, __func__))
+        return NULL;
+
+    for (size_t i = 0; i < out->size; ++i)
     {
-        v->arr[i] = function(x->arr[i], y->arr[i]);
+        out->arr[i] = function(x->arr[i], y->arr[i]);
     }
 
-    return v;
+    return out;
 }
 
 double *to_array(const vector_t *v)
@@ -335,24 +512,17 @@ double trapezoidal_rule(const vector_t *y, const vector_t *x)
     if (x->size != y->size)
     {
         fprintf(stderr, "%s: x and y must have same size\n", __func__);
+        return 0.0;
     }
 
-    double integral = 0.0;
-    for (size_t i = 0; i < x->size - 1; ++i)
-    {
-        double h = x->arr[i + 1] - x->arr[i];
-        double area = (y->arr[i] + y->arr[i + 1]) * h; // Twice the area of trapezoid
-        integral += area;
-    }
-
-    return integral / 2.0;
+    return trapz_array(sum_policy(), x->size, y->arr, x->arr);
 }
 
 double reduce(double(f)(double, double), const vector_t *v)
 {
-    if (v == NULL)
+    if (v == NULL || v->size == 0)
     {
-        fprintf(stderr, "%s: Null vector\n", __func__);
+        fprintf(stderr, "%s: Null or empty vector\n", __func__);
         return 0.0;
     }
 
@@ -364,8 +534,170 @@ double reduce(double(f)(double, double), const vector_t *v)
     return result;
 }
 
+// Checks the operands of an element-wise operation and allocates its result
+static vector_t *elementwise_result(const vector_t *x, const vector_t *y, const char *caller)
+{
+    if (x == NULL || y == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", caller);
+        return NULL;
+    }
+
+    if (x->size != y->size)
+    {
+        fprintf(stderr, "%s: Different size vectors\n", caller);
+        return NULL;
+    }
+
+    vector_t *v = alloc_vector(x->size);
+
+    if (v == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation falied\n", caller);
+        exit(1);
+    }
+
+    return v;
+}
+
+vector_t *add(const vector_t *x, const vector_t *y)
+{
+    vector_t *v = elementwise_result(x, y, __func__);
+    return v != NULL ? add_into(v, x, y) : NULL;
+}
+
+vector_t *add_into(vector_t *out, const vector_t *x, const vector_t *y)
+{
+    if (!check_elementwise(out, x, y, __func__))
+        return NULL;
+
+    kernel_add(out->size, out->arr, x->arr, y->arr);
+    return out;
+}
+
+vector_t *subtract(const vector_t *x, const vector_t *y)
+{
+    vector_t *v = elementwise_result(x, y, __func__);
+    return v != NULL ? subtract_into(v, x, y) : NULL;
+}
+
+vector_t *subtract_into(vector_t *out, const vector_t *x, const vector_t *y)
+{
+    if (!check_elementwise(out, x, y, __func__))
+        return NULL;
+
+    kernel_sub(out->size, out->arr, x->arr, y->arr);
+    return out;
+}
+
+vector_t *multiply(const vector_t *x, const vector_t *y)
+{
+    vector_t *v = elementwise_result(x, y, __func__);
+    return v != NULL ? multiply_into(v, x, y) : NULL;
+}
+
+vector_t *multiply_into(vector_t *out, const vector_t *x, const vector_t *y)
+{
+    if (!check_elementwise(out, x, y, __func__))
+        return NULL;
+
+    kernel_mul(out->size, out->arr, x->arr, y->arr);
+    return out;
+}
+
+vector_t *divide(const vector_t *x, const vector_t *y)
+{
+    vector_t *v = elementwise_result(x, y, __func__);
+    return v != NULL ? divide_into(v, x, y) : NULL;
+}
+
+vector_t *divide_into(vector_t *out, const vector_t *x, const vector_t *y)
+{
+    if (!check_elementwise(out, x, y, __func__))
+        return NULL;
+
+    kernel_div(out->size, out->arr, x->arr, y->arr);
+    return out;
+}
+
+vector_t *multiply_add(const vector_t *x, const vector_t *y, const vector_t *z)
+{
+    if (z == NULL || (x != NULL && x->size != z->size))
+    {
+        fprintf(stderr, "%s: Null or different size vectors\n", __func__);
+        return NULL;
+    }
+
+    vector_t *v = elementwise_result(x, y, __func__);
+    return v != NULL ? multiply_add_into(v, x, y, z) : NULL;
+}
+
+vector_t *multiply_add_into(vector_t *out, const vector_t *x, const vector_t *y, const vector_t *z)
+{
+    if (!check_elementwise(out, x, y, __func__) || !check_elementwise(out, z, z, __func__))
+        return NULL;
+
+    kernel_fma(out->size, out->arr, x->arr, y->arr, z->arr);
+    return out;
+}
+
+void scale(vector_t *v, double a)
+{
+    if (v == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return;
+    }
+
+    kernel_scale(v->size, v->arr, v->arr, a);
+}
+
+void axpy(double a, const vector_t *x, vector_t *y)
+{
+    if (x == NULL || y == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return;
+    }
+
+    if (x->size != y->size)
+    {
+        fprintf(stderr, "%s: Different size vectors\n", __func__);
+        return;
+    }
+
+    kernel_axpy(y->size, y->arr, a, x->arr);
+}
+
+double dot(const vector_t *x, const vector_t *y)
+{
+    if (x == NULL || y == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return 0.0;
+    }
+
+    if (x->size != y->size)
+    {
+        fprintf(stderr, "%s: Different size vectors\n", __func__);
+        return 0.0;
+    }
+
+    return dot_array(sum_policy(), x->size, x->arr, y->arr);
+}
+
+double sum(const vector_t *v)
+{
+    if (v == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return 0.0;
+    }
+
+    return sum_array(sum_policy(), v->size, v->arr);
+}
+
 void free_vector(vector_t *v)
 {
     free(v);
-    printf("Freed vector\n");
 }
\ No newline at end of file
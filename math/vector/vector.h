@@ -2,8 +2,14 @@
 
 #define VECTOR_H_
 
+#include <stddef.h>
+
 #define PI 3.141592653589793
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef struct vector_t
 {
     size_t size;
@@ -38,7 +44,7 @@ vector_t *get_copy(const vector_t *u);
 vector_t *get_result(const vector_t *x, const vector_t *y, double (*function)(double, double));
 
 // Get a vector from an array
-vector_t *from_array(double arr[static 1], size_t size);
+vector_t *from_array(double arr[], size_t size);
 
 // Returns the array version of vector
 double *to_array(const vector_t *v);
@@ -48,9 +54,70 @@ double trapezoidal_rule(const vector_t *y, const vector_t *x);
 
 double reduce(double(f)(double, double), const vector_t *v);
 
+// Element-wise x + y, x - y, x * y and x / y as new vectors
+vector_t *add(const vector_t *x, const vector_t *y);
+
+vector_t *subtract(const vector_t *x, const vector_t *y);
+
+vector_t *multiply(const vector_t *x, const vector_t *y);
+
+vector_t *divide(const vector_t *x, const vector_t *y);
+
+// Returns x * y + z with a single rounding per element
+vector_t *multiply_add(const vector_t *x, const vector_t *y, const vector_t *z);
+
+// Multiplies each element of v by a in place
+void scale(vector_t *v, double a);
+
+// Computes y = a * x + y in place
+void axpy(double a, const vector_t *x, vector_t *y);
+
+double dot(const vector_t *x, const vector_t *y);
+
+// Sum of the elements, in the kernels' eight lane order
+double sum(const vector_t *v);
+
+/*
+Output-parameter variants of the functions above. They write into out,
+whose size must already be the size of the result, and return out, or
+NULL after printing an error if the sizes do not match.
+
+out may be the same vector as any input, so out == y computes in place.
+An out whose data partially overlaps an input is rejected.
+*/
+vector_t *linspace_into(vector_t *out, double start, double end);
+
+vector_t *arange_into(vector_t *out, double start, double end, double step);
+
+vector_t *gradient_into(vector_t *out, const vector_t *y, const vector_t *x);
+
+vector_t *function_like_into(vector_t *out, const vector_t *u, double (*function)(double));
+
+vector_t *get_copy_into(vector_t *out, const vector_t *u);
+
+vector_t *get_result_into(vector_t *out, const vector_t *x, const vector_t *y, double (*function)(double, double));
+
+// Copies out->size elements of arr into out
+vector_t *from_array_into(vector_t *out, const double arr[]);
+
+vector_t *add_into(vector_t *out, const vector_t *x, const vector_t *y);
+
+vector_t *subtract_into(vector_t *out, const vector_t *x, const vector_t *y);
+
+vector_t *multiply_into(vector_t *out, const vector_t *x, const vector_t *y);
+
+vector_t *divide_into(vector_t *out, const vector_t *x, const vector_t *y);
+
+vector_t *multiply_add_into(vector_t *out, const vector_t *x, const vector_t *y, const vector_t *z);
+
+// Frees a malloc'd vector; arena vectors go back with arena_release()
 void free_vector(vector_t *v);
 
 // Returns the element at ith position
 double get_ve(const vector_t *v, int index);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
\ No newline at end of file
@@ -0,0 +1,451 @@
+#ifndef VECTOR_HPP_
+#define VECTOR_HPP_
+
+/*
+Header-only C++ wrapper over vector_t with expression templates.
+
+Arithmetic and math functions on vec::vector build a lightweight
+expression tree instead of computing anything. The tree is evaluated in
+a single loop when it is assigned to a vec::vector or passed to a
+reduction, so
+
+    vec::vector z = a * x + vec::sin(y);
+    double cost = vec::sum(vec::square(y - y_hat));
+
+each make one pass over memory and allocate at most one vector, however
+many operators they contain.
+
+Evaluation is element-wise, so assigning an expression to one of its own
+operands (x = 2.0 * x + y) is safe. Do not store expressions that refer
+to temporary vectors (auto e = f() + x); evaluate them in the same full
+expression.
+*/
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include "vector.h"
+#include "vector_arena.h"
+
+namespace vec {
+
+// Base of every expression node, E is the concrete node type
+template <class E>
+struct expr {
+    const E& self() const { return static_cast<const E&>(*this); }
+    size_t size() const { return self().size(); }
+    double operator[](size_t i) const { return self()[i]; }
+};
+
+// Evaluates e[0..n) into out in one pass
+template <class E>
+inline void evaluate(double* out, size_t n, const expr<E>& e) {
+    const E& node = e.self();
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = node[i];
+    }
+}
+
+namespace detail {
+
+// Switches the calling thread to malloc for the lifetime of the scope
+class heap_scope {
+public:
+    heap_scope() : previous_(arena_use(nullptr)) {}
+    ~heap_scope() { arena_use(previous_); }
+
+    heap_scope(const heap_scope&) = delete;
+    heap_scope& operator=(const heap_scope&) = delete;
+
+private:
+    vector_arena_t* previous_;
+};
+
+} // namespace detail
+
+/*
+Owning wrapper around a malloc'd vector_t. Its storage always comes from
+malloc, even inside an arena_use() scope, so the destructor can free it.
+*/
+class vector : public expr<vector> {
+public:
+    explicit vector(size_t n = 0) : v_(heap_empty(n)) {}
+
+    vector(const vector& other) : v_(heap_copy(other.v_)) {}
+
+    vector(vector&& other) noexcept : v_(other.v_) { other.v_ = nullptr; }
+
+    template <class E>
+    vector(const expr<E>& e) : v_(heap_empty(e.size())) {
+        evaluate(v_->arr, v_->size, e);
+    }
+
+    // Takes ownership of v, which must come from malloc and not from an arena
+    static vector adopt(vector_t* v) { return vector(v, adopt_tag()); }
+
+    ~vector() { free_vector(v_); }
+
+    vector& operator=(const vector& other) {
+        if (this != &other) {
+            vector copy(other);
+            std::swap(v_, copy.v_);
+        }
+        return *this;
+    }
+
+    vector& operator=(vector&& other) noexcept {
+        std::swap(v_, other.v_);
+        return *this;
+    }
+
+    // Reuses the current storage when the size matches, else e may still read the old storage
+    template <class E>
+    vector& operator=(const expr<E>& e) {
+        if (v_ == nullptr || v_->size != e.size()) {
+            vector fresh(e);
+            std::swap(v_, fresh.v_);
+        } else {
+            evaluate(v_->arr, v_->size, e);
+        }
+        return *this;
+    }
+
+    size_t size() const { return v_ == nullptr ? 0 : v_->size; }
+    double operator[](size_t i) const { return v_->arr[i]; }
+    double& operator[](size_t i) { return v_->arr[i]; }
+
+    double* data() { return v_->arr; }
+    const double* data() const { return v_->arr; }
+
+    vector_t* get() { return v_; }
+    const vector_t* get() const { return v_; }
+
+    // Gives up ownership of the underlying vector_t
+    vector_t* release() {
+        vector_t* v = v_;
+        v_ = nullptr;
+        return v;
+    }
+
+private:
+    struct adopt_tag {};
+
+    vector(vector_t* v, adopt_tag) : v_(v) {}
+
+    static vector_t* heap_empty(size_t n) {
+        detail::heap_scope heap;
+        return empty(n);
+    }
+
+    static vector_t* heap_copy(const vector_t* v) {
+        detail::heap_scope heap;
+        return get_copy(v);
+    }
+
+    vector_t* v_;
+};
+
+// Non-owning leaf over an existing vector_t
+class ref : public expr<ref> {
+public:
+    explicit ref(const vector_t* v) : v_(v) {}
+
+    size_t size() const { return v_->size; }
+    double operator[](size_t i) const { return v_->arr[i]; }
+
+private:
+    const vector_t* v_;
+};
+
+// A scalar broadcast to the size of the other operand
+class scalar : public expr<scalar> {
+public:
+    explicit scalar(double value) : value_(value) {}
+
+    size_t size() const { return 0; }
+    double operator[](size_t) const { return value_; }
+
+private:
+    double value_;
+};
+
+template <class E>
+struct is_scalar : std::false_type {};
+
+template <>
+struct is_scalar<scalar> : std::true_type {};
+
+namespace detail {
+
+// Size of a two operand node, every operand but a broadcast scalar must have it
+template <class L, class R>
+inline size_t common_size(const L& lhs, const R& rhs) {
+    assert(is_scalar<L>::value || is_scalar<R>::value || lhs.size() == rhs.size());
+    return is_scalar<L>::value ? rhs.size() : lhs.size();
+}
+
+// Owning vectors are held by reference, every other node by value
+template <class E>
+using stored = typename std::conditional<std::is_same<E, vector>::value, const vector&, const E>::type;
+
+template <class Op, class L, class R>
+class binary : public expr<binary<Op, L, R>> {
+public:
+    binary(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) { common_size(lhs, rhs); }
+
+    size_t size() const { return common_size(lhs_, rhs_); }
+    double operator[](size_t i) const { return Op::apply(lhs_[i], rhs_[i]); }
+
+private:
+    stored<L> lhs_;
+    stored<R> rhs_;
+};
+
+template <class Op, class E>
+class unary : public expr<unary<Op, E>> {
+public:
+    explicit unary(const E& operand) : operand_(operand) {}
+
+    size_t size() const { return operand_.size(); }
+    double operator[](size_t i) const { return Op::apply(operand_[i]); }
+
+private:
+    stored<E> operand_;
+};
+
+struct add_op { static double apply(double a, double b) { return a + b; } };
+struct sub_op { static double apply(double a, double b) { return a - b; } };
+struct mul_op { static double apply(double a, double b) { return a * b; } };
+struct div_op { static double apply(double a, double b) { return a / b; } };
+struct pow_op { static double apply(double a, double b) { return std::pow(a, b); } };
+struct min_op { static double apply(double a, double b) { return std::fmin(a, b); } };
+struct max_op { static double apply(double a, double b) { return std::fmax(a, b); } };
+
+struct neg_op { static double apply(double a) { return -a; } };
+struct square_op { static double apply(double a) { return a * a; } };
+
+#define VEC_UNARY_OP(NAME) \
+    struct NAME##_op { static double apply(double a) { return std::NAME(a); } };
+
+VEC_UNARY_OP(sin)
+VEC_UNARY_OP(cos)
+VEC_UNARY_OP(tan)
+VEC_UNARY_OP(exp)
+VEC_UNARY_OP(log)
+VEC_UNARY_OP(sqrt)
+VEC_UNARY_OP(fabs)
+VEC_UNARY_OP(tanh)
+
+#undef VEC_UNARY_OP
+
+} // namespace detail
+
+#define VEC_BINARY_OPERATOR(OP, NAME)                                                      \
+    template <class L, class R>                                                            \
+    detail::binary<detail::NAME, L, R> operator OP(const expr<L>& lhs, const expr<R>& rhs) \
+    {                                                                                      \
+        return detail::binary<detail::NAME, L, R>(lhs.self(), rhs.self());                 \
+    }                                                                                      \
+    template <class L>                                                                     \
+    detail::binary<detail::NAME, L, scalar> operator OP(const expr<L>& lhs, double rhs)    \
+    {                                                                                      \
+        return detail::binary<detail::NAME, L, scalar>(lhs.self(), scalar(rhs));           \
+    }                                                                                      \
+    template <class R>                                                                     \
+    detail::binary<detail::NAME, scalar, R> operator OP(double lhs, const expr<R>& rhs)    \
+    {                                                                                      \
+        return detail::binary<detail::NAME, scalar, R>(scalar(lhs), rhs.self());           \
+    }
+
+VEC_BINARY_OPERATOR(+, add_op)
+VEC_BINARY_OPERATOR(-, sub_op)
+VEC_BINARY_OPERATOR(*, mul_op)
+VEC_BINARY_OPERATOR(/, div_op)
+
+#undef VEC_BINARY_OPERATOR
+
+#define VEC_BINARY_FUNCTION(NAME)                                                        \
+    template <class L, class R>                                                          \
+    detail::binary<detail::NAME##_op, L, R> NAME(const expr<L>& lhs, const expr<R>& rhs) \
+    {                                                                                    \
+        return detail::binary<detail::NAME##_op, L, R>(lhs.self(), rhs.self());          \
+    }                                                                                    \
+    template <class L>                                                                   \
+    detail::binary<detail::NAME##_op, L, scalar> NAME(const expr<L>& lhs, double rhs)    \
+    {                                                                                    \
+        return detail::binary<detail::NAME##_op, L, scalar>(lhs.self(), scalar(rhs));    \
+    }
+
+VEC_BINARY_FUNCTION(pow)
+VEC_BINARY_FUNCTION(min)
+VEC_BINARY_FUNCTION(max)
+
+#undef VEC_BINARY_FUNCTION
+
+#define VEC_UNARY_FUNCTION(NAME, OP)                                \
+    template <class E>                                              \
+    detail::unary<detail::OP, E> NAME(const expr<E>& e)             \
+    {                                                               \
+        return detail::unary<detail::OP, E>(e.self());              \
+    }
+
+VEC_UNARY_FUNCTION(operator-, neg_op)
+VEC_UNARY_FUNCTION(square, square_op)
+VEC_UNARY_FUNCTION(sin, sin_op)
+VEC_UNARY_FUNCTION(cos, cos_op)
+VEC_UNARY_FUNCTION(tan, tan_op)
+VEC_UNARY_FUNCTION(exp, exp_op)
+VEC_UNARY_FUNCTION(log, log_op)
+VEC_UNARY_FUNCTION(sqrt, sqrt_op)
+VEC_UNARY_FUNCTION(abs, fabs_op)
+VEC_UNARY_FUNCTION(tanh, tanh_op)
+
+#undef VEC_UNARY_FUNCTION
+
+namespace detail {
+
+template <class F, class E>
+class mapped : public expr<mapped<F, E>> {
+public:
+    mapped(const E& operand, F f) : operand_(operand), f_(f) {}
+
+    size_t size() const { return operand_.size(); }
+    double operator[](size_t i) const { return f_(operand_[i]); }
+
+private:
+    stored<E> operand_;
+    F f_;
+};
+
+template <class F, class L, class R>
+class zipped : public expr<zipped<F, L, R>> {
+public:
+    zipped(const L& lhs, const R& rhs, F f) : lhs_(lhs), rhs_(rhs), f_(f) { common_size(lhs, rhs); }
+
+    size_t size() const { return common_size(lhs_, rhs_); }
+    double operator[](size_t i) const { return f_(lhs_[i], rhs_[i]); }
+
+private:
+    stored<L> lhs_;
+    stored<R> rhs_;
+    F f_;
+};
+
+} // namespace detail
+
+/*
+Functor and lambda counterparts of function_like(), get_result(),
+apply_function() and reduce(). The callable is a template parameter, so
+it is inlined into the loop instead of being called through a pointer.
+map() and zip() are expression nodes and fuse with everything else.
+*/
+template <class F, class E>
+detail::mapped<F, E> map(const expr<E>& e, F f) {
+    return detail::mapped<F, E>(e.self(), f);
+}
+
+template <class F, class L, class R>
+detail::zipped<F, L, R> zip(const expr<L>& lhs, const expr<R>& rhs, F f) {
+    return detail::zipped<F, L, R>(lhs.self(), rhs.self(), f);
+}
+
+template <class F>
+void apply(vector_t* v, F f) {
+    for (size_t i = 0; i < v->size; ++i) {
+        v->arr[i] = f(v->arr[i]);
+    }
+}
+
+template <class F>
+void apply(vector& v, F f) {
+    apply(v.get(), f);
+}
+
+// combine must be associative with identity as its identity element
+template <class E, class F>
+double reduce(const expr<E>& e, double identity, F combine) {
+    const E& node = e.self();
+    const size_t n = node.size();
+    double lanes[8] = {identity, identity, identity, identity, identity, identity, identity, identity};
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (size_t k = 0; k < 8; ++k) {
+            lanes[k] = combine(lanes[k], node[i + k]);
+        }
+    }
+    for (size_t k = 0; i < n; ++i, ++k) {
+        lanes[k] = combine(lanes[k], node[i]);
+    }
+
+    double s0 = combine(lanes[0], lanes[4]);
+    double s1 = combine(lanes[1], lanes[5]);
+    double s2 = combine(lanes[2], lanes[6]);
+    double s3 = combine(lanes[3], lanes[7]);
+    return combine(combine(s0, s2), combine(s1, s3));
+}
+
+/*
+Fused reductions. The sum uses the same eight-lane accumulation order as
+the C kernels, so sum(x) matches kernel_sum() bit for bit and the
+independent lanes leave the compiler free to vectorise the loop.
+*/
+template <class E>
+double sum(const expr<E>& e) {
+    const E& node = e.self();
+    const size_t n = node.size();
+    double lanes[8] = {};
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (size_t k = 0; k < 8; ++k) {
+            lanes[k] += node[i + k];
+        }
+    }
+    for (size_t k = 0; i < n; ++i, ++k) {
+        lanes[k] += node[i];
+    }
+
+    double s0 = lanes[0] + lanes[4];
+    double s1 = lanes[1] + lanes[5];
+    double s2 = lanes[2] + lanes[6];
+    double s3 = lanes[3] + lanes[7];
+    return (s0 + s2) + (s1 + s3);
+}
+
+template <class E>
+double mean(const expr<E>& e) {
+    assert(e.size() != 0);
+    return sum(e) / static_cast<double>(e.size());
+}
+
+template <class L, class R>
+double dot(const expr<L>& lhs, const expr<R>& rhs) {
+    return sum(lhs * rhs);
+}
+
+template <class E>
+double min_element(const expr<E>& e) {
+    const E& node = e.self();
+    double result = INFINITY;
+    for (size_t i = 0; i < node.size(); ++i) {
+        result = std::fmin(result, node[i]);
+    }
+    return result;
+}
+
+template <class E>
+double max_element(const expr<E>& e) {
+    const E& node = e.self();
+    double result = -INFINITY;
+    for (size_t i = 0; i < node.size(); ++i) {
+        result = std::fmax(result, node[i]);
+    }
+    return result;
+}
+
+} // namespace vec
+
+#endif
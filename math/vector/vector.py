@@ -1,9 +1,28 @@
 import ctypes
+import os
+import sys
+
+# Every call into libvector.so goes through ctypes.CDLL, which releases the
+# GIL for the duration of the call. The whole-vector operators and methods
+# of Vector make a single such call, so Python threads running them
+# overlap instead of taking turns on the interpreter.
+
+# Element type in the __array_interface__ notation
+_TYPESTR = ("<" if sys.byteorder == "little" else ">") + "f8"
+_DOUBLE = ctypes.sizeof(ctypes.c_double)
 
 
 class Vector_c(ctypes.Structure):
+    # double arr[] is a flexible array member: the elements follow size
+    # directly, so the field has no length and is reached by its offset
     _fields_ = [("size", ctypes.c_size_t),
-                ("arr", ctypes.POINTER(ctypes.c_double))]
+                ("arr", ctypes.c_double * 0)]
+
+
+class View_c(ctypes.Structure):
+    _fields_ = [("data", ctypes.POINTER(ctypes.c_double)),
+                ("size", ctypes.c_size_t),
+                ("stride", ctypes.c_ssize_t)]
 
 
 class Vector:
@@ -15,27 +34,319 @@ class Vector:
         return ""
 
     def __iter__(self):
-        return (lib.get_ve(self.arr, i) for i in range(self.size))
+        return iter(self.buffer())
+
+    def __len__(self):
+        return self.size
 
     @property
     def size(self):
-        try:
-            return self.arr.contents.size
-        except AttributeError:
+        if not self.arr:
+            return 0
+        return self.arr.contents.size
+
+    def address(self):
+        """Address of the first element"""
+        if not self.arr:
             return 0
+        return ctypes.addressof(self.arr.contents) + Vector_c.arr.offset
+
+    def buffer(self):
+        """ctypes array sharing the vector's memory, keeps the vector alive"""
+        buf = (ctypes.c_double * self.size).from_address(self.address())
+        buf._owner = self
+        return buf
+
+    # Buffer protocol, memoryview(v) on Python 3.12+. ctypes reports the
+    # format as "<d", which memoryview cannot index, hence the casts.
+    def __buffer__(self, flags):
+        return memoryview(self.buffer()).cast("B").cast("d")
+
+    # numpy.asarray(v) shares memory with v and holds a reference to it
+    @property
+    def __array_interface__(self):
+        return {"shape": (self.size,),
+                "typestr": _TYPESTR,
+                "data": (self.address(), False),
+                "version": 3}
+
+    def view(self):
+        """View of the whole vector"""
+        return View(View_c(ctypes.cast(self.address(), ctypes.POINTER(ctypes.c_double)), self.size, 1), self)
 
     def __getitem__(self, index):
         index = index if index >= 0 else self.size + index
-        if index >= self.size:
+        if index < 0 or index >= self.size:
             raise IndexError(f"Index {index} out of range")
-        return lib.get_ve(self.arr, index)
+        return ctypes.c_double.from_address(self.address() + index * _DOUBLE).value
+
+    def _operand(self, other):
+        if not isinstance(other, Vector):
+            return False
+        if other.size != self.size:
+            raise ValueError(f"Different size vectors: {self.size} and {other.size}")
+        return True
+
+    def _binary(self, function, other):
+        if not self._operand(other):
+            return NotImplemented
+        return Vector(function(self.arr, other.arr))
+
+    def _inplace(self, function, other):
+        if not self._operand(other):
+            return NotImplemented
+        function(self.arr, self.arr, other.arr)
+        return self
+
+    def __add__(self, other):
+        return self._binary(lib.add, other)
+
+    def __sub__(self, other):
+        return self._binary(lib.subtract, other)
+
+    def __mul__(self, other):
+        return self._binary(lib.multiply, other)
+
+    def __truediv__(self, other):
+        return self._binary(lib.divide, other)
+
+    def __matmul__(self, other):
+        if not self._operand(other):
+            return NotImplemented
+        return lib.dot(self.arr, other.arr)
+
+    def __iadd__(self, other):
+        return self._inplace(lib.add_into, other)
+
+    def __isub__(self, other):
+        return self._inplace(lib.subtract_into, other)
+
+    def __imul__(self, other):
+        if isinstance(other, (int, float)):
+            lib.scale(self.arr, other)
+            return self
+        return self._inplace(lib.multiply_into, other)
+
+    def __itruediv__(self, other):
+        if isinstance(other, (int, float)):
+            lib.scale(self.arr, 1.0 / other)
+            return self
+        return self._inplace(lib.divide_into, other)
+
+    def gradient(self, x):
+        """Derivative of this vector with respect to x"""
+        if isinstance(x, View):
+            return self.view().gradient(x)
+        self._operand(x)
+        if len(self) < 3:
+            raise ValueError("gradient needs at least 3 elements")
+        return Vector(lib.gradient(self.arr, x.arr))
+
+    def trapz(self, x):
+        """Integral of this vector over x by the trapezoidal rule"""
+        if isinstance(x, View):
+            return self.view().trapz(x)
+        self._operand(x)
+        return lib.trapezoidal_rule(self.arr, x.arr)
+
+    def sum(self):
+        return lib.sum(self.arr)
+
+    # The methods below take a Python callable or a C function such as
+    # ctypes.CDLL(ctypes.util.find_library("m")).sin. A Python callable
+    # takes the GIL back for every element, a C function never does.
+    def map(self, function):
+        """New vector of function applied to each element"""
+        return Vector(lib.function_like(self.arr, _callback(UNARY, function)))
+
+    def apply(self, function):
+        """Applies function to each element in place"""
+        lib.apply_function(self.arr, _callback(UNARY, function))
+        return self
+
+    def zip(self, other, function):
+        """New vector of function(self[i], other[i])"""
+        self._operand(other)
+        return Vector(lib.get_result(self.arr, other.arr, _callback(BINARY, function)))
+
+    def reduce(self, function):
+        """Left fold of the elements with function"""
+        return lib.reduce(_callback(BINARY, function), self.arr)
 
     def __del__(self):
-        if self.arr is not None:
+        if self.arr:
             lib.free_vector(self.arr)
 
 
-lib = ctypes.CDLL("./vector.so")
+UNARY = ctypes.CFUNCTYPE(ctypes.c_double, ctypes.c_double)
+BINARY = ctypes.CFUNCTYPE(ctypes.c_double, ctypes.c_double, ctypes.c_double)
+
+
+def _callback(kind, function):
+    # Functions exported by a shared library are passed straight through
+    if isinstance(function, ctypes._CFuncPtr):
+        return ctypes.cast(function, kind)
+    return kind(function)
+
+
+class View:
+    """
+    Non-owning vector_view_t over memory owned by another object, which
+    the view keeps alive. Made by from_numpy() or Vector.view().
+    """
+
+    def __init__(self, view: View_c, owner):
+        self.view: View_c = view
+        self.owner = owner
+
+    def __len__(self):
+        return self.size
+
+    @property
+    def size(self):
+        return self.view.size
+
+    def address(self):
+        return ctypes.cast(self.view.data, ctypes.c_void_p).value or 0
+
+    def __iter__(self):
+        return (self[i] for i in range(self.size))
+
+    def __getitem__(self, index):
+        index = index if index >= 0 else self.size + index
+        if index < 0 or index >= self.size:
+            raise IndexError(f"Index {index} out of range")
+        return ctypes.c_double.from_address(self.address() + index * self.view.stride * _DOUBLE).value
+
+    @property
+    def __array_interface__(self):
+        return {"shape": (self.size,),
+                "typestr": _TYPESTR,
+                "data": (self.address(), True),
+                "strides": (self.view.stride * _DOUBLE,),
+                "version": 3}
+
+    def to_vector(self):
+        """Copies the viewed elements into a new Vector"""
+        return Vector(lib.view_to_vector(self.view))
+
+    # The methods below read the viewed memory directly through the view_
+    # functions of vector_view.h, none of them copies it into a Vector first.
+    # The other operand may be a View or a Vector.
+    def _operand(self, other):
+        if isinstance(other, Vector):
+            other = other.view()
+        if not isinstance(other, View):
+            return None
+        if other.size != self.size:
+            raise ValueError(f"Different size vectors: {self.size} and {other.size}")
+        return other.view
+
+    def _binary(self, function, other):
+        view = self._operand(other)
+        if view is None:
+            return NotImplemented
+        return Vector(function(self.view, view))
+
+    def _reflected(self, function, other):
+        view = self._operand(other)
+        if view is None:
+            return NotImplemented
+        return Vector(function(view, self.view))
+
+    def __add__(self, other):
+        return self._binary(lib.view_add, other)
+
+    def __radd__(self, other):
+        return self._reflected(lib.view_add, other)
+
+    def __sub__(self, other):
+        return self._binary(lib.view_subtract, other)
+
+    def __rsub__(self, other):
+        return self._reflected(lib.view_subtract, other)
+
+    def __mul__(self, other):
+        return self._binary(lib.view_multiply, other)
+
+    def __rmul__(self, other):
+        return self._reflected(lib.view_multiply, other)
+
+    def __truediv__(self, other):
+        return self._binary(lib.view_divide, other)
+
+    def __rtruediv__(self, other):
+        return self._reflected(lib.view_divide, other)
+
+    def __matmul__(self, other):
+        view = self._operand(other)
+        if view is None:
+            return NotImplemented
+        return lib.view_dot(self.view, view)
+
+    __rmatmul__ = __matmul__
+
+    def dot(self, other):
+        return self @ other
+
+    def gradient(self, x):
+        """Derivative of the viewed elements with respect to x"""
+        view = self._operand(x)
+        if view is None:
+            raise TypeError("Expected a View or a Vector")
+        if len(self) < 3:
+            raise ValueError("gradient needs at least 3 elements")
+        return Vector(lib.view_gradient(self.view, view))
+
+    def trapz(self, x):
+        """Integral of the viewed elements over x by the trapezoidal rule"""
+        view = self._operand(x)
+        if view is None:
+            raise TypeError("Expected a View or a Vector")
+        return lib.view_trapezoidal_rule(self.view, view)
+
+    def sum(self):
+        return lib.view_sum(self.view)
+
+    def map(self, function):
+        """New vector of function applied to each element"""
+        return Vector(lib.view_function_like(self.view, _callback(UNARY, function)))
+
+    def zip(self, other, function):
+        """New vector of function(self[i], other[i])"""
+        view = self._operand(other)
+        if view is None:
+            raise TypeError("Expected a View or a Vector")
+        return Vector(lib.view_get_result(self.view, view, _callback(BINARY, function)))
+
+    def reduce(self, function):
+        """Left fold of the elements with function"""
+        if self.size == 0:
+            raise ValueError("reduce of an empty view")
+        return lib.view_reduce(_callback(BINARY, function), self.view)
+
+
+def from_numpy(a):
+    """
+    Wraps a one dimensional float64 array as a View without copying. Any
+    object with an __array_interface__ works, NumPy is not required.
+    """
+    info = a.__array_interface__
+    strides = info.get("strides")
+    if len(info["shape"]) != 1 or info["typestr"] != _TYPESTR:
+        raise TypeError("Expected a one dimensional float64 array")
+    if not isinstance(info["data"], tuple):
+        raise TypeError("Expected an array with a data pointer")
+    if strides is not None and strides[0] % _DOUBLE != 0:
+        raise TypeError("Array stride is not a multiple of the element size")
+
+    stride = 1 if strides is None else strides[0] // _DOUBLE
+    data = ctypes.cast(info["data"][0], ctypes.POINTER(ctypes.c_double))
+    return View(View_c(data, info["shape"][0], stride), a)
+
+
+# Not vector.so, which import vector would pick up as an extension module
+lib = ctypes.CDLL(os.path.join(os.path.dirname(os.path.abspath(__file__)), "libvector.so"))
 
 lib.empty_like.argtypes = [ctypes.POINTER(Vector_c)]
 lib.empty_like.restype = ctypes.POINTER(Vector_c)
@@ -88,14 +399,90 @@ def linspace(start, end, n):
 lib.gradient.argtypes = [ctypes.POINTER(Vector_c), ctypes.POINTER(Vector_c)]
 lib.gradient.restype = ctypes.POINTER(Vector_c)
 
+
+def gradient(y, x):
+    """y and x may each be a Vector or a View"""
+    return y.gradient(x)
+
+
+lib.trapezoidal_rule.argtypes = [ctypes.POINTER(Vector_c), ctypes.POINTER(Vector_c)]
+lib.trapezoidal_rule.restype = ctypes.c_double
+
+
+def trapezoidal_rule(y, x):
+    """y and x may each be a Vector or a View"""
+    return y.trapz(x)
+
+
+def dot(x, y):
+    """x and y may each be a Vector or a View"""
+    return x @ y
+
+
+lib.apply_function.argtypes = [ctypes.POINTER(Vector_c), UNARY]
+
+lib.function_like.argtypes = [ctypes.POINTER(Vector_c), UNARY]
+lib.function_like.restype = ctypes.POINTER(Vector_c)
+
+lib.get_result.argtypes = [ctypes.POINTER(Vector_c), ctypes.POINTER(Vector_c), BINARY]
+lib.get_result.restype = ctypes.POINTER(Vector_c)
+
+lib.reduce.argtypes = [BINARY, ctypes.POINTER(Vector_c)]
+lib.reduce.restype = ctypes.c_double
+
+lib.sum.argtypes = [ctypes.POINTER(Vector_c)]
+lib.sum.restype = ctypes.c_double
+
+lib.dot.argtypes = [ctypes.POINTER(Vector_c), ctypes.POINTER(Vector_c)]
+lib.dot.restype = ctypes.c_double
+
+lib.scale.argtypes = [ctypes.POINTER(Vector_c), ctypes.c_double]
+
+for _name in ("add", "subtract", "multiply", "divide"):
+    getattr(lib, _name).argtypes = [ctypes.POINTER(Vector_c), ctypes.POINTER(Vector_c)]
+    getattr(lib, _name).restype = ctypes.POINTER(Vector_c)
+    getattr(lib, _name + "_into").argtypes = [ctypes.POINTER(Vector_c)] * 3
+    getattr(lib, _name + "_into").restype = ctypes.POINTER(Vector_c)
+
 lib.print_vector.argtypes = [ctypes.POINTER(Vector_c)]
 
 
 lib.get_ve.argtypes = [ctypes.POINTER(Vector_c), ctypes.c_int]
 lib.get_ve.restype = ctypes.c_double
 
+lib.free_vector.argtypes = [ctypes.POINTER(Vector_c)]
+
+lib.view_to_vector.argtypes = [View_c]
+lib.view_to_vector.restype = ctypes.POINTER(Vector_c)
+
+lib.view_gradient.argtypes = [View_c, View_c]
+lib.view_gradient.restype = ctypes.POINTER(Vector_c)
+
+lib.view_trapezoidal_rule.argtypes = [View_c, View_c]
+lib.view_trapezoidal_rule.restype = ctypes.c_double
+
+lib.view_dot.argtypes = [View_c, View_c]
+lib.view_dot.restype = ctypes.c_double
+
+lib.view_sum.argtypes = [View_c]
+lib.view_sum.restype = ctypes.c_double
+
+lib.view_reduce.argtypes = [BINARY, View_c]
+lib.view_reduce.restype = ctypes.c_double
+
+lib.view_function_like.argtypes = [View_c, UNARY]
+lib.view_function_like.restype = ctypes.POINTER(Vector_c)
+
+lib.view_get_result.argtypes = [View_c, View_c, BINARY]
+lib.view_get_result.restype = ctypes.POINTER(Vector_c)
+
+for _name in ("view_add", "view_subtract", "view_multiply", "view_divide"):
+    getattr(lib, _name).argtypes = [View_c, View_c]
+    getattr(lib, _name).restype = ctypes.POINTER(Vector_c)
+
 
-v = linspace(1, 4, 19)
-for x in v:
-    print(x)
-print(v[1])
+if __name__ == "__main__":
+    v = linspace(1, 4, 19)
+    for x in v:
+        print(x)
+    print(v[1])
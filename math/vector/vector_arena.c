@@ -0,0 +1,409 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "vector.h"
+#include "vector_arena.h"
+
+#define ARENA_ALIGN 64
+#define ARENA_DEFAULT_CHUNK ((size_t)1 << 22)
+#define ARENA_N_CLASSES 64
+
+/*
+Every block starts on an ARENA_ALIGN boundary and is laid out as
+
+    [block_t ... | size_t size | double arr[] ...]
+    ^ block       ^ vector_t    ^ block + ARENA_ALIGN
+
+so the vector data is aligned and the bookkeeping lives in the padding
+in front of the vector_t.
+*/
+typedef struct block_t
+{
+    struct block_t *next_free;
+    size_t lines;  // Block length in ARENA_ALIGN units
+    size_t chunk;  // Index of the owning chunk
+    size_t offset; // Offset of the block inside its chunk
+} block_t;
+
+typedef struct chunk_t
+{
+    struct chunk_t *next;
+    size_t index;
+    size_t capacity;
+    size_t used;
+    unsigned char *data;
+} chunk_t;
+
+struct vector_arena_t
+{
+    size_t chunk_bytes;
+    chunk_t *first;
+    chunk_t *current;
+    block_t *free_lists[ARENA_N_CLASSES];
+};
+
+_Static_assert(sizeof(block_t) + offsetof(vector_t, arr) <= ARENA_ALIGN,
+               "block header must fit in front of the vector data");
+
+static _Thread_local vector_arena_t *active_arena = NULL;
+
+static vector_t *block_vector(block_t *b)
+{
+    return (vector_t *)((unsigned char *)b + ARENA_ALIGN - offsetof(vector_t, arr));
+}
+
+static block_t *vector_block(vector_t *v)
+{
+    return (block_t *)((unsigned char *)v + offsetof(vector_t, arr) - ARENA_ALIGN);
+}
+
+static size_t size_class(size_t lines)
+{
+    size_t k = 0;
+    while (lines >>= 1)
+        ++k;
+    return k;
+}
+
+static chunk_t *new_chunk(size_t capacity)
+{
+    chunk_t *c = malloc(sizeof(*c));
+    if (c == NULL)
+        return NULL;
+
+    c->data = aligned_alloc(ARENA_ALIGN, capacity);
+    if (c->data == NULL)
+    {
+        free(c);
+        return NULL;
+    }
+
+    c->next = NULL;
+    c->index = 0;
+    c->capacity = capacity;
+    c->used = 0;
+    return c;
+}
+
+vector_arena_t *arena_create(size_t chunk_bytes)
+{
+    vector_arena_t *arena = malloc(sizeof(*arena));
+    if (arena == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        return NULL;
+    }
+
+    if (chunk_bytes == 0)
+        chunk_bytes = ARENA_DEFAULT_CHUNK;
+    chunk_bytes = (chunk_bytes + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+
+    arena->chunk_bytes = chunk_bytes;
+    arena->first = new_chunk(chunk_bytes);
+    arena->current = arena->first;
+    memset(arena->free_lists, 0, sizeof(arena->free_lists));
+
+    if (arena->first == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        free(arena);
+        return NULL;
+    }
+
+    return arena;
+}
+
+void arena_destroy(vector_arena_t *arena)
+{
+    if (arena == NULL)
+        return;
+
+    if (active_arena == arena)
+        active_arena = NULL;
+
+    for (chunk_t *c = arena->first; c != NULL;)
+    {
+        chunk_t *next = c->next;
+        free(c->data);
+        free(c);
+        c = next;
+    }
+    free(arena);
+}
+
+arena_mark_t arena_mark(const vector_arena_t *arena)
+{
+    return (arena_mark_t){.chunk = arena->current->index, .used = arena->current->used};
+}
+
+static int block_before_mark(const block_t *b, arena_mark_t mark)
+{
+    return b->chunk < mark.chunk || (b->chunk == mark.chunk && b->offset < mark.used);
+}
+
+void arena_rewind(vector_arena_t *arena, arena_mark_t mark)
+{
+    chunk_t *c = arena->first;
+    while (c->index != mark.chunk)
+        c = c->next;
+
+    // Chunks after the mark stay allocated and are reused as spares
+    arena->current = c;
+    c->used = mark.used;
+
+    // Drop free blocks that now lie in unallocated space
+    for (size_t k = 0; k < ARENA_N_CLASSES; ++k)
+    {
+        block_t **link = &arena->free_lists[k];
+        while (*link != NULL)
+        {
+            if (block_before_mark(*link, mark))
+                link = &(*link)->next_free;
+            else
+                *link = (*link)->next_free;
+        }
+    }
+}
+
+void arena_reset(vector_arena_t *arena)
+{
+    arena_rewind(arena, (arena_mark_t){.chunk = 0, .used = 0});
+}
+
+// Finds a free block of at least lines lines
+static block_t *take_free_block(vector_arena_t *arena, size_t lines)
+{
+    size_t k = size_class(lines);
+
+    // Blocks in the exact class may still be too short, so search it first-fit
+    for (block_t **link = &arena->free_lists[k]; *link != NULL; link = &(*link)->next_free)
+    {
+        if ((*link)->lines >= lines)
+        {
+            block_t *b = *link;
+            *link = b->next_free;
+            return b;
+        }
+    }
+
+    // Any block in a larger class is long enough
+    for (++k; k < ARENA_N_CLASSES; ++k)
+    {
+        block_t *b = arena->free_lists[k];
+        if (b != NULL)
+        {
+            arena->free_lists[k] = b->next_free;
+            return b;
+        }
+    }
+    return NULL;
+}
+
+// Makes the current chunk one with at least bytes of room
+static int ensure_room(vector_arena_t *arena, size_t bytes)
+{
+    chunk_t *c = arena->current;
+    if (c->capacity - c->used >= bytes)
+        return 1;
+
+    chunk_t *spare = c->next;
+    if (spare == NULL || spare->capacity < bytes)
+    {
+        spare = new_chunk(bytes > arena->chunk_bytes ? bytes : arena->chunk_bytes);
+        if (spare == NULL)
+            return 0;
+        spare->next = c->next;
+        c->next = spare;
+    }
+
+    spare->index = c->index + 1;
+    spare->used = 0;
+    arena->current = spare;
+    return 1;
+}
+
+vector_t *arena_empty(vector_arena_t *arena, size_t n)
+{
+    if (arena == NULL)
+    {
+        fprintf(stderr, "%s: Null arena\n", __func__);
+        return NULL;
+    }
+
+    const size_t lines = 1 + (n * sizeof(double) + ARENA_ALIGN - 1) / ARENA_ALIGN;
+    block_t *b = take_free_block(arena, lines);
+
+    if (b == NULL)
+    {
+        if (!ensure_room(arena, lines * ARENA_ALIGN))
+        {
+            fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+            return NULL;
+        }
+
+        chunk_t *c = arena->current;
+        b = (block_t *)(c->data + c->used);
+        b->lines = lines;
+        b->chunk = c->index;
+        b->offset = c->used;
+        c->used += lines * ARENA_ALIGN;
+    }
+
+    vector_t *v = block_vector(b);
+    v->size = n;
+    return v;
+}
+
+void arena_release(vector_arena_t *arena, vector_t *v)
+{
+    if (arena == NULL || v == NULL)
+        return;
+
+    block_t *b = vector_block(v);
+    chunk_t *c = arena->current;
+
+    // The most recent allocation can simply be popped off the chunk
+    if (b->chunk == c->index && b->offset + b->lines * ARENA_ALIGN == c->used)
+    {
+        c->used = b->offset;
+        return;
+    }
+
+    size_t k = size_class(b->lines);
+    b->next_free = arena->free_lists[k];
+    arena->free_lists[k] = b;
+}
+
+vector_arena_t *arena_use(vector_arena_t *arena)
+{
+    vector_arena_t *previous = active_arena;
+    active_arena = arena;
+    return previous;
+}
+
+vector_arena_t *arena_active(void)
+{
+    return active_arena;
+}
+
+vector_t *arena_empty_like(vector_arena_t *arena, const vector_t *u)
+{
+    vector_arena_t *previous = arena_use(arena);
+    vector_t *v = empty_like(u);
+    arena_use(previous);
+    return v;
+}
+
+vector_t *arena_zeros(vector_arena_t *arena, size_t n)
+{
+    vector_arena_t *previous = arena_use(arena);
+    vector_t *v = zeros(n);
+    arena_use(previous);
+    return v;
+}
+
+vector_t *arena_zeros_like(vector_arena_t *arena, const vector_t *u)
+{
+    vector_arena_t *previous = arena_use(arena);
+    vector_t *v = zeros_like(u);
+    arena_use(previous);
+    return v;
+}
+
+vector_t *arena_arange(vector_arena_t *arena, double start, double end, double step)
+{
+    vector_arena_t *previous = arena_use(arena);
+    vector_t *v = arange(start, end, step);
+    arena_use(previous);
+    return v;
+}
+
+vector_t *arena_linspace(vector_arena_t *arena, double start, double end, size_t n)
+{
+    vector_arena_t *previous = arena_use(arena);
+    vector_t *v = linspace(start, end, n);
+    arena_use(previous);
+    return v;
+}
+
+vector_t *arena_gradient(vector_arena_t *arena, const vector_t *y, const vector_t *x)
+{
+    vector_arena_t *previous = arena_use(arena);
+    vector_t *v = gradient(y, x);
+    arena_use(previous);
+    return v;
+}
+
+vector_t *arena_function_like(vector_arena_t *arena, const vector_t *u, double (*function)(double))
+{
+    vector_arena_t *previous = arena_use(arena);
+    vector_t *v = function_like(u, function);
+    arena_use(previous);
+    return v;
+}
+
+vector_t *arena_get_copy(vector_arena_t *arena, const vector_t *u)
+{
+    vector_arena_t *previous = arena_use(arena);
+    vector_t *v = get_copy(u);
+    arena_use(previous);
+    return v;
+}
+
+vector_t *arena_get_result(vector_arena_t *arena, const vector_t *x, const vector_t *y,
+                           double (*function)(double, double))
+{
+    vector_arena_t *previous = arena_use(arena);
+    vector_t *v = get_result(x, y, function);
+    arena_use(previous);
+    return v;
+}
+
+vector_t *arena_from_array(vector_arena_t *arena, const double arr[], size_t size)
+{
+    vector_arena_t *previous = arena_use(arena);
+    vector_t *v = from_array((double *)arr, size);
+    arena_use(previous);
+    return v;
+}
+
+vector_t *arena_add(vector_arena_t *arena, const vector_t *x, const vector_t *y)
+{
+    vector_arena_t *previous = arena_use(arena);
+    vector_t *v = add(x, y);
+    arena_use(previous);
+    return v;
+}
+
+vector_t *arena_subtract(vector_arena_t *arena, const vector_t *x, const vector_t *y)
+{
+    vector_arena_t *previous = arena_use(arena);
+    vector_t *v = subtract(x, y);
+    arena_use(previous);
+    return v;
+}
+
+vector_t *arena_multiply(vector_arena_t *arena, const vector_t *x, const vector_t *y)
+{
+    vector_arena_t *previous = arena_use(arena);
+    vector_t *v = multiply(x, y);
+    arena_use(previous);
+    return v;
+}
+
+vector_t *arena_divide(vector_arena_t *arena, const vector_t *x, const vector_t *y)
+{
+    vector_arena_t *previous = arena_use(arena);
+    vector_t *v = divide(x, y);
+    arena_use(previous);
+    return v;
+}
+
+vector_t *arena_multiply_add(vector_arena_t *arena, const vector_t *x, const vector_t *y, const vector_t *z)
+{
+    vector_arena_t *previous = arena_use(arena);
+    vector_t *v = multiply_add(x, y, z);
+    arena_use(previous);
+    return v;
+}
@@ -0,0 +1,100 @@
+#ifndef VECTOR_ARENA_H_
+
+#define VECTOR_ARENA_H_
+
+#include <stddef.h>
+#include "vector.h"
+
+/*
+Bump allocator for short lived vectors.
+
+An arena carves vectors out of large chunks, so building a temporary
+costs a pointer bump instead of a malloc call. The data of every arena
+vector starts on a 64 byte boundary. Released vectors go onto per-size
+free lists and are reused by later allocations of the same or a smaller
+size. Everything is dropped at once with arena_reset(), or back to an
+earlier point with arena_mark()/arena_rewind().
+
+Arena vectors must not be passed to free() or free_vector(). An arena
+is not thread safe; use one per thread.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct vector_arena_t vector_arena_t;
+
+// Position in an arena that arena_rewind() can return to
+typedef struct arena_mark_t
+{
+    size_t chunk;
+    size_t used;
+} arena_mark_t;
+
+// Creates an arena that grows in chunks of chunk_bytes (0 for the default)
+vector_arena_t *arena_create(size_t chunk_bytes);
+
+// Frees the arena and every vector allocated from it
+void arena_destroy(vector_arena_t *arena);
+
+// Releases every vector but keeps the chunks for reuse
+void arena_reset(vector_arena_t *arena);
+
+arena_mark_t arena_mark(const vector_arena_t *arena);
+
+// Releases every vector allocated after mark was taken
+void arena_rewind(vector_arena_t *arena, arena_mark_t mark);
+
+// Returns v to the arena so its memory can be reused
+void arena_release(vector_arena_t *arena, vector_t *v);
+
+/*
+Makes the constructors in vector.h allocate from arena on the calling
+thread until arena_use() is called again. Passing NULL switches back to
+malloc. Returns the previously active arena so scopes can be nested.
+*/
+vector_arena_t *arena_use(vector_arena_t *arena);
+
+// Returns the arena active on the calling thread, or NULL
+vector_arena_t *arena_active(void);
+
+// Arena variants of the vector.h constructors
+vector_t *arena_empty(vector_arena_t *arena, size_t n);
+
+vector_t *arena_empty_like(vector_arena_t *arena, const vector_t *u);
+
+vector_t *arena_zeros(vector_arena_t *arena, size_t n);
+
+vector_t *arena_zeros_like(vector_arena_t *arena, const vector_t *u);
+
+vector_t *arena_arange(vector_arena_t *arena, double start, double end, double step);
+
+vector_t *arena_linspace(vector_arena_t *arena, double start, double end, size_t n);
+
+vector_t *arena_gradient(vector_arena_t *arena, const vector_t *y, const vector_t *x);
+
+vector_t *arena_function_like(vector_arena_t *arena, const vector_t *u, double (*function)(double));
+
+vector_t *arena_get_copy(vector_arena_t *arena, const vector_t *u);
+
+vector_t *arena_get_result(vector_arena_t *arena, const vector_t *x, const vector_t *y,
+                           double (*function)(double, double));
+
+vector_t *arena_from_array(vector_arena_t *arena, const double arr[], size_t size);
+
+vector_t *arena_add(vector_arena_t *arena, const vector_t *x, const vector_t *y);
+
+vector_t *arena_subtract(vector_arena_t *arena, const vector_t *x, const vector_t *y);
+
+vector_t *arena_multiply(vector_arena_t *arena, const vector_t *x, const vector_t *y);
+
+vector_t *arena_divide(vector_arena_t *arena, const vector_t *x, const vector_t *y);
+
+vector_t *arena_multiply_add(vector_arena_t *arena, const vector_t *x, const vector_t *y, const vector_t *z);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
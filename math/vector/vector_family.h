@@ -0,0 +1,584 @@
+#ifndef VECTOR_FAMILY_H_
+
+#define VECTOR_FAMILY_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+/*
+Macros that stamp out the vector.h API for another element type.
+
+    DECLARE_VECTOR_FAMILY(vector_f32_t, float, double, f32)
+
+declares the vector type
+
+    typedef struct vector_f32_t { size_t size; float arr[]; } vector_f32_t;
+
+and every function of vector.h with the suffix appended, empty_f32(),
+add_into_f32(), sum_f32() and so on, with the same arguments, checks,
+error messages and aliasing rules. ELEM_T is the element type and ACC_T
+the type trapezoidal_rule, dot and sum accumulate in and return. arange
+is left to the real families.
+
+DEFINE_VECTOR_FAMILY() with the same arguments defines them in one .c
+file. The caller first defines the element kernels the functions run on:
+
+    static void add_elems_SUFFIX(size_t n, ELEM_T out[], const ELEM_T x[], const ELEM_T y[]);
+    static void sub_elems_SUFFIX(...), mul_elems_SUFFIX(...), div_elems_SUFFIX(...);
+    static void fma_elems_SUFFIX(size_t n, ELEM_T out[], const ELEM_T x[], const ELEM_T y[], const ELEM_T z[]);
+    static void scale_elems_SUFFIX(size_t n, ELEM_T out[], const ELEM_T x[], ELEM_T a);
+    static void axpy_elems_SUFFIX(size_t n, ELEM_T y[], ELEM_T a, const ELEM_T x[]);
+    static ACC_T sum_elems_SUFFIX(size_t n, const ELEM_T x[]);
+    static ACC_T dot_elems_SUFFIX(size_t n, const ELEM_T x[], const ELEM_T y[]);
+    static ACC_T trapz_elems_SUFFIX(size_t n, const ELEM_T y[], const ELEM_T x[]);
+    static void print_elem_SUFFIX(ELEM_T x);
+
+Family vectors are always malloc'd; the arena only hands out vector_t.
+*/
+
+#define DECLARE_VECTOR_FAMILY(VECTOR_T, ELEM_T, ACC_T, SUFFIX)                                                          \
+    typedef struct VECTOR_T                                                                                             \
+    {                                                                                                                   \
+        size_t size;                                                                                                    \
+        ELEM_T arr[];                                                                                                   \
+    } VECTOR_T;                                                                                                         \
+                                                                                                                        \
+    VECTOR_T *empty_like_##SUFFIX(const VECTOR_T *u);                                                                   \
+    VECTOR_T *empty_##SUFFIX(size_t n);                                                                                 \
+    VECTOR_T *zeros_like_##SUFFIX(const VECTOR_T *u);                                                                   \
+    VECTOR_T *zeros_##SUFFIX(size_t n);                                                                                 \
+    VECTOR_T *linspace_##SUFFIX(ELEM_T start, ELEM_T end, size_t n);                                                    \
+    VECTOR_T *gradient_##SUFFIX(const VECTOR_T *y, const VECTOR_T *x);                                                  \
+    void apply_function_##SUFFIX(VECTOR_T *v, ELEM_T (*function)(ELEM_T));                                              \
+    VECTOR_T *function_like_##SUFFIX(const VECTOR_T *u, ELEM_T (*function)(ELEM_T));                                    \
+    void print_vector_##SUFFIX(const VECTOR_T *v);                                                                      \
+    VECTOR_T *get_copy_##SUFFIX(const VECTOR_T *u);                                                                     \
+    VECTOR_T *get_result_##SUFFIX(const VECTOR_T *x, const VECTOR_T *y, ELEM_T (*function)(ELEM_T, ELEM_T));            \
+    VECTOR_T *from_array_##SUFFIX(ELEM_T arr[], size_t size);                                                           \
+    ELEM_T *to_array_##SUFFIX(const VECTOR_T *v);                                                                       \
+    ACC_T trapezoidal_rule_##SUFFIX(const VECTOR_T *y, const VECTOR_T *x);                                              \
+    ELEM_T reduce_##SUFFIX(ELEM_T(f)(ELEM_T, ELEM_T), const VECTOR_T *v);                                               \
+    VECTOR_T *add_##SUFFIX(const VECTOR_T *x, const VECTOR_T *y);                                                       \
+    VECTOR_T *subtract_##SUFFIX(const VECTOR_T *x, const VECTOR_T *y);                                                  \
+    VECTOR_T *multiply_##SUFFIX(const VECTOR_T *x, const VECTOR_T *y);                                                  \
+    VECTOR_T *divide_##SUFFIX(const VECTOR_T *x, const VECTOR_T *y);                                                    \
+    VECTOR_T *multiply_add_##SUFFIX(const VECTOR_T *x, const VECTOR_T *y, const VECTOR_T *z);                           \
+    void scale_##SUFFIX(VECTOR_T *v, ELEM_T a);                                                                         \
+    void axpy_##SUFFIX(ELEM_T a, const VECTOR_T *x, VECTOR_T *y);                                                       \
+    ACC_T dot_##SUFFIX(const VECTOR_T *x, const VECTOR_T *y);                                                           \
+    ACC_T sum_##SUFFIX(const VECTOR_T *v);                                                                              \
+    VECTOR_T *linspace_into_##SUFFIX(VECTOR_T *out, ELEM_T start, ELEM_T end);                                          \
+    VECTOR_T *gradient_into_##SUFFIX(VECTOR_T *out, const VECTOR_T *y, const VECTOR_T *x);                              \
+    VECTOR_T *function_like_into_##SUFFIX(VECTOR_T *out, const VECTOR_T *u, ELEM_T (*function)(ELEM_T));                \
+    VECTOR_T *get_copy_into_##SUFFIX(VECTOR_T *out, const VECTOR_T *u);                                                 \
+    VECTOR_T *get_result_into_##SUFFIX(VECTOR_T *out, const VECTOR_T *x, const VECTOR_T *y,                             \
+                                       ELEM_T (*function)(ELEM_T, ELEM_T));                                             \
+    VECTOR_T *from_array_into_##SUFFIX(VECTOR_T *out, const ELEM_T arr[]);                                              \
+    VECTOR_T *add_into_##SUFFIX(VECTOR_T *out, const VECTOR_T *x, const VECTOR_T *y);                                   \
+    VECTOR_T *subtract_into_##SUFFIX(VECTOR_T *out, const VECTOR_T *x, const VECTOR_T *y);                              \
+    VECTOR_T *multiply_into_##SUFFIX(VECTOR_T *out, const VECTOR_T *x, const VECTOR_T *y);                              \
+    VECTOR_T *divide_into_##SUFFIX(VECTOR_T *out, const VECTOR_T *x, const VECTOR_T *y);                                \
+    VECTOR_T *multiply_add_into_##SUFFIX(VECTOR_T *out, const VECTOR_T *x, const VECTOR_T *y, const VECTOR_T *z);       \
+    void free_vector_##SUFFIX(VECTOR_T *v);                                                                             \
+    ELEM_T get_ve_##SUFFIX(const VECTOR_T *v, int index);
+
+#define DEFINE_VECTOR_FAMILY(VECTOR_T, ELEM_T, ACC_T, SUFFIX)                                                           \
+    static VECTOR_T *alloc_##SUFFIX(size_t n)                                                                           \
+    {                                                                                                                   \
+        VECTOR_T *v = malloc(sizeof(*v) + sizeof(ELEM_T) * n);                                                          \
+        if (v != NULL)                                                                                                  \
+            v->size = n;                                                                                                \
+                                                                                                                        \
+        return v;                                                                                                       \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *empty_##SUFFIX(size_t n)                                                                                  \
+    {                                                                                                                   \
+        VECTOR_T *v = alloc_##SUFFIX(n);                                                                                \
+        if (v == NULL)                                                                                                  \
+            fprintf(stderr, "%s: Memory allocation falied\n", __func__);                                                \
+                                                                                                                        \
+        return v;                                                                                                       \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *empty_like_##SUFFIX(const VECTOR_T *u)                                                                    \
+    {                                                                                                                   \
+        return u != NULL ? empty_##SUFFIX(u->size) : NULL;                                                              \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *zeros_##SUFFIX(size_t n)                                                                                  \
+    {                                                                                                                   \
+        VECTOR_T *v = empty_##SUFFIX(n);                                                                                \
+        if (v != NULL)                                                                                                  \
+            memset(v->arr, 0, sizeof(ELEM_T) * n);                                                                      \
+                                                                                                                        \
+        return v;                                                                                                       \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *zeros_like_##SUFFIX(const VECTOR_T *u)                                                                    \
+    {                                                                                                                   \
+        return u != NULL ? zeros_##SUFFIX(u->size) : NULL;                                                              \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *linspace_##SUFFIX(ELEM_T start, ELEM_T end, size_t n)                                                     \
+    {                                                                                                                   \
+        VECTOR_T *v = empty_##SUFFIX(n);                                                                                \
+        return v != NULL ? linspace_into_##SUFFIX(v, start, end) : NULL;                                                \
+    }                                                                                                                   \
+                                                                                                                        \
+    /* Steps in ACC_T so the index stays exact, with end stored exactly */                                              \
+    VECTOR_T *linspace_into_##SUFFIX(VECTOR_T *out, ELEM_T start, ELEM_T end)                                           \
+    {                                                                                                                   \
+        if (out == NULL || out->size == 0)                                                                              \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Null or empty vector\n", __func__);                                                    \
+            return NULL;                                                                                                \
+        }                                                                                                               \
+                                                                                                                        \
+        const size_t n = out->size;                                                                                     \
+        const ACC_T step = ((ACC_T)end - (ACC_T)start) / (n - 1.0);                                                     \
+                                                                                                                        \
+        for (size_t i = 0; i + 1 < n; ++i)                                                                              \
+            out->arr[i] = (ELEM_T)((ACC_T)start + (double)i * step);                                                    \
+        out->arr[n - 1] = n == 1 ? start : end;                                                                         \
+                                                                                                                        \
+        return out;                                                                                                     \
+    }                                                                                                                   \
+                                                                                                                        \
+    /* True when the data of a and b overlap without being the same array */                                            \
+    static bool partially_overlaps_##SUFFIX(const VECTOR_T *a, const VECTOR_T *b)                                       \
+    {                                                                                                                   \
+        const ELEM_T *a_end = a->arr + a->size;                                                                         \
+        const ELEM_T *b_end = b->arr + b->size;                                                                         \
+                                                                                                                        \
+        return a->arr != b->arr && a->arr < b_end && b->arr < a_end;                                                    \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *gradient_##SUFFIX(const VECTOR_T *y, const VECTOR_T *x)                                                   \
+    {                                                                                                                   \
+        if (y == NULL || x == NULL || y->size != x->size || y->size < 3)                                                \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Vectors must have the same size of at least 3\n", __func__);                           \
+            return NULL;                                                                                                \
+        }                                                                                                               \
+                                                                                                                        \
+        VECTOR_T *v = empty_##SUFFIX(y->size);                                                                          \
+        return v != NULL ? gradient_into_##SUFFIX(v, y, x) : NULL;                                                      \
+    }                                                                                                                   \
+                                                                                                                        \
+    /* Keeps the previous y and x, so out may be y or x */                                                              \
+    VECTOR_T *gradient_into_##SUFFIX(VECTOR_T *out, const VECTOR_T *y, const VECTOR_T *x)                               \
+    {                                                                                                                   \
+        if (out == NULL || y == NULL || x == NULL)                                                                      \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Null vector\n", __func__);                                                             \
+            return NULL;                                                                                                \
+        }                                                                                                               \
+                                                                                                                        \
+        if (y->size != x->size || out->size != y->size || y->size < 3)                                                  \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Vectors must have the same size of at least 3\n", __func__);                           \
+            return NULL;                                                                                                \
+        }                                                                                                               \
+                                                                                                                        \
+        if (partially_overlaps_##SUFFIX(out, y) || partially_overlaps_##SUFFIX(out, x))                                 \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Output partially overlaps an input\n", __func__);                                      \
+            return NULL;                                                                                                \
+        }                                                                                                               \
+                                                                                                                        \
+        const size_t n = y->size;                                                                                       \
+        const ELEM_T last = (y->arr[n - 1] - y->arr[n - 2]) / (x->arr[n - 1] - x->arr[n - 2]);                          \
+        ELEM_T y_prev = y->arr[0], x_prev = x->arr[0];                                                                  \
+                                                                                                                        \
+        out->arr[0] = (y->arr[1] - y->arr[0]) / (x->arr[1] - x->arr[0]);                                                \
+        for (size_t i = 1; i + 1 < n; ++i)                                                                              \
+        {                                                                                                               \
+            const ELEM_T yi = y->arr[i], xi = x->arr[i];                                                                \
+            out->arr[i] = (y->arr[i + 1] - y_prev) / (x->arr[i + 1] - x_prev);                                          \
+            y_prev = yi;                                                                                                \
+            x_prev = xi;                                                                                                \
+        }                                                                                                               \
+        out->arr[n - 1] = last;                                                                                         \
+                                                                                                                        \
+        return out;                                                                                                     \
+    }                                                                                                                   \
+                                                                                                                        \
+    void apply_function_##SUFFIX(VECTOR_T *v, ELEM_T (*function)(ELEM_T))                                               \
+    {                                                                                                                   \
+        if (v == NULL)                                                                                                  \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Null vector\n", __func__);                                                             \
+            return;                                                                                                     \
+        }                                                                                                               \
+                                                                                                                        \
+        for (size_t i = 0; i < v->size; ++i)                                                                            \
+            v->arr[i] = function(v->arr[i]);                                                                            \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *function_like_##SUFFIX(const VECTOR_T *u, ELEM_T (*function)(ELEM_T))                                     \
+    {                                                                                                                   \
+        if (u == NULL)                                                                                                  \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Null vector\n", __func__);                                                             \
+            return NULL;                                                                                                \
+        }                                                                                                               \
+                                                                                                                        \
+        VECTOR_T *v = empty_##SUFFIX(u->size);                                                                          \
+        return v != NULL ? function_like_into_##SUFFIX(v, u, function) : NULL;                                          \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *function_like_into_##SUFFIX(VECTOR_T *out, const VECTOR_T *u, ELEM_T (*function)(ELEM_T))                 \
+    {                                                                                                                   \
+        if (out == NULL || u == NULL)                                                                                   \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Null vector\n", __func__);                                                             \
+            return NULL;                                                                                                \
+        }                                                                                                               \
+                                                                                                                        \
+        if (out->size != u->size || partially_overlaps_##SUFFIX(out, u))                                                \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Output has a different size or partially overlaps the input\n", __func__);             \
+            return NULL;                                                                                                \
+        }                                                                                                               \
+                                                                                                                        \
+        for (size_t i = 0; i < out->size; ++i)                                                                          \
+            out->arr[i] = function(u->arr[i]);                                                                          \
+                                                                                                                        \
+        return out;                                                                                                     \
+    }                                                                                                                   \
+                                                                                                                        \
+    void print_vector_##SUFFIX(const VECTOR_T *v)                                                                       \
+    {                                                                                                                   \
+        if (v == NULL)                                                                                                  \
+        {                                                                                                               \
+            puts("[]");                                                                                                 \
+            return;                                                                                                     \
+        }                                                                                                               \
+                                                                                                                        \
+        printf("[");                                                                                                    \
+        for (size_t i = 0; i < v->size; ++i)                                                                            \
+        {                                                                                                               \
+            print_elem_##SUFFIX(v->arr[i]);                                                                             \
+                                                                                                                        \
+            if ((i + 1) < v->size)                                                                                      \
+                printf(", ");                                                                                           \
+                                                                                                                        \
+            if ((i + 1) % 10 == 0 && (i + 1) != v->size)                                                                \
+                putchar('\n');                                                                                          \
+        }                                                                                                               \
+        puts("]\n");                                                                                                    \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *get_copy_##SUFFIX(const VECTOR_T *u)                                                                      \
+    {                                                                                                                   \
+        if (u == NULL)                                                                                                  \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Null vector\n", __func__);                                                             \
+            return NULL;                                                                                                \
+        }                                                                                                               \
+                                                                                                                        \
+        VECTOR_T *v = empty_##SUFFIX(u->size);                                                                          \
+        return v != NULL ? get_copy_into_##SUFFIX(v, u) : NULL;                                                         \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *get_copy_into_##SUFFIX(VECTOR_T *out, const VECTOR_T *u)                                                  \
+    {                                                                                                                   \
+        if (out == NULL || u == NULL)                                                                                   \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Null vector\n", __func__);                                                             \
+            return NULL;                                                                                                \
+        }                                                                                                               \
+                                                                                                                        \
+        if (out->size != u->size)                                                                                       \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Different size vectors\n", __func__);                                                  \
+            return NULL;                                                                                                \
+        }                                                                                                               \
+                                                                                                                        \
+        memmove(out->arr, u->arr, sizeof(ELEM_T) * out->size);                                                          \
+        return out;                                                                                                     \
+    }                                                                                                                   \
+                                                                                                                        \
+    /* Checks the output and operands of an element-wise operation */                                                   \
+    static bool check_elementwise_##SUFFIX(const VECTOR_T *out, const VECTOR_T *x, const VECTOR_T *y,                   \
+                                           const char *caller)                                                          \
+    {                                                                                                                   \
+        if (out == NULL || x == NULL || y == NULL)                                                                      \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Null vector\n", caller);                                                               \
+            return false;                                                                                               \
+        }                                                                                                               \
+                                                                                                                        \
+        if (x->size != y->size || out->size != x->size)                                                                 \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Different size vectors\n", caller);                                                    \
+            return false;                                                                                               \
+        }                                                                                                               \
+                                                                                                                        \
+        if (partially_overlaps_##SUFFIX(out, x) || partially_overlaps_##SUFFIX(out, y))                                 \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Output partially overlaps an input\n", caller);                                        \
+            return false;                                                                                               \
+        }                                                                                                               \
+                                                                                                                        \
+        return true;                                                                                                    \
+    }                                                                                                                   \
+                                                                                                                        \
+    /* Checks the operands of an element-wise operation and allocates its result */                                     \
+    static VECTOR_T *elementwise_result_##SUFFIX(const VECTOR_T *x, const VECTOR_T *y, const char *caller)              \
+    {                                                                                                                   \
+        if (x == NULL || y == NULL)                                                                                     \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Null vector\n", caller);                                                               \
+            return NULL;                                                                                                \
+        }                                                                                                               \
+                                                                                                                        \
+        if (x->size != y->size)                                                                                         \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Different size vectors\n", caller);                                                    \
+            return NULL;                                                                                                \
+        }                                                                                                               \
+                                                                                                                        \
+        return empty_##SUFFIX(x->size);                                                                                 \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *get_result_##SUFFIX(const VECTOR_T *x, const VECTOR_T *y, ELEM_T (*function)(ELEM_T, ELEM_T))             \
+    {                                                                                                                   \
+        VECTOR_T *v = elementwise_result_##SUFFIX(x, y, __func__);                                                      \
+        return v != NULL ? get_result_into_##SUFFIX(v, x, y, function) : NULL;                                          \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *get_result_into_##SUFFIX(VECTOR_T *out, const VECTOR_T *x, const VECTOR_T *y,                             \
+                                       ELEM_T (*function)(ELEM_T, ELEM_T))                                              \
+    {                                                                                                                   \
+        if (!check_elementwise_##SUFFIX(out, x, y, __func__))                                                           \
+            return NULL;                                                                                                \
+                                                                                                                        \
+        for (size_t i = 0; i < out->size; ++i)                                                                          \
+            out->arr[i] = function(x->arr[i], y->arr[i]);                                                               \
+                                                                                                                        \
+        return out;                                                                                                     \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *from_array_##SUFFIX(ELEM_T arr[], size_t size)                                                            \
+    {                                                                                                                   \
+        if (arr == NULL)                                                                                                \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Empty array\n", __func__);                                                             \
+            return NULL;                                                                                                \
+        }                                                                                                               \
+                                                                                                                        \
+        VECTOR_T *v = empty_##SUFFIX(size);                                                                             \
+        return v != NULL ? from_array_into_##SUFFIX(v, arr) : NULL;                                                     \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *from_array_into_##SUFFIX(VECTOR_T *out, const ELEM_T arr[])                                               \
+    {                                                                                                                   \
+        if (out == NULL || arr == NULL)                                                                                 \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Null vector or array\n", __func__);                                                    \
+            return NULL;                                                                                                \
+        }                                                                                                               \
+                                                                                                                        \
+        memmove(out->arr, arr, sizeof(ELEM_T) * out->size);                                                             \
+        return out;                                                                                                     \
+    }                                                                                                                   \
+                                                                                                                        \
+    ELEM_T *to_array_##SUFFIX(const VECTOR_T *v)                                                                        \
+    {                                                                                                                   \
+        if (v == NULL)                                                                                                  \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Null vector\n", __func__);                                                             \
+            return NULL;                                                                                                \
+        }                                                                                                               \
+                                                                                                                        \
+        ELEM_T *arr = malloc(sizeof(*arr) * v->size);                                                                   \
+        if (arr != NULL)                                                                                                \
+            memcpy(arr, v->arr, sizeof(*arr) * v->size);                                                                \
+                                                                                                                        \
+        return arr;                                                                                                     \
+    }                                                                                                                   \
+                                                                                                                        \
+    ELEM_T get_ve_##SUFFIX(const VECTOR_T *v, int index)                                                                \
+    {                                                                                                                   \
+        return v->arr[index];                                                                                           \
+    }                                                                                                                   \
+                                                                                                                        \
+    ACC_T trapezoidal_rule_##SUFFIX(const VECTOR_T *y, const VECTOR_T *x)                                               \
+    {                                                                                                                   \
+        if (y == NULL || x == NULL)                                                                                     \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Null vector\n", __func__);                                                             \
+            return 0.0;                                                                                                 \
+        }                                                                                                               \
+                                                                                                                        \
+        if (x->size != y->size)                                                                                         \
+        {                                                                                                               \
+            fprintf(stderr, "%s: x and y must have same size\n", __func__);                                             \
+            return 0.0;                                                                                                 \
+        }                                                                                                               \
+                                                                                                                        \
+        return trapz_elems_##SUFFIX(x->size, y->arr, x->arr);                                                           \
+    }                                                                                                                   \
+                                                                                                                        \
+    ELEM_T reduce_##SUFFIX(ELEM_T(f)(ELEM_T, ELEM_T), const VECTOR_T *v)                                                \
+    {                                                                                                                   \
+        if (v == NULL || v->size == 0)                                                                                  \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Null or empty vector\n", __func__);                                                    \
+            return 0.0;                                                                                                 \
+        }                                                                                                               \
+                                                                                                                        \
+        ELEM_T result = v->arr[0];                                                                                      \
+        for (size_t i = 1; i < v->size; ++i)                                                                            \
+            result = f(result, v->arr[i]);                                                                              \
+                                                                                                                        \
+        return result;                                                                                                  \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *add_##SUFFIX(const VECTOR_T *x, const VECTOR_T *y)                                                        \
+    {                                                                                                                   \
+        VECTOR_T *v = elementwise_result_##SUFFIX(x, y, __func__);                                                      \
+        return v != NULL ? add_into_##SUFFIX(v, x, y) : NULL;                                                           \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *add_into_##SUFFIX(VECTOR_T *out, const VECTOR_T *x, const VECTOR_T *y)                                    \
+    {                                                                                                                   \
+        if (!check_elementwise_##SUFFIX(out, x, y, __func__))                                                           \
+            return NULL;                                                                                                \
+                                                                                                                        \
+        add_elems_##SUFFIX(out->size, out->arr, x->arr, y->arr);                                                        \
+        return out;                                                                                                     \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *subtract_##SUFFIX(const VECTOR_T *x, const VECTOR_T *y)                                                   \
+    {                                                                                                                   \
+        VECTOR_T *v = elementwise_result_##SUFFIX(x, y, __func__);                                                      \
+        return v != NULL ? subtract_into_##SUFFIX(v, x, y) : NULL;                                                      \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *subtract_into_##SUFFIX(VECTOR_T *out, const VECTOR_T *x, const VECTOR_T *y)                               \
+    {                                                                                                                   \
+        if (!check_elementwise_##SUFFIX(out, x, y, __func__))                                                           \
+            return NULL;                                                                                                \
+                                                                                                                        \
+        sub_elems_##SUFFIX(out->size, out->arr, x->arr, y->arr);                                                        \
+        return out;                                                                                                     \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *multiply_##SUFFIX(const VECTOR_T *x, const VECTOR_T *y)                                                   \
+    {                                                                                                                   \
+        VECTOR_T *v = elementwise_result_##SUFFIX(x, y, __func__);                                                      \
+        return v != NULL ? multiply_into_##SUFFIX(v, x, y) : NULL;                                                      \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *multiply_into_##SUFFIX(VECTOR_T *out, const VECTOR_T *x, const VECTOR_T *y)                               \
+    {                                                                                                                   \
+        if (!check_elementwise_##SUFFIX(out, x, y, __func__))                                                           \
+            return NULL;                                                                                                \
+                                                                                                                        \
+        mul_elems_##SUFFIX(out->size, out->arr, x->arr, y->arr);                                                        \
+        return out;                                                                                                     \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *divide_##SUFFIX(const VECTOR_T *x, const VECTOR_T *y)                                                     \
+    {                                                                                                                   \
+        VECTOR_T *v = elementwise_result_##SUFFIX(x, y, __func__);                                                      \
+        return v != NULL ? divide_into_##SUFFIX(v, x, y) : NULL;                                                        \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *divide_into_##SUFFIX(VECTOR_T *out, const VECTOR_T *x, const VECTOR_T *y)                                 \
+    {                                                                                                                   \
+        if (!check_elementwise_##SUFFIX(out, x, y, __func__))                                                           \
+            return NULL;                                                                                                \
+                                                                                                                        \
+        div_elems_##SUFFIX(out->size, out->arr, x->arr, y->arr);                                                        \
+        return out;                                                                                                     \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *multiply_add_##SUFFIX(const VECTOR_T *x, const VECTOR_T *y, const VECTOR_T *z)                            \
+    {                                                                                                                   \
+        if (z == NULL || (x != NULL && x->size != z->size))                                                             \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Null or different size vectors\n", __func__);                                          \
+            return NULL;                                                                                                \
+        }                                                                                                               \
+                                                                                                                        \
+        VECTOR_T *v = elementwise_result_##SUFFIX(x, y, __func__);                                                      \
+        return v != NULL ? multiply_add_into_##SUFFIX(v, x, y, z) : NULL;                                               \
+    }                                                                                                                   \
+                                                                                                                        \
+    VECTOR_T *multiply_add_into_##SUFFIX(VECTOR_T *out, const VECTOR_T *x, const VECTOR_T *y, const VECTOR_T *z)        \
+    {                                                                                                                   \
+        if (!check_elementwise_##SUFFIX(out, x, y, __func__) || !check_elementwise_##SUFFIX(out, z, z, __func__))       \
+            return NULL;                                                                                                \
+                                                                                                                        \
+        fma_elems_##SUFFIX(out->size, out->arr, x->arr, y->arr, z->arr);                                                \
+        return out;                                                                                                     \
+    }                                                                                                                   \
+                                                                                                                        \
+    void scale_##SUFFIX(VECTOR_T *v, ELEM_T a)                                                                          \
+    {                                                                                                                   \
+        if (v == NULL)                                                                                                  \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Null vector\n", __func__);                                                             \
+            return;                                                                                                     \
+        }                                                                                                               \
+                                                                                                                        \
+        scale_elems_##SUFFIX(v->size, v->arr, v->arr, a);                                                               \
+    }                                                                                                                   \
+                                                                                                                        \
+    void axpy_##SUFFIX(ELEM_T a, const VECTOR_T *x, VECTOR_T *y)                                                        \
+    {                                                                                                                   \
+        if (x == NULL || y == NULL)                                                                                     \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Null vector\n", __func__);                                                             \
+            return;                                                                                                     \
+        }                                                                                                               \
+                                                                                                                        \
+        if (x->size != y->size)                                                                                         \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Different size vectors\n", __func__);                                                  \
+            return;                                                                                                     \
+        }                                                                                                               \
+                                                                                                                        \
+        axpy_elems_##SUFFIX(y->size, y->arr, a, x->arr);                                                                \
+    }                                                                                                                   \
+                                                                                                                        \
+    ACC_T dot_##SUFFIX(const VECTOR_T *x, const VECTOR_T *y)                                                            \
+    {                                                                                                                   \
+        if (x == NULL || y == NULL)                                                                                     \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Null vector\n", __func__);                                                             \
+            return 0.0;                                                                                                 \
+        }                                                                                                               \
+                                                                                                                        \
+        if (x->size != y->size)                                                                                         \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Different size vectors\n", __func__);                                                  \
+            return 0.0;                                                                                                 \
+        }                                                                                                               \
+                                                                                                                        \
+        return dot_elems_##SUFFIX(x->size, x->arr, y->arr);                                                             \
+    }                                                                                                                   \
+                                                                                                                        \
+    ACC_T sum_##SUFFIX(const VECTOR_T *v)                                                                               \
+    {                                                                                                                   \
+        if (v == NULL)                                                                                                  \
+        {                                                                                                               \
+            fprintf(stderr, "%s: Null vector\n", __func__);                                                             \
+            return 0.0;                                                                                                 \
+        }                                                                                                               \
+                                                                                                                        \
+        return sum_elems_##SUFFIX(v->size, v->arr);                                                                     \
+    }                                                                                                                   \
+                                                                                                                        \
+    void free_vector_##SUFFIX(VECTOR_T *v)                                                                              \
+    {                                                                                                                   \
+        free(v);                                                                                                        \
+    }
+
+#endif
@@ -0,0 +1,298 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "vector_generator.h"
+#include "vector_kernels.h"
+#include "vector_sum.h"
+
+// Elements generated at a time, a multiple of KERNEL_LANES small enough for L1
+#define GEN_TILE 512
+
+static const vector_gen_t no_gen = {0.0, 0.0, 0.0, 0};
+
+vector_gen_t gen_linspace(double start, double end, size_t n)
+{
+    if (n == 0)
+    {
+        fprintf(stderr, "%s: Empty linspace\n", __func__);
+        return no_gen;
+    }
+
+    if (n == 1)
+        return gen_constant(start, 1);
+
+    vector_gen_t g = {start, (end - start) / (n - 1.0), end, n};
+    return g;
+}
+
+vector_gen_t gen_arange(double start, double end, double step)
+{
+    if (step == 0 || (step > 0 ? end <= start : start <= end))
+    {
+        fprintf(stderr, "%s: Step does not lead from start to end\n", __func__);
+        return no_gen;
+    }
+
+    // Same number of terms as arange()
+    const size_t n = (size_t)((end - start) / step);
+    if (n == 0)
+    {
+        fprintf(stderr, "%s: Empty range\n", __func__);
+        return no_gen;
+    }
+
+    vector_gen_t g = {start, step, start + (n - 1) * step, n};
+    return g;
+}
+
+vector_gen_t gen_constant(double value, size_t n)
+{
+    vector_gen_t g = {value, 0.0, value, n};
+    return g;
+}
+
+// Writes elements first .. first + len - 1 of g to tile
+static void fill_tile(double tile[], vector_gen_t g, size_t first, size_t len)
+{
+    kernel_ramp(len, tile, g.start, g.step, first);
+
+    if (first + len == g.size && g.size > 1)
+        tile[len - 1] = g.end;
+}
+
+static bool check_gen(vector_gen_t g, const char *caller)
+{
+    if (g.size == 0)
+    {
+        fprintf(stderr, "%s: Empty generator\n", caller);
+        return false;
+    }
+    return true;
+}
+
+vector_t *gen_to_vector(vector_gen_t g)
+{
+    if (!check_gen(g, __func__))
+        return NULL;
+
+    return gen_to_vector_into(empty(g.size), g);
+}
+
+vector_t *gen_to_vector_into(vector_t *out, vector_gen_t g)
+{
+    if (out == NULL || !check_gen(g, __func__))
+        return NULL;
+
+    if (out->size != g.size)
+    {
+        fprintf(stderr, "%s: Output has a different size\n", __func__);
+        return NULL;
+    }
+
+    fill_tile(out->arr, g, 0, g.size);
+    return out;
+}
+
+void print_gen(vector_gen_t g)
+{
+    printf("[");
+    for (size_t i = 0; i < g.size; ++i)
+    {
+        printf("%g", gen_at(g, i));
+        if (i + 1 < g.size)
+            printf(", ");
+    }
+    printf("]\n");
+}
+
+vector_t *gen_function_like(vector_gen_t g, double (*function)(double))
+{
+    if (!check_gen(g, __func__))
+        return NULL;
+
+    return gen_function_like_into(empty(g.size), g, function);
+}
+
+vector_t *gen_function_like_into(vector_t *out, vector_gen_t g, double (*function)(double))
+{
+    if (out == NULL || !check_gen(g, __func__))
+        return NULL;
+
+    if (out->size != g.size)
+    {
+        fprintf(stderr, "%s: Output has a different size\n", __func__);
+        return NULL;
+    }
+
+    double tile[GEN_TILE];
+    for (size_t first = 0; first < g.size; first += GEN_TILE)
+    {
+        size_t len = g.size - first < GEN_TILE ? g.size - first : GEN_TILE;
+        fill_tile(tile, g, first, len);
+
+        for (size_t k = 0; k < len; ++k)
+            out->arr[first + k] = function(tile[k]);
+    }
+
+    return out;
+}
+
+vector_t *gen_get_result(vector_gen_t x, const vector_t *y, double (*function)(double, double))
+{
+    if (y == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    return gen_get_result_into(empty_like(y), x, y, function);
+}
+
+vector_t *gen_get_result_into(vector_t *out, vector_gen_t x, const vector_t *y, double (*function)(double, double))
+{
+    if (out == NULL || y == NULL || !check_gen(x, __func__))
+        return NULL;
+
+    if (out->size != x.size || y->size != x.size)
+    {
+        fprintf(stderr, "%s: Different size vectors\n", __func__);
+        return NULL;
+    }
+
+    double tile[GEN_TILE];
+    for (size_t first = 0; first < x.size; first += GEN_TILE)
+    {
+        size_t len = x.size - first < GEN_TILE ? x.size - first : GEN_TILE;
+        fill_tile(tile, x, first, len);
+
+        for (size_t k = 0; k < len; ++k)
+            out->arr[first + k] = function(tile[k], y->arr[first + k]);
+    }
+
+    return out;
+}
+
+vector_t *gen_gradient(const vector_t *y, vector_gen_t x)
+{
+    if (y == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    if (y->size != x.size || y->size < 3)
+    {
+        fprintf(stderr, "%s: Vectors must have the same size of at least 3\n", __func__);
+        return NULL;
+    }
+
+    return gen_gradient_into(empty_like(y), y, x);
+}
+
+/*
+Each tile of central differences is computed into a buffer and written
+back one tile later, once the next tile no longer reads the y values it
+overwrites, so out may be y. This is gradient_into()'s in-place scheme
+with the x values of each tile generated next to it.
+*/
+vector_t *gen_gradient_into(vector_t *out, const vector_t *y, vector_gen_t x)
+{
+    if (out == NULL || y == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    if (y->size != x.size || out->size != y->size || y->size < 3)
+    {
+        fprintf(stderr, "%s: Vectors must have the same size of at least 3\n", __func__);
+        return NULL;
+    }
+
+    const size_t n = y->size;
+    double xs[GEN_TILE + 2];
+    double tiles[2][GEN_TILE + 2];
+    size_t pending_start = 0, pending_len = 0;
+    int t = 0;
+
+    fill_tile(xs, x, 0, 2);
+    double first = (y->arr[1] - y->arr[0]) / (xs[1] - xs[0]);
+    fill_tile(xs, x, n - 2, 2);
+    double last = (y->arr[n - 1] - y->arr[n - 2]) / (xs[1] - xs[0]);
+
+    for (size_t start = 1; start + 1 < n; start += GEN_TILE, t ^= 1)
+    {
+        size_t len = n - 1 - start < GEN_TILE ? n - 1 - start : GEN_TILE;
+
+        // Writes tiles[t][1..len] from y[start - 1 .. start + len]
+        fill_tile(xs, x, start - 1, len + 2);
+        kernel_gradient_interior(len + 2, tiles[t], y->arr + start - 1, xs);
+
+        if (pending_len > 0)
+            memcpy(out->arr + pending_start, tiles[t ^ 1] + 1, sizeof(double) * pending_len);
+
+        pending_start = start;
+        pending_len = len;
+    }
+
+    if (pending_len > 0)
+        memcpy(out->arr + pending_start, tiles[t ^ 1] + 1, sizeof(double) * pending_len);
+
+    out->arr[0] = first;
+    out->arr[n - 1] = last;
+
+    return out;
+}
+
+typedef struct gen_trapz_t
+{
+    const vector_t *y;
+    vector_gen_t x;
+} gen_trapz_t;
+
+// Trapezoids of gen_trapezoidal_rule() for sum_terms(), as trapz_array() computes them
+static void trapz_terms(void *ctx, size_t first, size_t len, double out[])
+{
+    const gen_trapz_t *t = ctx;
+    double xs[SUM_TILE + 1];
+
+    fill_tile(xs, t->x, first, len + 1);
+    for (size_t i = 0; i < len; ++i)
+        out[i] = (t->y->arr[first + i] + t->y->arr[first + i + 1]) * (xs[i + 1] - xs[i]);
+}
+
+double gen_trapezoidal_rule(const vector_t *y, vector_gen_t x)
+{
+    if (y == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return 0.0;
+    }
+
+    if (y->size != x.size)
+    {
+        fprintf(stderr, "%s: x and y must have same size\n", __func__);
+        return 0.0;
+    }
+
+    const sum_policy_t policy = sum_policy();
+    if (policy != SUM_NAIVE)
+    {
+        gen_trapz_t t = {y, x};
+        return x.size < 2 ? 0.0 : sum_terms(policy, x.size - 1, trapz_terms, &t) / 2.0;
+    }
+
+    // Tiles of GEN_TILE trapezoids keep every term in the lane kernel_trapz() gives it
+    double lanes[KERNEL_LANES] = {0.0};
+    double xs[GEN_TILE + 1];
+
+    for (size_t first = 0; first + 1 < x.size; first += GEN_TILE)
+    {
+        size_t len = x.size - 1 - first < GEN_TILE ? x.size - 1 - first : GEN_TILE;
+        fill_tile(xs, x, first, len + 1);
+        kernel_trapz_lanes(len + 1, y->arr + first, xs, lanes);
+    }
+
+    return kernel_combine_lanes(lanes) / 2.0;
+}
@@ -0,0 +1,85 @@
+#ifndef VECTOR_GENERATOR_H_
+
+#define VECTOR_GENERATOR_H_
+
+#include <stddef.h>
+#include "vector.h"
+
+/*
+Lazy vectors whose elements are computed from their index.
+
+A generator describes a linspace(), arange() or constant vector by its
+first element, step and length, so a grid of any size costs no memory:
+
+    vector_gen_t x = gen_linspace(0, 2 * PI, 100000000);
+    vector_t *y = gen_function_like(x, sin);
+    double area = gen_trapezoidal_rule(y, x);
+
+Element i is start + i * step, and the last element of a linspace is end
+exactly, the same values linspace() and arange() store. The consumers
+below compute the elements as they go, a small tile at a time, and run
+the same kernels as their vector.h counterparts, so their results are
+bitwise identical to materialising the generator first.
+
+Generators are plain values and are passed by value. A generator that
+could not be made has size 0, which the consumers reject.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct vector_gen_t
+{
+    double start;
+    double step;
+    double end; // Last element
+    size_t size;
+} vector_gen_t;
+
+// Returns the element at ith position
+static inline double gen_at(vector_gen_t g, size_t i)
+{
+    if (i + 1 == g.size && i > 0)
+        return g.end;
+    return g.start + (double)i * g.step;
+}
+
+// The values of linspace(start, end, n)
+vector_gen_t gen_linspace(double start, double end, size_t n);
+
+// The values of arange(start, end, step)
+vector_gen_t gen_arange(double start, double end, double step);
+
+// n copies of value
+vector_gen_t gen_constant(double value, size_t n);
+
+vector_t *gen_to_vector(vector_gen_t g);
+
+vector_t *gen_to_vector_into(vector_t *out, vector_gen_t g);
+
+void print_gen(vector_gen_t g);
+
+// function_like() of the generated values
+vector_t *gen_function_like(vector_gen_t g, double (*function)(double));
+
+vector_t *gen_function_like_into(vector_t *out, vector_gen_t g, double (*function)(double));
+
+// get_result() with generated x
+vector_t *gen_get_result(vector_gen_t x, const vector_t *y, double (*function)(double, double));
+
+vector_t *gen_get_result_into(vector_t *out, vector_gen_t x, const vector_t *y, double (*function)(double, double));
+
+// gradient() of y over generated x, out may be y itself
+vector_t *gen_gradient(const vector_t *y, vector_gen_t x);
+
+vector_t *gen_gradient_into(vector_t *out, const vector_t *y, vector_gen_t x);
+
+// trapezoidal_rule() of y over generated x
+double gen_trapezoidal_rule(const vector_t *y, vector_gen_t x);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef VECTOR_GENERIC_H_
+
+#define VECTOR_GENERIC_H_
+
+#include "vector.h"
+#include "vector_types.h"
+
+/*
+Type-generic front end over vector.h and vector_types.h.
+
+vec_NAME(...) calls NAME for a vector_t, NAME_f32 for a vector_f32_t,
+NAME_c64 for a vector_c64_t and NAME_c128 for a vector_c128_t, chosen
+at compile time from the vector argument the same way showarray()
+dispatches on its array:
+
+    vector_f32_t *x = linspace_f32(0, 1, 1000);
+    vector_f32_t *y = vec_function_like(x, sinf);
+    double area = vec_trapezoidal_rule(y, x);
+
+Functions that take no vector, such as linspace and zeros, are called
+by their typed names. vec_from_array() dispatches on the array type.
+*/
+
+#define VECTOR_GENERIC(X, NAME) _Generic((X),                         \
+    vector_t *: NAME,                                                 \
+    const vector_t *: NAME,                                           \
+    vector_f32_t *: NAME##_f32,                                       \
+    const vector_f32_t *: NAME##_f32,                                 \
+    vector_c64_t *: NAME##_c64,                                       \
+    const vector_c64_t *: NAME##_c64,                                 \
+    vector_c128_t *: NAME##_c128,                                     \
+    const vector_c128_t *: NAME##_c128)
+
+#define vec_from_array(ARR, N) _Generic((ARR),                        \
+    double *: from_array,                                             \
+    float *: from_array_f32,                                          \
+    float _Complex *: from_array_c64,                                 \
+    double _Complex *: from_array_c128)(ARR, N)
+
+#define vec_empty_like(U) VECTOR_GENERIC(U, empty_like)(U)
+#define vec_zeros_like(U) VECTOR_GENERIC(U, zeros_like)(U)
+#define vec_gradient(Y, X) VECTOR_GENERIC(Y, gradient)(Y, X)
+#define vec_apply_function(V, F) VECTOR_GENERIC(V, apply_function)(V, F)
+#define vec_function_like(U, F) VECTOR_GENERIC(U, function_like)(U, F)
+#define vec_print_vector(V) VECTOR_GENERIC(V, print_vector)(V)
+#define vec_get_copy(U) VECTOR_GENERIC(U, get_copy)(U)
+#define vec_get_result(X, Y, F) VECTOR_GENERIC(X, get_result)(X, Y, F)
+#define vec_to_array(V) VECTOR_GENERIC(V, to_array)(V)
+#define vec_trapezoidal_rule(Y, X) VECTOR_GENERIC(Y, trapezoidal_rule)(Y, X)
+#define vec_reduce(F, V) VECTOR_GENERIC(V, reduce)(F, V)
+#define vec_add(X, Y) VECTOR_GENERIC(X, add)(X, Y)
+#define vec_subtract(X, Y) VECTOR_GENERIC(X, subtract)(X, Y)
+#define vec_multiply(X, Y) VECTOR_GENERIC(X, multiply)(X, Y)
+#define vec_divide(X, Y) VECTOR_GENERIC(X, divide)(X, Y)
+#define vec_multiply_add(X, Y, Z) VECTOR_GENERIC(X, multiply_add)(X, Y, Z)
+#define vec_scale(V, A) VECTOR_GENERIC(V, scale)(V, A)
+#define vec_axpy(A, X, Y) VECTOR_GENERIC(X, axpy)(A, X, Y)
+#define vec_dot(X, Y) VECTOR_GENERIC(X, dot)(X, Y)
+#define vec_sum(V) VECTOR_GENERIC(V, sum)(V)
+#define vec_free_vector(V) VECTOR_GENERIC(V, free_vector)(V)
+#define vec_get_ve(V, I) VECTOR_GENERIC(V, get_ve)(V, I)
+
+#define vec_linspace_into(OUT, START, END) VECTOR_GENERIC(OUT, linspace_into)(OUT, START, END)
+#define vec_gradient_into(OUT, Y, X) VECTOR_GENERIC(OUT, gradient_into)(OUT, Y, X)
+#define vec_function_like_into(OUT, U, F) VECTOR_GENERIC(OUT, function_like_into)(OUT, U, F)
+#define vec_get_copy_into(OUT, U) VECTOR_GENERIC(OUT, get_copy_into)(OUT, U)
+#define vec_get_result_into(OUT, X, Y, F) VECTOR_GENERIC(OUT, get_result_into)(OUT, X, Y, F)
+#define vec_from_array_into(OUT, ARR) VECTOR_GENERIC(OUT, from_array_into)(OUT, ARR)
+#define vec_add_into(OUT, X, Y) VECTOR_GENERIC(OUT, add_into)(OUT, X, Y)
+#define vec_subtract_into(OUT, X, Y) VECTOR_GENERIC(OUT, subtract_into)(OUT, X, Y)
+#define vec_multiply_into(OUT, X, Y) VECTOR_GENERIC(OUT, multiply_into)(OUT, X, Y)
+#define vec_divide_into(OUT, X, Y) VECTOR_GENERIC(OUT, divide_into)(OUT, X, Y)
+#define vec_multiply_add_into(OUT, X, Y, Z) VECTOR_GENERIC(OUT, multiply_add_into)(OUT, X, Y, Z)
+
+#endif
@@ -0,0 +1,370 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "vector_gradient.h"
+
+// Points in the widest stencil
+#define STENCIL (GRADIENT_MAX_ORDER + 1)
+
+/*
+Coefficients of the uniform grid stencils, already divided by h. The
+central derivative is sum of center[k] * (y[i + k] - y[i - k]) for
+k = 1..r; point i < r uses left[i] on y[0..order] and point n - 1 - i
+uses right[i] on y[n - 1 - order..n - 1].
+*/
+typedef struct stencil_t
+{
+    size_t r;
+    size_t points;
+    double center[GRADIENT_MAX_ORDER / 2 + 1];
+    double left[GRADIENT_MAX_ORDER / 2][STENCIL];
+    double right[GRADIENT_MAX_ORDER / 2][STENCIL];
+} stencil_t;
+
+/*
+Weights of the first derivative at z from values at x[0..n-1], by
+Fornberg's recurrence (Math. Comp. 51, 1988) carried to derivative one.
+*/
+static void fornberg(double z, const double x[], size_t n, double weights[])
+{
+    double w0[STENCIL] = {1.0}, w1[STENCIL] = {0.0};
+    double previous = 1.0;
+    double c4 = x[0] - z;
+
+    for (size_t i = 1; i < n; ++i)
+    {
+        double product = 1.0;
+        double c5 = c4;
+        c4 = x[i] - z;
+
+        for (size_t j = 0; j < i; ++j)
+        {
+            double c3 = x[i] - x[j];
+            product *= c3;
+
+            if (j == i - 1)
+            {
+                w1[i] = previous * (w0[i - 1] - c5 * w1[i - 1]) / product;
+                w0[i] = -previous * c5 * w0[i - 1] / product;
+            }
+            w1[j] = (c4 * w1[j] - w0[j]) / c3;
+            w0[j] = c4 * w0[j] / c3;
+        }
+        previous = product;
+    }
+
+    memcpy(weights, w1, sizeof(double) * n);
+}
+
+static bool check_order(int order, size_t n, const char *caller)
+{
+    if (order != 2 && order != 4 && order != 6)
+    {
+        fprintf(stderr, "%s: Order must be 2, 4 or 6\n", caller);
+        return false;
+    }
+
+    if (n < (size_t)order + 1)
+    {
+        fprintf(stderr, "%s: Need at least %d points for order %d\n", caller, order + 1, order);
+        return false;
+    }
+    return true;
+}
+
+static void make_stencil(stencil_t *s, int order, double h)
+{
+    double offsets[STENCIL], w[STENCIL];
+
+    s->r = (size_t)order / 2;
+    s->points = (size_t)order + 1;
+
+    for (size_t k = 0; k < STENCIL; ++k)
+        offsets[k] = (double)k;
+
+    fornberg((double)s->r, offsets, s->points, w);
+    for (size_t k = 1; k <= s->r; ++k)
+        s->center[k] = w[s->r + k] / h;
+
+    for (size_t i = 0; i < s->r; ++i)
+    {
+        fornberg((double)i, offsets, s->points, w);
+        for (size_t k = 0; k < s->points; ++k)
+            s->left[i][k] = w[k] / h;
+
+        fornberg((double)(s->points - 1 - i), offsets, s->points, w);
+        for (size_t k = 0; k < s->points; ++k)
+            s->right[i][k] = w[k] / h;
+    }
+}
+
+/*
+Differentiates outer blocks of n by inner elements along the n axis.
+The interior points of every line of a block are contiguous in memory,
+so each block is one flat loop whose neighbours sit inner elements away.
+*/
+static void uniform_axis(double out[], const double y[], size_t outer, size_t n, size_t inner, const stencil_t *s)
+{
+    const size_t r = s->r;
+    const size_t lo = r * inner, hi = (n - r) * inner;
+
+    for (size_t o = 0; o < outer; ++o)
+    {
+        const double *yb = y + o * n * inner;
+        double *ob = out + o * n * inner;
+
+        switch (r)
+        {
+        case 1:
+        {
+            const double c1 = s->center[1];
+            for (size_t m = lo; m < hi; ++m)
+                ob[m] = c1 * (yb[m + inner] - yb[m - inner]);
+            break;
+        }
+        case 2:
+        {
+            const double c1 = s->center[1], c2 = s->center[2];
+            for (size_t m = lo; m < hi; ++m)
+                ob[m] = c1 * (yb[m + inner] - yb[m - inner]) + c2 * (yb[m + 2 * inner] - yb[m - 2 * inner]);
+            break;
+        }
+        default:
+        {
+            const double c1 = s->center[1], c2 = s->center[2], c3 = s->center[3];
+            for (size_t m = lo; m < hi; ++m)
+                ob[m] = c1 * (yb[m + inner] - yb[m - inner]) + c2 * (yb[m + 2 * inner] - yb[m - 2 * inner]) +
+                        c3 * (yb[m + 3 * inner] - yb[m - 3 * inner]);
+            break;
+        }
+        }
+
+        // One-sided stencils for the points near either end
+        const double *yr = yb + (n - s->points) * inner;
+        for (size_t i = 0; i < r; ++i)
+        {
+            for (size_t j = 0; j < inner; ++j)
+            {
+                double left = 0.0, right = 0.0;
+                for (size_t k = 0; k < s->points; ++k)
+                {
+                    left += s->left[i][k] * yb[k * inner + j];
+                    right += s->right[i][k] * yr[k * inner + j];
+                }
+                ob[i * inner + j] = left;
+                ob[(n - 1 - i) * inner + j] = right;
+            }
+        }
+    }
+}
+
+// True when the data of a and b overlap without being the same array
+static bool partially_overlaps(const vector_t *a, const vector_t *b)
+{
+    const double *a_end = a->arr + a->size;
+    const double *b_end = b->arr + b->size;
+
+    return a->arr != b->arr && a->arr < b_end && b->arr < a_end;
+}
+
+// Rejects an out that partially overlaps y or x, which may be NULL
+static bool check_overlap(const vector_t *out, const vector_t *y, const vector_t *x, const char *caller)
+{
+    if (partially_overlaps(out, y) || (x != NULL && partially_overlaps(out, x)))
+    {
+        fprintf(stderr, "%s: Output partially overlaps an input\n", caller);
+        return false;
+    }
+    return true;
+}
+
+// Scratch output when out is also an input, since stencils read ahead
+static double *aliased_output(const vector_t *out, const vector_t *y, const vector_t *x)
+{
+    if (out->arr != y->arr && (x == NULL || out->arr != x->arr))
+        return (double *)out->arr;
+
+    double *tmp = malloc(sizeof(double) * out->size);
+    if (tmp == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation falied\n", __func__);
+        exit(1);
+    }
+    return tmp;
+}
+
+static void finish_output(vector_t *out, double *result)
+{
+    if (result != out->arr)
+    {
+        memcpy(out->arr, result, sizeof(double) * out->size);
+        free(result);
+    }
+}
+
+vector_t *gradient_uniform(const vector_t *y, double h, int order)
+{
+    if (y == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    if (!check_order(order, y->size, __func__))
+        return NULL;
+
+    return gradient_uniform_into(empty_like(y), y, h, order);
+}
+
+vector_t *gradient_uniform_into(vector_t *out, const vector_t *y, double h, int order)
+{
+    if (out == NULL || y == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    if (out->size != y->size)
+    {
+        fprintf(stderr, "%s: Different size vectors\n", __func__);
+        return NULL;
+    }
+
+    if (!check_order(order, y->size, __func__) || !check_overlap(out, y, NULL, __func__))
+        return NULL;
+
+    stencil_t s;
+    make_stencil(&s, order, h);
+
+    double *result = aliased_output(out, y, NULL);
+    uniform_axis(result, y->arr, 1, y->size, 1, &s);
+    finish_output(out, result);
+
+    return out;
+}
+
+vector_t *gradient_order(const vector_t *y, const vector_t *x, int order)
+{
+    if (y == NULL || x == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    if (y->size != x->size)
+    {
+        fprintf(stderr, "%s: Different size vectors\n", __func__);
+        return NULL;
+    }
+
+    if (!check_order(order, y->size, __func__))
+        return NULL;
+
+    return gradient_order_into(empty_like(y), y, x, order);
+}
+
+vector_t *gradient_order_into(vector_t *out, const vector_t *y, const vector_t *x, int order)
+{
+    if (out == NULL || y == NULL || x == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    if (y->size != x->size || out->size != y->size)
+    {
+        fprintf(stderr, "%s: Different size vectors\n", __func__);
+        return NULL;
+    }
+
+    if (!check_order(order, y->size, __func__) || !check_overlap(out, y, x, __func__))
+        return NULL;
+
+    const size_t n = y->size;
+    const size_t r = (size_t)order / 2, points = (size_t)order + 1;
+    double *result = aliased_output(out, y, x);
+    double w[STENCIL];
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        // Centered window, shifted inwards near the ends
+        size_t start = i < r ? 0 : i - r;
+        if (start + points > n)
+            start = n - points;
+
+        fornberg(x->arr[i], x->arr + start, points, w);
+
+        double d = 0.0;
+        for (size_t k = 0; k < points; ++k)
+            d += w[k] * y->arr[start + k];
+        result[i] = d;
+    }
+
+    finish_output(out, result);
+    return out;
+}
+
+/*
+Checks a grid and its output, and splits the shape into the number of
+blocks before the axis and the number of elements after it.
+*/
+static bool check_axis(const vector_t *out, const vector_t *y, size_t ndim, const size_t shape[], size_t axis,
+                       int order, size_t *outer, size_t *inner, const char *caller)
+{
+    if (out == NULL || y == NULL || shape == NULL)
+    {
+        fprintf(stderr, "%s: Null vector or shape\n", caller);
+        return false;
+    }
+
+    if (axis >= ndim)
+    {
+        fprintf(stderr, "%s: Axis %zu out of range for %zu dimensions\n", caller, axis, ndim);
+        return false;
+    }
+
+    *outer = 1;
+    *inner = 1;
+    for (size_t d = 0; d < axis; ++d)
+        *outer *= shape[d];
+    for (size_t d = axis + 1; d < ndim; ++d)
+        *inner *= shape[d];
+
+    if (*outer * shape[axis] * *inner != y->size || out->size != y->size)
+    {
+        fprintf(stderr, "%s: Shape does not match the vector size\n", caller);
+        return false;
+    }
+
+    return check_order(order, shape[axis], caller);
+}
+
+vector_t *gradient_axis(const vector_t *y, size_t ndim, const size_t shape[], size_t axis, double h, int order)
+{
+    size_t outer, inner;
+
+    if (!check_axis(y, y, ndim, shape, axis, order, &outer, &inner, __func__))
+        return NULL;
+
+    return gradient_axis_into(empty_like(y), y, ndim, shape, axis, h, order);
+}
+
+vector_t *gradient_axis_into(vector_t *out, const vector_t *y, size_t ndim, const size_t shape[], size_t axis,
+                             double h, int order)
+{
+    size_t outer, inner;
+
+    if (!check_axis(out, y, ndim, shape, axis, order, &outer, &inner, __func__) ||
+        !check_overlap(out, y, NULL, __func__))
+        return NULL;
+
+    stencil_t s;
+    make_stencil(&s, order, h);
+
+    double *result = aliased_output(out, y, NULL);
+    uniform_axis(result, y->arr, outer, shape[axis], inner, &s);
+    finish_output(out, result);
+
+    return out;
+}
@@ -0,0 +1,58 @@
+#ifndef VECTOR_GRADIENT_H_
+
+#define VECTOR_GRADIENT_H_
+
+#include <stddef.h>
+#include "vector.h"
+
+/*
+Higher order and uniform grid versions of gradient().
+
+order is the order of accuracy, 2, 4 or 6. Interior points use the
+central stencil of order + 1 points; points closer than order / 2 to an
+end use the one-sided stencil of the same number of points, so the whole
+result has the requested order. y needs at least order + 1 elements.
+
+gradient_uniform() takes the spacing h of a uniform grid such as one
+from linspace() and only multiplies by precomputed coefficients / h.
+gradient_order() accepts any strictly monotonic x and derives the
+stencil weights at each point with Fornberg's algorithm.
+
+gradient_axis() differentiates a row-major grid of ndim dimensions,
+stored flat in y, along one axis with uniform spacing h:
+
+    size_t shape[2] = {rows, cols};
+    vector_t *dy = gradient_axis(f, 2, shape, 0, hy, 4);
+    vector_t *dx = gradient_axis(f, 2, shape, 1, hx, 4);
+
+The _into variants follow vector.h: out must have the size of y, may be
+y or x itself, and is rejected if it partially overlaps either. The
+stencils read ahead of the point they write, so an in-place call
+mallocs a scratch result of the size of y for its duration; out
+separate from the inputs allocates nothing.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GRADIENT_MAX_ORDER 6
+
+vector_t *gradient_uniform(const vector_t *y, double h, int order);
+
+vector_t *gradient_uniform_into(vector_t *out, const vector_t *y, double h, int order);
+
+vector_t *gradient_order(const vector_t *y, const vector_t *x, int order);
+
+vector_t *gradient_order_into(vector_t *out, const vector_t *y, const vector_t *x, int order);
+
+vector_t *gradient_axis(const vector_t *y, size_t ndim, const size_t shape[], size_t axis, double h, int order);
+
+vector_t *gradient_axis_into(vector_t *out, const vector_t *y, size_t ndim, const size_t shape[], size_t axis,
+                             double h, int order);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
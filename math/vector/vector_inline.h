@@ -0,0 +1,183 @@
+#ifndef VECTOR_INLINE_H_
+
+#define VECTOR_INLINE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "vector.h"
+
+/*
+Macros that generate specialised map, zip and reduce loops.
+
+function_like(), apply_function(), get_result() and reduce() call the
+user function through a pointer for every element, which the compiler
+can neither inline nor vectorise. The macros below instead paste the
+operation into the loop body, so the compiler sees the whole loop:
+
+    DEFINE_VECTOR_MAP(square, vector_t, double, x, x * x)
+    DEFINE_VECTOR_ZIP(hypot2, vector_t, double, a, b, a * a + b * b)
+    DEFINE_VECTOR_REDUCE(sum_abs, vector_t, double, x, fabs(x), 0.0, a, b, a + b)
+
+define static inline functions
+
+    vector_t *square(const vector_t *u);
+    vector_t *square_into(vector_t *out, const vector_t *u);
+    void square_apply(vector_t *v);
+    vector_t *hypot2(const vector_t *x, const vector_t *y);
+    vector_t *hypot2_into(vector_t *out, const vector_t *x, const vector_t *y);
+    double sum_abs(const vector_t *v);
+
+VECTOR_T can be any vector type with size and arr members and ELEM_T
+its element type. The function pointer API stays available for
+operations chosen at run time.
+
+Results of the allocating versions come from empty() when VECTOR_T is
+vector_t, so they honour arena_use() like the rest of vector.h, and from
+malloc otherwise. The _into versions reject an output that partially
+overlaps an input; the output may be the input itself.
+
+Reductions keep eight independent accumulators, lane j taking the
+elements whose index is j modulo 8, and combine them pairwise at the
+end, so COMBINE must be associative with IDENTITY as its identity.
+*/
+
+// Storage of n elements: empty() for vector_t, which may be an arena block, malloc for other types
+static inline void *vector_inline_alloc_(bool is_vector_t, size_t bytes, size_t n)
+{
+    return is_vector_t ? (void *)empty(n) : malloc(bytes);
+}
+
+#define VECTOR_INLINE_ALLOC_(VECTOR_T, BYTES, N) \
+    vector_inline_alloc_(_Generic((VECTOR_T *)NULL, vector_t *: true, default: false), (BYTES), (N))
+
+// True when the data of a and b overlap without being the same array
+#define VECTOR_INLINE_OVERLAPS_(A, B) \
+    ((A)->arr != (B)->arr && (A)->arr < (B)->arr + (B)->size && (B)->arr < (A)->arr + (A)->size)
+
+#define DEFINE_VECTOR_MAP(NAME, VECTOR_T, ELEM_T, X, EXPR)                                 \
+    static inline VECTOR_T *NAME##_into(VECTOR_T *out, const VECTOR_T *u)                  \
+    {                                                                                      \
+        if (out == NULL || u == NULL || out->size != u->size)                              \
+        {                                                                                  \
+            fprintf(stderr, "%s: Null or different size vectors\n", __func__);             \
+            return NULL;                                                                   \
+        }                                                                                  \
+        if (VECTOR_INLINE_OVERLAPS_(out, u))                                               \
+        {                                                                                  \
+            fprintf(stderr, "%s: Output partially overlaps the input\n", __func__);        \
+            return NULL;                                                                   \
+        }                                                                                  \
+        for (size_t i = 0; i < out->size; ++i)                                             \
+        {                                                                                  \
+            const ELEM_T X = u->arr[i];                                                    \
+            (void)X;                                                                       \
+            out->arr[i] = (EXPR);                                                          \
+        }                                                                                  \
+        return out;                                                                        \
+    }                                                                                      \
+                                                                                           \
+    static inline void NAME##_apply(VECTOR_T *v)                                           \
+    {                                                                                      \
+        NAME##_into(v, v);                                                                 \
+    }                                                                                      \
+                                                                                           \
+    static inline VECTOR_T *NAME(const VECTOR_T *u)                                        \
+    {                                                                                      \
+        if (u == NULL)                                                                     \
+        {                                                                                  \
+            fprintf(stderr, "%s: Null vector\n", __func__);                                \
+            return NULL;                                                                   \
+        }                                                                                  \
+        VECTOR_T *v = VECTOR_INLINE_ALLOC_(VECTOR_T,                                       \
+                                           sizeof(*v) + sizeof(ELEM_T) * u->size, u->size);\
+        if (v == NULL)                                                                     \
+        {                                                                                  \
+            fprintf(stderr, "%s: Memory allocation falied\n", __func__);                   \
+            exit(1);                                                                       \
+        }                                                                                  \
+        v->size = u->size;                                                                 \
+        return NAME##_into(v, u);                                                          \
+    }
+
+#define DEFINE_VECTOR_ZIP(NAME, VECTOR_T, ELEM_T, X, Y, EXPR)                                         \
+    static inline VECTOR_T *NAME##_into(VECTOR_T *out, const VECTOR_T *x, const VECTOR_T *y)          \
+    {                                                                                                 \
+        if (out == NULL || x == NULL || y == NULL || x->size != y->size || out->size != x->size)      \
+        {                                                                                             \
+            fprintf(stderr, "%s: Null or different size vectors\n", __func__);                        \
+            return NULL;                                                                              \
+        }                                                                                             \
+        if (VECTOR_INLINE_OVERLAPS_(out, x) || VECTOR_INLINE_OVERLAPS_(out, y))                       \
+        {                                                                                             \
+            fprintf(stderr, "%s: Output partially overlaps an input\n", __func__);                    \
+            return NULL;                                                                              \
+        }                                                                                             \
+        for (size_t i = 0; i < out->size; ++i)                                                        \
+        {                                                                                             \
+            const ELEM_T X = x->arr[i];                                                               \
+            const ELEM_T Y = y->arr[i];                                                               \
+            (void)X;                                                                                  \
+            (void)Y;                                                                                  \
+            out->arr[i] = (EXPR);                                                                     \
+        }                                                                                             \
+        return out;                                                                                   \
+    }                                                                                                 \
+                                                                                                      \
+    static inline VECTOR_T *NAME(const VECTOR_T *x, const VECTOR_T *y)                                \
+    {                                                                                                 \
+        if (x == NULL || y == NULL || x->size != y->size)                                             \
+        {                                                                                             \
+            fprintf(stderr, "%s: Null or different size vectors\n", __func__);                        \
+            return NULL;                                                                              \
+        }                                                                                             \
+        VECTOR_T *v = VECTOR_INLINE_ALLOC_(VECTOR_T, sizeof(*v) + sizeof(ELEM_T) * x->size, x->size); \
+        if (v == NULL)                                                                                \
+        {                                                                                             \
+            fprintf(stderr, "%s: Memory allocation falied\n", __func__);                              \
+            exit(1);                                                                                  \
+        }                                                                                             \
+        v->size = x->size;                                                                            \
+        return NAME##_into(v, x, y);                                                                  \
+    }
+
+#define DEFINE_VECTOR_REDUCE(NAME, VECTOR_T, ELEM_T, X, MAP, IDENTITY, A, B, COMBINE) \
+    static inline ELEM_T NAME##_combine_(ELEM_T A, ELEM_T B)                          \
+    {                                                                                 \
+        return (COMBINE);                                                             \
+    }                                                                                 \
+                                                                                      \
+    static inline ELEM_T NAME(const VECTOR_T *v)                                      \
+    {                                                                                 \
+        ELEM_T lanes[8];                                                              \
+        for (size_t k = 0; k < 8; ++k)                                                \
+            lanes[k] = (IDENTITY);                                                    \
+        if (v == NULL)                                                                \
+        {                                                                             \
+            fprintf(stderr, "%s: Null vector\n", __func__);                           \
+            return lanes[0];                                                          \
+        }                                                                             \
+        size_t i = 0;                                                                 \
+        for (; i + 8 <= v->size; i += 8)                                              \
+        {                                                                             \
+            for (size_t k = 0; k < 8; ++k)                                            \
+            {                                                                         \
+                const ELEM_T X = v->arr[i + k];                                       \
+                (void)X;                                                              \
+                lanes[k] = NAME##_combine_(lanes[k], (MAP));                          \
+            }                                                                         \
+        }                                                                             \
+        for (size_t k = 0; i < v->size; ++i, ++k)                                     \
+        {                                                                             \
+            const ELEM_T X = v->arr[i];                                               \
+            (void)X;                                                                  \
+            lanes[k] = NAME##_combine_(lanes[k], (MAP));                              \
+        }                                                                             \
+        ELEM_T s0 = NAME##_combine_(lanes[0], lanes[4]);                              \
+        ELEM_T s1 = NAME##_combine_(lanes[1], lanes[5]);                              \
+        ELEM_T s2 = NAME##_combine_(lanes[2], lanes[6]);                              \
+        ELEM_T s3 = NAME##_combine_(lanes[3], lanes[7]);                              \
+        return NAME##_combine_(NAME##_combine_(s0, s2), NAME##_combine_(s1, s3));     \
+    }
+
+#endif
@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "vector.h"
+#include "vector_io.h"
+#include "vector_arena.h"
+
+_Static_assert(sizeof(vector_file_header_t) == VECTOR_FILE_HEADER, "header must be 64 bytes");
+_Static_assert(offsetof(vector_file_header_t, length) + sizeof(uint64_t) == VECTOR_FILE_HEADER,
+               "length must directly precede the payload");
+_Static_assert(offsetof(vector_t, arr) == sizeof(uint64_t) && sizeof(size_t) == sizeof(uint64_t),
+               "vector_t must look like the length and payload of a file");
+
+// Offset of the vector_t inside a mapped file
+#define VECTOR_OFFSET (VECTOR_FILE_HEADER - offsetof(vector_t, arr))
+
+static bool little_endian(void)
+{
+    const uint16_t probe = 1;
+    return *(const unsigned char *)&probe == 1;
+}
+
+static bool valid_header(const vector_file_header_t *h, size_t file_size, const char *path, const char *caller)
+{
+    if (file_size < VECTOR_FILE_HEADER || memcmp(h->magic, VECTOR_FILE_MAGIC, sizeof(h->magic)) != 0)
+    {
+        fprintf(stderr, "%s: %s is not a vector file\n", caller, path);
+        return false;
+    }
+
+    if (h->version != VECTOR_FILE_VERSION || h->dtype != VECTOR_DTYPE_F64)
+    {
+        fprintf(stderr, "%s: %s has unsupported version %u or dtype %u\n", caller, path, h->version, h->dtype);
+        return false;
+    }
+
+    if (h->length > (file_size - VECTOR_FILE_HEADER) / sizeof(double))
+    {
+        fprintf(stderr, "%s: %s is truncated\n", caller, path);
+        return false;
+    }
+
+    return true;
+}
+
+static vector_file_header_t make_header(size_t n)
+{
+    vector_file_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, VECTOR_FILE_MAGIC, sizeof(h.magic));
+    h.version = VECTOR_FILE_VERSION;
+    h.dtype = VECTOR_DTYPE_F64;
+    h.length = n;
+    return h;
+}
+
+int vector_save(const vector_t *v, const char *path)
+{
+    if (v == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return -1;
+    }
+
+    if (!little_endian())
+    {
+        fprintf(stderr, "%s: Only little-endian hosts are supported\n", __func__);
+        return -1;
+    }
+
+    FILE *fp = fopen(path, "wb");
+    if (fp == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    vector_file_header_t h = make_header(v->size);
+    bool ok = fwrite(&h, sizeof(h), 1, fp) == 1 &&
+              fwrite(v->arr, sizeof(double), v->size, fp) == v->size;
+
+    if (fclose(fp) != 0)
+        ok = false;
+
+    if (!ok)
+    {
+        fprintf(stderr, "%s: Failed to write %s\n", __func__, path);
+        return -1;
+    }
+
+    return 0;
+}
+
+vector_t *vector_load(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        perror(path);
+        return NULL;
+    }
+
+    struct stat st;
+    vector_file_header_t h;
+
+    if (fstat(fileno(fp), &st) != 0 || fread(&h, sizeof(h), 1, fp) != 1 ||
+        !valid_header(&h, (size_t)st.st_size, path, __func__))
+    {
+        fclose(fp);
+        return NULL;
+    }
+
+    // empty() honours the active arena, so the vector goes back where it came from
+    vector_arena_t *arena = arena_active();
+    vector_t *v = empty(h.length);
+
+    if (v != NULL && fread(v->arr, sizeof(double), v->size, fp) != v->size)
+    {
+        fprintf(stderr, "%s: Failed to read %s\n", __func__, path);
+        if (arena != NULL)
+            arena_release(arena, v);
+        else
+            free_vector(v);
+        v = NULL;
+    }
+
+    fclose(fp);
+    return v;
+}
+
+static vector_t *map_file(const char *path, bool writable, const char *caller)
+{
+    if (!little_endian())
+    {
+        fprintf(stderr, "%s: Only little-endian hosts are supported\n", caller);
+        return NULL;
+    }
+
+    int fd = open(path, writable ? O_RDWR : O_RDONLY);
+    if (fd < 0)
+    {
+        perror(path);
+        return NULL;
+    }
+
+    struct stat st;
+    vector_file_header_t h;
+
+    if (fstat(fd, &st) != 0 || pread(fd, &h, sizeof(h), 0) != (ssize_t)sizeof(h) ||
+        !valid_header(&h, (size_t)st.st_size, path, caller))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    // Only the header and payload are mapped, trailing bytes are ignored
+    size_t length = VECTOR_FILE_HEADER + h.length * sizeof(double);
+    int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    unsigned char *base = mmap(NULL, length, prot, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (base == MAP_FAILED)
+    {
+        perror(path);
+        return NULL;
+    }
+
+    return (vector_t *)(base + VECTOR_OFFSET);
+}
+
+const vector_t *vector_map(const char *path)
+{
+    return map_file(path, false, __func__);
+}
+
+vector_t *vector_map_writable(const char *path)
+{
+    return map_file(path, true, __func__);
+}
+
+vector_t *vector_map_create(const char *path, size_t n)
+{
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        perror(path);
+        return NULL;
+    }
+
+    vector_file_header_t h = make_header(n);
+    bool ok = ftruncate(fd, VECTOR_FILE_HEADER + n * sizeof(double)) == 0 &&
+              pwrite(fd, &h, sizeof(h), 0) == (ssize_t)sizeof(h);
+    close(fd);
+
+    if (!ok)
+    {
+        fprintf(stderr, "%s: Failed to create %s\n", __func__, path);
+        return NULL;
+    }
+
+    return map_file(path, true, __func__);
+}
+
+static unsigned char *mapping_base(const vector_t *v)
+{
+    return (unsigned char *)v - VECTOR_OFFSET;
+}
+
+static size_t mapping_length(const vector_t *v)
+{
+    return VECTOR_FILE_HEADER + v->size * sizeof(double);
+}
+
+int vector_sync(vector_t *v)
+{
+    if (v == NULL)
+        return -1;
+
+    if (msync(mapping_base(v), mapping_length(v), MS_SYNC) != 0)
+    {
+        perror(__func__);
+        return -1;
+    }
+    return 0;
+}
+
+void vector_unmap(const vector_t *v)
+{
+    if (v == NULL)
+        return;
+
+    munmap(mapping_base(v), mapping_length(v));
+}
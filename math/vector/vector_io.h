@@ -0,0 +1,75 @@
+#ifndef VECTOR_IO_H_
+
+#define VECTOR_IO_H_
+
+#include <stdint.h>
+#include "vector.h"
+
+/*
+Binary vector files and zero-copy memory mapping.
+
+A vector file is a 64 byte little-endian header followed by the payload:
+
+    offset  size  field
+         0     8  magic "VECTORF\0"
+         8     4  format version (VECTOR_FILE_VERSION)
+        12     4  dtype (VECTOR_DTYPE_F64)
+        16    40  reserved, zero
+        56     8  length, number of elements
+        64     -  payload, length elements of dtype
+
+The length and payload are laid out exactly like a vector_t, so a mapped
+file is used in place: vector_map() returns a pointer into the mapping
+and nothing is copied or parsed. The payload starts 64 bytes into the
+file and is therefore 64 byte aligned in memory.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VECTOR_FILE_MAGIC "VECTORF"
+#define VECTOR_FILE_VERSION 1
+#define VECTOR_FILE_HEADER 64
+
+enum vector_dtype_t
+{
+    VECTOR_DTYPE_F64 = 1,
+};
+
+typedef struct vector_file_header_t
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype;
+    unsigned char reserved[40];
+    uint64_t length;
+} vector_file_header_t;
+
+// Writes v to path in the vector file format, returns 0 on success
+int vector_save(const vector_t *v, const char *path);
+
+// Reads a vector file into a new vector from empty(), and so from the active arena
+// inside arena_use(): free it with free_vector(), or arena_release() for an arena vector
+vector_t *vector_load(const char *path);
+
+// Maps a vector file read-only, returns NULL on error
+const vector_t *vector_map(const char *path);
+
+// Maps a vector file read-write; stores go straight to the file
+vector_t *vector_map_writable(const char *path);
+
+// Creates a zero filled vector file of n elements and maps it read-write
+vector_t *vector_map_create(const char *path, size_t n);
+
+// Flushes the changes to a writable mapping to disk, returns 0 on success
+int vector_sync(vector_t *v);
+
+// Unmaps a vector returned by one of the vector_map functions
+void vector_unmap(const vector_t *v);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
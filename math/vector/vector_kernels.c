@@ -0,0 +1,1099 @@
+/*
+Scalar and x86 SIMD implementations of the kernels in vector_kernels.h.
+
+The SIMD variants are compiled with per-function target attributes, so
+this file builds without any -m flags. Build it with -ffp-contract=off:
+the reductions must not have their multiply and add fused behind our
+back, or the result would depend on the selected instruction set.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdbool.h>
+#include "vector_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+// Fixed combine order shared by every reduction, whatever the vector width
+static double combine_lanes(const double lanes[KERNEL_LANES])
+{
+    double s0 = lanes[0] + lanes[4];
+    double s1 = lanes[1] + lanes[5];
+    double s2 = lanes[2] + lanes[6];
+    double s3 = lanes[3] + lanes[7];
+
+    return (s0 + s2) + (s1 + s3);
+}
+
+/* ---------------------------- Scalar ---------------------------- */
+
+static void add_scalar(size_t n, double out[], const double x[], const double y[])
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = x[i] + y[i];
+}
+
+static void sub_scalar(size_t n, double out[], const double x[], const double y[])
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = x[i] - y[i];
+}
+
+static void mul_scalar(size_t n, double out[], const double x[], const double y[])
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = x[i] * y[i];
+}
+
+static void div_scalar(size_t n, double out[], const double x[], const double y[])
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = x[i] / y[i];
+}
+
+static void fma_scalar(size_t n, double out[], const double x[], const double y[], const double z[])
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = fma(x[i], y[i], z[i]);
+}
+
+static void scale_scalar(size_t n, double out[], const double x[], double a)
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = a * x[i];
+}
+
+static void ramp_scalar(size_t n, double out[], double start, double step, size_t first)
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = start + (double)(first + i) * step;
+}
+
+static void axpy_scalar(size_t n, double y[], double a, const double x[])
+{
+    for (size_t i = 0; i < n; ++i)
+        y[i] = y[i] + a * x[i];
+}
+
+static double dot_scalar(size_t n, const double x[], const double y[])
+{
+    double lanes[KERNEL_LANES] = {0};
+
+    for (size_t i = 0; i < n; ++i)
+        lanes[i % KERNEL_LANES] += x[i] * y[i];
+
+    return combine_lanes(lanes);
+}
+
+static double sum_scalar(size_t n, const double x[])
+{
+    double lanes[KERNEL_LANES] = {0};
+
+    for (size_t i = 0; i < n; ++i)
+        lanes[i % KERNEL_LANES] += x[i];
+
+    return combine_lanes(lanes);
+}
+
+/*
+Rows shorter than KERNEL_LANES, with a copy of the loops for each width so
+they unroll and the sums stay in registers. Each row's dot product is
+summed left to right, the transposed product gives the same bits as one
+axpy_scalar() per row.
+*/
+#define GEMV_NARROW(COLS)                                                                           \
+    static void gemv_narrow_##COLS(size_t rows, double out[], const double a[], const double x[])   \
+    {                                                                                               \
+        for (size_t r = 0; r < rows; ++r, a += COLS)                                                \
+        {                                                                                           \
+            double dot = a[0] * x[0];                                                               \
+            _Pragma("GCC unroll 8")                                                                 \
+            for (size_t j = 1; j < COLS; ++j)                                                       \
+                dot += a[j] * x[j];                                                                 \
+            out[r] = dot;                                                                           \
+        }                                                                                           \
+    }                                                                                               \
+                                                                                                    \
+    static void gemv_t_narrow_##COLS(size_t rows, double out[], const double a[], const double x[]) \
+    {                                                                                               \
+        double sums[COLS];                                                                          \
+        for (size_t j = 0; j < COLS; ++j)                                                           \
+            sums[j] = out[j];                                                                       \
+        for (size_t r = 0; r < rows; ++r, a += COLS)                                                \
+            _Pragma("GCC unroll 8")                                                                 \
+            for (size_t j = 0; j < COLS; ++j)                                                       \
+                sums[j] = sums[j] + x[r] * a[j];                                                    \
+        for (size_t j = 0; j < COLS; ++j)                                                           \
+            out[j] = sums[j];                                                                       \
+    }
+
+GEMV_NARROW(1)
+GEMV_NARROW(2)
+GEMV_NARROW(3)
+GEMV_NARROW(4)
+GEMV_NARROW(5)
+GEMV_NARROW(6)
+GEMV_NARROW(7)
+
+#undef GEMV_NARROW
+
+// Returns false when cols is not narrow
+static bool gemv_narrow(size_t rows, size_t cols, double out[], const double a[], const double x[], bool transpose)
+{
+    switch (cols)
+    {
+#define GEMV_NARROW_CASE(COLS)                                                    \
+    case COLS:                                                                    \
+        (transpose ? gemv_t_narrow_##COLS : gemv_narrow_##COLS)(rows, out, a, x); \
+        return true;
+        GEMV_NARROW_CASE(1)
+        GEMV_NARROW_CASE(2)
+        GEMV_NARROW_CASE(3)
+        GEMV_NARROW_CASE(4)
+        GEMV_NARROW_CASE(5)
+        GEMV_NARROW_CASE(6)
+        GEMV_NARROW_CASE(7)
+#undef GEMV_NARROW_CASE
+    default:
+        return false;
+    }
+}
+
+static void gemv_scalar(size_t rows, size_t cols, double out[], const double a[], const double x[])
+{
+    if (gemv_narrow(rows, cols, out, a, x, false))
+        return;
+
+    for (size_t r = 0; r < rows; ++r)
+        out[r] = dot_scalar(cols, a + r * cols, x);
+}
+
+static void gemv_t_scalar(size_t rows, size_t cols, double out[], const double a[], const double x[])
+{
+    if (gemv_narrow(rows, cols, out, a, x, true))
+        return;
+
+    for (size_t r = 0; r < rows; ++r)
+        axpy_scalar(cols, out, x[r], a + r * cols);
+}
+
+static void sum_compensated_scalar(size_t n, const double x[], double sums[], double comps[])
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        // Knuth's TwoSum, the exact error of s without comparing magnitudes
+        const size_t j = i % KERNEL_LANES;
+        const double a = sums[j], s = a + x[i], b = s - a;
+        comps[j] += (a - (s - b)) + (x[i] - b);
+        sums[j] = s;
+    }
+}
+
+static double absmax_scalar(size_t n, const double x[])
+{
+    double m = 0.0;
+
+    for (size_t i = 0; i < n; ++i)
+        if (fabs(x[i]) > m)
+            m = fabs(x[i]);
+
+    return m;
+}
+
+static void bin_scalar(size_t n, const double x[], const double split[KERNEL_BINS], double bins[KERNEL_BINS])
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        double r = x[i];
+        for (size_t k = 0; k < KERNEL_BINS; ++k)
+        {
+            double q = (split[k] + r) - split[k];
+            r -= q;
+            bins[k] += q;
+        }
+    }
+}
+
+static void gradient_interior_scalar(size_t n, double out[], const double y[], const double x[])
+{
+    for (size_t i = 1; i + 1 < n; ++i)
+        out[i] = (y[i + 1] - y[i - 1]) / (x[i + 1] - x[i - 1]);
+}
+
+static void trapz_lanes_scalar(size_t n, const double y[], const double x[], double lanes[])
+{
+    for (size_t i = 0; i + 1 < n; ++i)
+        lanes[i % KERNEL_LANES] += (y[i] + y[i + 1]) * (x[i + 1] - x[i]);
+}
+
+static void add_f32_scalar(size_t n, float out[], const float x[], const float y[])
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = x[i] + y[i];
+}
+
+static void sub_f32_scalar(size_t n, float out[], const float x[], const float y[])
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = x[i] - y[i];
+}
+
+static void mul_f32_scalar(size_t n, float out[], const float x[], const float y[])
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = x[i] * y[i];
+}
+
+static void div_f32_scalar(size_t n, float out[], const float x[], const float y[])
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = x[i] / y[i];
+}
+
+static void fma_f32_scalar(size_t n, float out[], const float x[], const float y[], const float z[])
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = fmaf(x[i], y[i], z[i]);
+}
+
+static void scale_f32_scalar(size_t n, float out[], const float x[], float a)
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = a * x[i];
+}
+
+static void axpy_f32_scalar(size_t n, float y[], float a, const float x[])
+{
+    for (size_t i = 0; i < n; ++i)
+        y[i] = y[i] + a * x[i];
+}
+
+// Products of two floats are exact in double, so only the sums round
+static double dot_f32_scalar(size_t n, const float x[], const float y[])
+{
+    double lanes[KERNEL_LANES] = {0};
+
+    for (size_t i = 0; i < n; ++i)
+        lanes[i % KERNEL_LANES] += (double)x[i] * (double)y[i];
+
+    return combine_lanes(lanes);
+}
+
+static double sum_f32_scalar(size_t n, const float x[])
+{
+    double lanes[KERNEL_LANES] = {0};
+
+    for (size_t i = 0; i < n; ++i)
+        lanes[i % KERNEL_LANES] += x[i];
+
+    return combine_lanes(lanes);
+}
+
+static void f32_to_f64_scalar(size_t n, double out[], const float x[])
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = x[i];
+}
+
+static void f64_to_f32_scalar(size_t n, float out[], const double x[])
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = (float)x[i];
+}
+
+#ifdef KERNELS_X86
+
+// Lane offsets of ramp(), the indices stay exact integers in double below 2^53
+static const double ramp_offsets[KERNEL_LANES] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+/*
+The three SIMD families are generated from one template. Each
+instantiation supplies the vector type, its width in doubles and the
+load/store/arithmetic intrinsics. Reductions keep KERNEL_LANES / WIDTH
+accumulators so the lane layout is the same for every width.
+*/
+#define DEFINE_SIMD_KERNELS(SUFFIX, TARGET, VEC, WIDTH, LOAD, STORE, SET1, ZERO, ADD, SUB, MUL, DIV, FMA, MAX)  \
+    __attribute__((target(TARGET))) static void add_##SUFFIX(size_t n, double out[], const double x[],         \
+                                                            const double y[])                                  \
+    {                                                                                                           \
+        size_t i = 0;                                                                                           \
+        for (; i + WIDTH <= n; i += WIDTH)                                                                      \
+            STORE(out + i, ADD(LOAD(x + i), LOAD(y + i)));                                                      \
+        add_scalar(n - i, out + i, x + i, y + i);                                                               \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static void sub_##SUFFIX(size_t n, double out[], const double x[],         \
+                                                            const double y[])                                  \
+    {                                                                                                           \
+        size_t i = 0;                                                                                           \
+        for (; i + WIDTH <= n; i += WIDTH)                                                                      \
+            STORE(out + i, SUB(LOAD(x + i), LOAD(y + i)));                                                      \
+        sub_scalar(n - i, out + i, x + i, y + i);                                                               \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static void mul_##SUFFIX(size_t n, double out[], const double x[],         \
+                                                            const double y[])                                  \
+    {                                                                                                           \
+        size_t i = 0;                                                                                           \
+        for (; i + WIDTH <= n; i += WIDTH)                                                                      \
+            STORE(out + i, MUL(LOAD(x + i), LOAD(y + i)));                                                      \
+        mul_scalar(n - i, out + i, x + i, y + i);                                                               \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static void div_##SUFFIX(size_t n, double out[], const double x[],         \
+                                                            const double y[])                                  \
+    {                                                                                                           \
+        size_t i = 0;                                                                                           \
+        for (; i + WIDTH <= n; i += WIDTH)                                                                      \
+            STORE(out + i, DIV(LOAD(x + i), LOAD(y + i)));                                                      \
+        div_scalar(n - i, out + i, x + i, y + i);                                                               \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static void fma_##SUFFIX(size_t n, double out[], const double x[],         \
+                                                            const double y[], const double z[])                \
+    {                                                                                                           \
+        size_t i = 0;                                                                                           \
+        for (; i + WIDTH <= n; i += WIDTH)                                                                      \
+            STORE(out + i, FMA(LOAD(x + i), LOAD(y + i), LOAD(z + i)));                                         \
+        fma_scalar(n - i, out + i, x + i, y + i, z + i);                                                        \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static void scale_##SUFFIX(size_t n, double out[], const double x[],       \
+                                                              double a)                                        \
+    {                                                                                                           \
+        const VEC va = SET1(a);                                                                                 \
+        size_t i = 0;                                                                                           \
+        for (; i + WIDTH <= n; i += WIDTH)                                                                      \
+            STORE(out + i, MUL(va, LOAD(x + i)));                                                               \
+        scale_scalar(n - i, out + i, x + i, a);                                                                 \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static void ramp_##SUFFIX(size_t n, double out[], double start,             \
+                                                             double step, size_t first)                         \
+    {                                                                                                           \
+        const VEC vstart = SET1(start), vstep = SET1(step), width = SET1((double)WIDTH);                        \
+        VEC index = ADD(SET1((double)first), LOAD(ramp_offsets));                                               \
+        size_t i = 0;                                                                                           \
+        for (; i + WIDTH <= n; i += WIDTH, index = ADD(index, width))                                           \
+            STORE(out + i, ADD(vstart, MUL(index, vstep)));                                                     \
+        ramp_scalar(n - i, out + i, start, step, first + i);                                                    \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static void axpy_##SUFFIX(size_t n, double y[], double a, const double x[]) \
+    {                                                                                                           \
+        const VEC va = SET1(a);                                                                                 \
+        size_t i = 0;                                                                                           \
+        for (; i + WIDTH <= n; i += WIDTH)                                                                      \
+            STORE(y + i, ADD(LOAD(y + i), MUL(va, LOAD(x + i))));                                               \
+        axpy_scalar(n - i, y + i, a, x + i);                                                                    \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static double dot_##SUFFIX(size_t n, const double x[], const double y[])   \
+    {                                                                                                           \
+        VEC acc[KERNEL_LANES / WIDTH];                                                                          \
+        for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                       \
+            acc[k] = ZERO();                                                                                    \
+                                                                                                                \
+        size_t i = 0;                                                                                           \
+        for (; i + KERNEL_LANES <= n; i += KERNEL_LANES)                                                        \
+            for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                   \
+                acc[k] = ADD(acc[k], MUL(LOAD(x + i + k * WIDTH), LOAD(y + i + k * WIDTH)));                    \
+                                                                                                                \
+        double lanes[KERNEL_LANES];                                                                             \
+        for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                       \
+            STORE(lanes + k * WIDTH, acc[k]);                                                                   \
+        for (size_t j = 0; i < n; ++i, ++j)                                                                     \
+            lanes[j] += x[i] * y[i];                                                                            \
+                                                                                                                \
+        return combine_lanes(lanes);                                                                            \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static double sum_##SUFFIX(size_t n, const double x[])                     \
+    {                                                                                                           \
+        VEC acc[KERNEL_LANES / WIDTH];                                                                          \
+        for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                       \
+            acc[k] = ZERO();                                                                                    \
+                                                                                                                \
+        size_t i = 0;                                                                                           \
+        for (; i + KERNEL_LANES <= n; i += KERNEL_LANES)                                                        \
+            for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                   \
+                acc[k] = ADD(acc[k], LOAD(x + i + k * WIDTH));                                                  \
+                                                                                                                \
+        double lanes[KERNEL_LANES];                                                                             \
+        for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                       \
+            STORE(lanes + k * WIDTH, acc[k]);                                                                   \
+        for (size_t j = 0; i < n; ++i, ++j)                                                                     \
+            lanes[j] += x[i];                                                                                   \
+                                                                                                                \
+        return combine_lanes(lanes);                                                                            \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static void gemv_##SUFFIX(size_t rows, size_t cols, double out[],           \
+                                                             const double a[], const double x[])                \
+    {                                                                                                           \
+        if (gemv_narrow(rows, cols, out, a, x, false))                                                          \
+            return;                                                                                             \
+        for (size_t r = 0; r < rows; ++r)                                                                       \
+            out[r] = dot_##SUFFIX(cols, a + r * cols, x);                                                       \
+    }                                                                                                           \
+                                                                                                                \
+    /* Four rows per sweep so out is loaded and stored once for every four, same bits as one axpy per row */    \
+    __attribute__((target(TARGET))) static void gemv_t_##SUFFIX(size_t rows, size_t cols, double out[],         \
+                                                               const double a[], const double x[])              \
+    {                                                                                                           \
+        if (gemv_narrow(rows, cols, out, a, x, true))                                                           \
+            return;                                                                                             \
+        size_t r = 0;                                                                                           \
+        for (; r + 4 <= rows; r += 4)                                                                           \
+        {                                                                                                       \
+            const double *a0 = a + r * cols, *a1 = a0 + cols, *a2 = a1 + cols, *a3 = a2 + cols;                 \
+            const VEC x0 = SET1(x[r]), x1 = SET1(x[r + 1]), x2 = SET1(x[r + 2]), x3 = SET1(x[r + 3]);           \
+            size_t j = 0;                                                                                       \
+            for (; j + WIDTH <= cols; j += WIDTH)                                                               \
+            {                                                                                                   \
+                VEC acc = ADD(LOAD(out + j), MUL(x0, LOAD(a0 + j)));                                            \
+                acc = ADD(acc, MUL(x1, LOAD(a1 + j)));                                                          \
+                acc = ADD(acc, MUL(x2, LOAD(a2 + j)));                                                          \
+                STORE(out + j, ADD(acc, MUL(x3, LOAD(a3 + j))));                                                \
+            }                                                                                                   \
+            for (; j < cols; ++j)                                                                               \
+                out[j] = out[j] + x[r] * a0[j] + x[r + 1] * a1[j] + x[r + 2] * a2[j] + x[r + 3] * a3[j];        \
+        }                                                                                                       \
+        for (; r < rows; ++r)                                                                                   \
+            axpy_##SUFFIX(cols, out, x[r], a + r * cols);                                                       \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static void sum_compensated_##SUFFIX(size_t n, const double x[],          \
+                                                                        double sums[], double comps[])         \
+    {                                                                                                           \
+        VEC s[KERNEL_LANES / WIDTH], c[KERNEL_LANES / WIDTH];                                                   \
+        for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                       \
+        {                                                                                                       \
+            s[k] = LOAD(sums + k * WIDTH);                                                                      \
+            c[k] = LOAD(comps + k * WIDTH);                                                                     \
+        }                                                                                                       \
+                                                                                                                \
+        size_t i = 0;                                                                                           \
+        for (; i + KERNEL_LANES <= n; i += KERNEL_LANES)                                                        \
+            for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                   \
+            {                                                                                                   \
+                VEC v = LOAD(x + i + k * WIDTH), t = ADD(s[k], v), b = SUB(t, s[k]);                            \
+                c[k] = ADD(c[k], ADD(SUB(s[k], SUB(t, b)), SUB(v, b)));                                         \
+                s[k] = t;                                                                                       \
+            }                                                                                                   \
+                                                                                                                \
+        for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                       \
+        {                                                                                                       \
+            STORE(sums + k * WIDTH, s[k]);                                                                      \
+            STORE(comps + k * WIDTH, c[k]);                                                                     \
+        }                                                                                                       \
+        sum_compensated_scalar(n - i, x + i, sums, comps);                                                      \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static double absmax_##SUFFIX(size_t n, const double x[])                  \
+    {                                                                                                           \
+        VEC acc[KERNEL_LANES / WIDTH];                                                                          \
+        for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                       \
+            acc[k] = ZERO();                                                                                    \
+                                                                                                                \
+        size_t i = 0;                                                                                           \
+        for (; i + KERNEL_LANES <= n; i += KERNEL_LANES)                                                        \
+            for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                   \
+            {                                                                                                   \
+                VEC v = LOAD(x + i + k * WIDTH);                                                                \
+                acc[k] = MAX(MAX(v, SUB(ZERO(), v)), acc[k]);                                                   \
+            }                                                                                                   \
+                                                                                                                \
+        double lanes[KERNEL_LANES];                                                                             \
+        for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                       \
+            STORE(lanes + k * WIDTH, acc[k]);                                                                   \
+                                                                                                                \
+        double m = absmax_scalar(n - i, x + i);                                                                 \
+        for (size_t j = 0; j < KERNEL_LANES; ++j)                                                               \
+            if (lanes[j] > m)                                                                                   \
+                m = lanes[j];                                                                                   \
+        return m;                                                                                               \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static void bin_##SUFFIX(size_t n, const double x[],                       \
+                                                            const double split[KERNEL_BINS],                   \
+                                                            double bins[KERNEL_BINS])                          \
+    {                                                                                                           \
+        VEC s[KERNEL_BINS], acc[KERNEL_BINS][KERNEL_LANES / WIDTH];                                             \
+        for (size_t b = 0; b < KERNEL_BINS; ++b)                                                                \
+        {                                                                                                       \
+            s[b] = SET1(split[b]);                                                                              \
+            for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                   \
+                acc[b][k] = ZERO();                                                                             \
+        }                                                                                                       \
+                                                                                                                \
+        size_t i = 0;                                                                                           \
+        for (; i + KERNEL_LANES <= n; i += KERNEL_LANES)                                                        \
+            for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                   \
+            {                                                                                                   \
+                VEC r = LOAD(x + i + k * WIDTH);                                                                \
+                for (size_t b = 0; b < KERNEL_BINS; ++b)                                                        \
+                {                                                                                               \
+                    VEC q = SUB(ADD(s[b], r), s[b]);                                                            \
+                    r = SUB(r, q);                                                                              \
+                    acc[b][k] = ADD(acc[b][k], q);                                                              \
+                }                                                                                               \
+            }                                                                                                   \
+                                                                                                                \
+        double lanes[KERNEL_LANES];                                                                             \
+        for (size_t b = 0; b < KERNEL_BINS; ++b)                                                                \
+        {                                                                                                       \
+            for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                   \
+                STORE(lanes + k * WIDTH, acc[b][k]);                                                            \
+            for (size_t j = 0; j < KERNEL_LANES; ++j)                                                           \
+                bins[b] += lanes[j];                                                                            \
+        }                                                                                                       \
+        bin_scalar(n - i, x + i, split, bins);                                                                  \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static void gradient_interior_##SUFFIX(size_t n, double out[],             \
+                                                                          const double y[], const double x[])  \
+    {                                                                                                           \
+        if (n < 3)                                                                                              \
+            return;                                                                                             \
+                                                                                                                \
+        size_t i = 1;                                                                                           \
+        for (; i + WIDTH + 1 <= n; i += WIDTH)                                                                  \
+        {                                                                                                       \
+            VEC dy = SUB(LOAD(y + i + 1), LOAD(y + i - 1));                                                     \
+            VEC dx = SUB(LOAD(x + i + 1), LOAD(x + i - 1));                                                     \
+            STORE(out + i, DIV(dy, dx));                                                                        \
+        }                                                                                                       \
+        for (; i + 1 < n; ++i)                                                                                  \
+            out[i] = (y[i + 1] - y[i - 1]) / (x[i + 1] - x[i - 1]);                                             \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static void trapz_lanes_##SUFFIX(size_t n, const double y[],              \
+                                                                    const double x[], double lanes[])          \
+    {                                                                                                           \
+        if (n < 2)                                                                                              \
+            return;                                                                                             \
+                                                                                                                \
+        VEC acc[KERNEL_LANES / WIDTH];                                                                          \
+        for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                       \
+            acc[k] = LOAD(lanes + k * WIDTH);                                                                   \
+                                                                                                                \
+        const size_t m = n - 1;                                                                                 \
+        size_t i = 0;                                                                                           \
+        for (; i + KERNEL_LANES <= m; i += KERNEL_LANES)                                                        \
+            for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                   \
+            {                                                                                                   \
+                const size_t j = i + k * WIDTH;                                                                 \
+                VEC ys = ADD(LOAD(y + j), LOAD(y + j + 1));                                                     \
+                VEC h = SUB(LOAD(x + j + 1), LOAD(x + j));                                                      \
+                acc[k] = ADD(acc[k], MUL(ys, h));                                                               \
+            }                                                                                                   \
+                                                                                                                \
+        for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                       \
+            STORE(lanes + k * WIDTH, acc[k]);                                                                   \
+        for (size_t j = 0; i < m; ++i, ++j)                                                                     \
+            lanes[j] += (y[i] + y[i + 1]) * (x[i + 1] - x[i]);                                                  \
+    }
+
+/*
+The float32 kernels, generated the same way. Element-wise kernels work
+on FWIDTH floats at a time, twice the lanes of the double kernels.
+Reductions widen WIDTH floats at a time with LOAD_WIDE and accumulate in
+the KERNEL_LANES double lanes the double kernels use, so they match the
+scalar float32 kernels bit for bit and lose no precision to float sums.
+*/
+#define DEFINE_SIMD_KERNELS_F32(SUFFIX, TARGET, FVEC, FWIDTH, FLOAD, FSTORE, FSET1, FADD, FSUB, FMUL, FDIV,     \
+                                FFMA, VEC, WIDTH, LOAD, STORE, ZERO, ADD, MUL, LOAD_WIDE, STORE_NARROW)         \
+    __attribute__((target(TARGET))) static void add_f32_##SUFFIX(size_t n, float out[], const float x[],        \
+                                                                 const float y[])                               \
+    {                                                                                                           \
+        size_t i = 0;                                                                                           \
+        for (; i + FWIDTH <= n; i += FWIDTH)                                                                    \
+            FSTORE(out + i, FADD(FLOAD(x + i), FLOAD(y + i)));                                                  \
+        add_f32_scalar(n - i, out + i, x + i, y + i);                                                           \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static void sub_f32_##SUFFIX(size_t n, float out[], const float x[],        \
+                                                                 const float y[])                               \
+    {                                                                                                           \
+        size_t i = 0;                                                                                           \
+        for (; i + FWIDTH <= n; i += FWIDTH)                                                                    \
+            FSTORE(out + i, FSUB(FLOAD(x + i), FLOAD(y + i)));                                                  \
+        sub_f32_scalar(n - i, out + i, x + i, y + i);                                                           \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static void mul_f32_##SUFFIX(size_t n, float out[], const float x[],        \
+                                                                 const float y[])                               \
+    {                                                                                                           \
+        size_t i = 0;                                                                                           \
+        for (; i + FWIDTH <= n; i += FWIDTH)                                                                    \
+            FSTORE(out + i, FMUL(FLOAD(x + i), FLOAD(y + i)));                                                  \
+        mul_f32_scalar(n - i, out + i, x + i, y + i);                                                           \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static void div_f32_##SUFFIX(size_t n, float out[], const float x[],        \
+                                                                 const float y[])                               \
+    {                                                                                                           \
+        size_t i = 0;                                                                                           \
+        for (; i + FWIDTH <= n; i += FWIDTH)                                                                    \
+            FSTORE(out + i, FDIV(FLOAD(x + i), FLOAD(y + i)));                                                  \
+        div_f32_scalar(n - i, out + i, x + i, y + i);                                                           \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static void fma_f32_##SUFFIX(size_t n, float out[], const float x[],        \
+                                                                 const float y[], const float z[])              \
+    {                                                                                                           \
+        size_t i = 0;                                                                                           \
+        for (; i + FWIDTH <= n; i += FWIDTH)                                                                    \
+            FSTORE(out + i, FFMA(FLOAD(x + i), FLOAD(y + i), FLOAD(z + i)));                                    \
+        fma_f32_scalar(n - i, out + i, x + i, y + i, z + i);                                                    \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static void scale_f32_##SUFFIX(size_t n, float out[], const float x[],      \
+                                                                   float a)                                     \
+    {                                                                                                           \
+        const FVEC va = FSET1(a);                                                                               \
+        size_t i = 0;                                                                                           \
+        for (; i + FWIDTH <= n; i += FWIDTH)                                                                    \
+            FSTORE(out + i, FMUL(va, FLOAD(x + i)));                                                            \
+        scale_f32_scalar(n - i, out + i, x + i, a);                                                             \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static void axpy_f32_##SUFFIX(size_t n, float y[], float a,                 \
+                                                                  const float x[])                              \
+    {                                                                                                           \
+        const FVEC va = FSET1(a);                                                                               \
+        size_t i = 0;                                                                                           \
+        for (; i + FWIDTH <= n; i += FWIDTH)                                                                    \
+            FSTORE(y + i, FADD(FLOAD(y + i), FMUL(va, FLOAD(x + i))));                                          \
+        axpy_f32_scalar(n - i, y + i, a, x + i);                                                                \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static double dot_f32_##SUFFIX(size_t n, const float x[], const float y[])  \
+    {                                                                                                           \
+        VEC acc[KERNEL_LANES / WIDTH];                                                                          \
+        for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                       \
+            acc[k] = ZERO();                                                                                    \
+                                                                                                                \
+        size_t i = 0;                                                                                           \
+        for (; i + KERNEL_LANES <= n; i += KERNEL_LANES)                                                        \
+            for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                   \
+                acc[k] = ADD(acc[k], MUL(LOAD_WIDE(x + i + k * WIDTH), LOAD_WIDE(y + i + k * WIDTH)));          \
+                                                                                                                \
+        double lanes[KERNEL_LANES];                                                                             \
+        for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                       \
+            STORE(lanes + k * WIDTH, acc[k]);                                                                   \
+        for (size_t j = 0; i < n; ++i, ++j)                                                                     \
+            lanes[j] += (double)x[i] * (double)y[i];                                                            \
+                                                                                                                \
+        return combine_lanes(lanes);                                                                            \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static double sum_f32_##SUFFIX(size_t n, const float x[])                   \
+    {                                                                                                           \
+        VEC acc[KERNEL_LANES / WIDTH];                                                                          \
+        for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                       \
+            acc[k] = ZERO();                                                                                    \
+                                                                                                                \
+        size_t i = 0;                                                                                           \
+        for (; i + KERNEL_LANES <= n; i += KERNEL_LANES)                                                        \
+            for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                   \
+                acc[k] = ADD(acc[k], LOAD_WIDE(x + i + k * WIDTH));                                             \
+                                                                                                                \
+        double lanes[KERNEL_LANES];                                                                             \
+        for (size_t k = 0; k < KERNEL_LANES / WIDTH; ++k)                                                       \
+            STORE(lanes + k * WIDTH, acc[k]);                                                                   \
+        for (size_t j = 0; i < n; ++i, ++j)                                                                     \
+            lanes[j] += x[i];                                                                                   \
+                                                                                                                \
+        return combine_lanes(lanes);                                                                            \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static void f32_to_f64_##SUFFIX(size_t n, double out[], const float x[])    \
+    {                                                                                                           \
+        size_t i = 0;                                                                                           \
+        for (; i + WIDTH <= n; i += WIDTH)                                                                      \
+            STORE(out + i, LOAD_WIDE(x + i));                                                                   \
+        f32_to_f64_scalar(n - i, out + i, x + i);                                                               \
+    }                                                                                                           \
+                                                                                                                \
+    __attribute__((target(TARGET))) static void f64_to_f32_##SUFFIX(size_t n, float out[], const double x[])    \
+    {                                                                                                           \
+        size_t i = 0;                                                                                           \
+        for (; i + WIDTH <= n; i += WIDTH)                                                                      \
+            STORE_NARROW(out + i, LOAD(x + i));                                                                 \
+        f64_to_f32_scalar(n - i, out + i, x + i);                                                               \
+    }
+
+// SSE2 has no fused multiply-add, so emulate it with libm's fma()
+__attribute__((target("sse2"))) static __m128d fma_sse2_emulated(__m128d a, __m128d b, __m128d c)
+{
+    double va[2], vb[2], vc[2];
+    _mm_storeu_pd(va, a);
+    _mm_storeu_pd(vb, b);
+    _mm_storeu_pd(vc, c);
+    va[0] = fma(va[0], vb[0], vc[0]);
+    va[1] = fma(va[1], vb[1], vc[1]);
+    return _mm_loadu_pd(va);
+}
+
+DEFINE_SIMD_KERNELS(sse2, "sse2", __m128d, 2,
+                    _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd, _mm_setzero_pd,
+                    _mm_add_pd, _mm_sub_pd, _mm_mul_pd, _mm_div_pd, fma_sse2_emulated, _mm_max_pd)
+
+DEFINE_SIMD_KERNELS(avx2, "avx2,fma", __m256d, 4,
+                    _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd, _mm256_setzero_pd,
+                    _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd, _mm256_div_pd, _mm256_fmadd_pd, _mm256_max_pd)
+
+DEFINE_SIMD_KERNELS(avx512, "avx512f", __m512d, 8,
+                    _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd, _mm512_setzero_pd,
+                    _mm512_add_pd, _mm512_sub_pd, _mm512_mul_pd, _mm512_div_pd, _mm512_fmadd_pd, _mm512_max_pd)
+
+// SSE2 widens and narrows two floats at a time through the low half of a register
+__attribute__((target("sse2"))) static __m128d load_f32_sse2(const float *p)
+{
+    return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i *)p)));
+}
+
+__attribute__((target("sse2"))) static void store_f32_sse2(float *p, __m128d v)
+{
+    _mm_storel_epi64((__m128i *)p, _mm_castps_si128(_mm_cvtpd_ps(v)));
+}
+
+__attribute__((target("sse2"))) static __m128 fma_f32_sse2_emulated(__m128 a, __m128 b, __m128 c)
+{
+    float va[4], vb[4], vc[4];
+    _mm_storeu_ps(va, a);
+    _mm_storeu_ps(vb, b);
+    _mm_storeu_ps(vc, c);
+    for (int k = 0; k < 4; ++k)
+        va[k] = fmaf(va[k], vb[k], vc[k]);
+    return _mm_loadu_ps(va);
+}
+
+__attribute__((target("avx2,fma"))) static __m256d load_f32_avx2(const float *p)
+{
+    return _mm256_cvtps_pd(_mm_loadu_ps(p));
+}
+
+__attribute__((target("avx2,fma"))) static void store_f32_avx2(float *p, __m256d v)
+{
+    _mm_storeu_ps(p, _mm256_cvtpd_ps(v));
+}
+
+__attribute__((target("avx512f"))) static __m512d load_f32_avx512(const float *p)
+{
+    return _mm512_cvtps_pd(_mm256_loadu_ps(p));
+}
+
+__attribute__((target("avx512f"))) static void store_f32_avx512(float *p, __m512d v)
+{
+    _mm256_storeu_ps(p, _mm512_cvtpd_ps(v));
+}
+
+DEFINE_SIMD_KERNELS_F32(sse2, "sse2", __m128, 4, _mm_loadu_ps, _mm_storeu_ps, _mm_set1_ps,
+                        _mm_add_ps, _mm_sub_ps, _mm_mul_ps, _mm_div_ps, fma_f32_sse2_emulated,
+                        __m128d, 2, _mm_loadu_pd, _mm_storeu_pd, _mm_setzero_pd, _mm_add_pd, _mm_mul_pd,
+                        load_f32_sse2, store_f32_sse2)
+
+DEFINE_SIMD_KERNELS_F32(avx2, "avx2,fma", __m256, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps,
+                        _mm256_add_ps, _mm256_sub_ps, _mm256_mul_ps, _mm256_div_ps, _mm256_fmadd_ps,
+                        __m256d, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_setzero_pd, _mm256_add_pd,
+                        _mm256_mul_pd, load_f32_avx2, store_f32_avx2)
+
+DEFINE_SIMD_KERNELS_F32(avx512, "avx512f", __m512, 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_set1_ps,
+                        _mm512_add_ps, _mm512_sub_ps, _mm512_mul_ps, _mm512_div_ps, _mm512_fmadd_ps,
+                        __m512d, 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_setzero_pd, _mm512_add_pd,
+                        _mm512_mul_pd, load_f32_avx512, store_f32_avx512)
+
+#endif
+
+/* --------------------------- Dispatch --------------------------- */
+
+typedef struct kernel_table_t
+{
+    kernel_isa_t isa;
+    void (*add)(size_t, double[], const double[], const double[]);
+    void (*sub)(size_t, double[], const double[], const double[]);
+    void (*mul)(size_t, double[], const double[], const double[]);
+    void (*div)(size_t, double[], const double[], const double[]);
+    void (*fma)(size_t, double[], const double[], const double[], const double[]);
+    void (*scale)(size_t, double[], const double[], double);
+    void (*ramp)(size_t, double[], double, double, size_t);
+    void (*axpy)(size_t, double[], double, const double[]);
+    double (*dot)(size_t, const double[], const double[]);
+    double (*sum)(size_t, const double[]);
+    void (*gemv)(size_t, size_t, double[], const double[], const double[]);
+    void (*gemv_t)(size_t, size_t, double[], const double[], const double[]);
+    void (*sum_compensated)(size_t, const double[], double[], double[]);
+    double (*absmax)(size_t, const double[]);
+    void (*bin)(size_t, const double[], const double[], double[]);
+    void (*gradient_interior)(size_t, double[], const double[], const double[]);
+    void (*trapz_lanes)(size_t, const double[], const double[], double[]);
+    void (*add_f32)(size_t, float[], const float[], const float[]);
+    void (*sub_f32)(size_t, float[], const float[], const float[]);
+    void (*mul_f32)(size_t, float[], const float[], const float[]);
+    void (*div_f32)(size_t, float[], const float[], const float[]);
+    void (*fma_f32)(size_t, float[], const float[], const float[], const float[]);
+    void (*scale_f32)(size_t, float[], const float[], float);
+    void (*axpy_f32)(size_t, float[], float, const float[]);
+    double (*dot_f32)(size_t, const float[], const float[]);
+    double (*sum_f32)(size_t, const float[]);
+    void (*f32_to_f64)(size_t, double[], const float[]);
+    void (*f64_to_f32)(size_t, float[], const double[]);
+} kernel_table_t;
+
+#define KERNEL_TABLE(ISA, SUFFIX)                                                              \
+    {                                                                                          \
+        ISA, add_##SUFFIX, sub_##SUFFIX, mul_##SUFFIX, div_##SUFFIX, fma_##SUFFIX,             \
+            scale_##SUFFIX, ramp_##SUFFIX, axpy_##SUFFIX, dot_##SUFFIX, sum_##SUFFIX,          \
+            gemv_##SUFFIX, gemv_t_##SUFFIX,                                                    \
+            sum_compensated_##SUFFIX, absmax_##SUFFIX, bin_##SUFFIX,                           \
+            gradient_interior_##SUFFIX, trapz_lanes_##SUFFIX,                                  \
+            add_f32_##SUFFIX, sub_f32_##SUFFIX, mul_f32_##SUFFIX, div_f32_##SUFFIX,            \
+            fma_f32_##SUFFIX, scale_f32_##SUFFIX, axpy_f32_##SUFFIX, dot_f32_##SUFFIX,         \
+            sum_f32_##SUFFIX, f32_to_f64_##SUFFIX, f64_to_f32_##SUFFIX                         \
+    }
+
+static const kernel_table_t tables[] = {
+    KERNEL_TABLE(ISA_SCALAR, scalar),
+#ifdef KERNELS_X86
+    KERNEL_TABLE(ISA_SSE2, sse2),
+    KERNEL_TABLE(ISA_AVX2, avx2),
+    KERNEL_TABLE(ISA_AVX512, avx512),
+#endif
+};
+
+static const kernel_table_t *kernels = &tables[0];
+
+static int isa_supported(kernel_isa_t isa)
+{
+#ifdef KERNELS_X86
+    __builtin_cpu_init();
+    switch (isa)
+    {
+    case ISA_SCALAR:
+        return 1;
+    case ISA_SSE2:
+        return __builtin_cpu_supports("sse2");
+    case ISA_AVX2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case ISA_AVX512:
+        return __builtin_cpu_supports("avx512f");
+    }
+    return 0;
+#else
+    return isa == ISA_SCALAR;
+#endif
+}
+
+kernel_isa_t kernel_isa(void)
+{
+    return kernels->isa;
+}
+
+const char *kernel_isa_name(kernel_isa_t isa)
+{
+    switch (isa)
+    {
+    case ISA_SCALAR:
+        return "scalar";
+    case ISA_SSE2:
+        return "sse2";
+    case ISA_AVX2:
+        return "avx2";
+    case ISA_AVX512:
+        return "avx512";
+    }
+    return "unknown";
+}
+
+kernel_isa_t kernel_select_isa(kernel_isa_t isa)
+{
+    const size_t n_tables = sizeof(tables) / sizeof(tables[0]);
+
+    for (size_t i = n_tables; i-- > 0;)
+    {
+        if (tables[i].isa <= isa && isa_supported(tables[i].isa))
+        {
+            kernels = &tables[i];
+            break;
+        }
+    }
+    return kernels->isa;
+}
+
+// Runs when the library is loaded, before any kernel can be called
+__attribute__((constructor)) static void init_kernels(void)
+{
+    kernel_isa_t isa = ISA_AVX512;
+    const char *requested = getenv("VECTOR_ISA");
+
+    if (requested != NULL)
+    {
+        for (kernel_isa_t i = ISA_SCALAR; i <= ISA_AVX512; ++i)
+        {
+            if (strcmp(requested, kernel_isa_name(i)) == 0)
+                isa = i;
+        }
+    }
+
+    kernel_select_isa(isa);
+}
+
+void kernel_add(size_t n, double out[], const double x[], const double y[])
+{
+    kernels->add(n, out, x, y);
+}
+
+void kernel_sub(size_t n, double out[], const double x[], const double y[])
+{
+    kernels->sub(n, out, x, y);
+}
+
+void kernel_mul(size_t n, double out[], const double x[], const double y[])
+{
+    kernels->mul(n, out, x, y);
+}
+
+void kernel_div(size_t n, double out[], const double x[], const double y[])
+{
+    kernels->div(n, out, x, y);
+}
+
+void kernel_fma(size_t n, double out[], const double x[], const double y[], const double z[])
+{
+    kernels->fma(n, out, x, y, z);
+}
+
+void kernel_scale(size_t n, double out[], const double x[], double a)
+{
+    kernels->scale(n, out, x, a);
+}
+
+void kernel_ramp(size_t n, double out[], double start, double step, size_t first)
+{
+    kernels->ramp(n, out, start, step, first);
+}
+
+void kernel_axpy(size_t n, double y[], double a, const double x[])
+{
+    kernels->axpy(n, y, a, x);
+}
+
+double kernel_dot(size_t n, const double x[], const double y[])
+{
+    return kernels->dot(n, x, y);
+}
+
+double kernel_sum(size_t n, const double x[])
+{
+    return kernels->sum(n, x);
+}
+
+void kernel_gemv(size_t rows, size_t cols, double out[], const double a[], const double x[])
+{
+    kernels->gemv(rows, cols, out, a, x);
+}
+
+void kernel_gemv_t(size_t rows, size_t cols, double out[], const double a[], const double x[])
+{
+    kernels->gemv_t(rows, cols, out, a, x);
+}
+
+void kernel_sum_compensated(size_t n, const double x[], double sums[KERNEL_LANES], double comps[KERNEL_LANES])
+{
+    kernels->sum_compensated(n, x, sums, comps);
+}
+
+double kernel_absmax(size_t n, const double x[])
+{
+    return kernels->absmax(n, x);
+}
+
+void kernel_bin(size_t n, const double x[], const double split[KERNEL_BINS], double bins[KERNEL_BINS])
+{
+    kernels->bin(n, x, split, bins);
+}
+
+void kernel_gradient_interior(size_t n, double out[], const double y[], const double x[])
+{
+    kernels->gradient_interior(n, out, y, x);
+}
+
+double kernel_trapz(size_t n, const double y[], const double x[])
+{
+    double lanes[KERNEL_LANES] = {0};
+    kernels->trapz_lanes(n, y, x, lanes);
+    return combine_lanes(lanes);
+}
+
+void kernel_trapz_lanes(size_t n, const double y[], const double x[], double lanes[KERNEL_LANES])
+{
+    kernels->trapz_lanes(n, y, x, lanes);
+}
+
+double kernel_combine_lanes(const double lanes[KERNEL_LANES])
+{
+    return combine_lanes(lanes);
+}
+
+void kernel_add_f32(size_t n, float out[], const float x[], const float y[])
+{
+    kernels->add_f32(n, out, x, y);
+}
+
+void kernel_sub_f32(size_t n, float out[], const float x[], const float y[])
+{
+    kernels->sub_f32(n, out, x, y);
+}
+
+void kernel_mul_f32(size_t n, float out[], const float x[], const float y[])
+{
+    kernels->mul_f32(n, out, x, y);
+}
+
+void kernel_div_f32(size_t n, float out[], const float x[], const float y[])
+{
+    kernels->div_f32(n, out, x, y);
+}
+
+void kernel_fma_f32(size_t n, float out[], const float x[], const float y[], const float z[])
+{
+    kernels->fma_f32(n, out, x, y, z);
+}
+
+void kernel_scale_f32(size_t n, float out[], const float x[], float a)
+{
+    kernels->scale_f32(n, out, x, a);
+}
+
+void kernel_axpy_f32(size_t n, float y[], float a, const float x[])
+{
+    kernels->axpy_f32(n, y, a, x);
+}
+
+double kernel_dot_f32(size_t n, const float x[], const float y[])
+{
+    return kernels->dot_f32(n, x, y);
+}
+
+double kernel_sum_f32(size_t n, const float x[])
+{
+    return kernels->sum_f32(n, x);
+}
+
+void kernel_f32_to_f64(size_t n, double out[], const float x[])
+{
+    kernels->f32_to_f64(n, out, x);
+}
+
+void kernel_f64_to_f32(size_t n, float out[], const double x[])
+{
+    kernels->f64_to_f32(n, out, x);
+}
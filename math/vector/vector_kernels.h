@@ -0,0 +1,146 @@
+#ifndef VECTOR_KERNELS_H_
+
+#define VECTOR_KERNELS_H_
+
+#include <stddef.h>
+
+/*
+Element-wise and reduction kernels over raw double arrays.
+
+Every kernel has a scalar, SSE2, AVX2 and AVX-512 implementation. The
+widest one supported by the running CPU is picked once when the library
+is loaded, so a single build runs on every x86-64 host. Setting the
+VECTOR_ISA environment variable to scalar, sse2, avx2 or avx512 caps the
+choice, which is useful for benchmarking and for reproducing bugs.
+
+Reductions (dot, sum, trapz) always accumulate into KERNEL_LANES partial
+sums, lane j holding the terms whose index is j modulo KERNEL_LANES, and
+combine them in the same fixed order. Their results are therefore bitwise
+identical whichever ISA is selected.
+
+Element-wise kernels allow out to be the same array as any input, but
+not a partially overlapping one.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KERNEL_LANES 8
+
+// Bins kernel_bin() splits every term over
+#define KERNEL_BINS 3
+
+typedef enum kernel_isa_t
+{
+    ISA_SCALAR,
+    ISA_SSE2,
+    ISA_AVX2,
+    ISA_AVX512
+} kernel_isa_t;
+
+// Returns the instruction set the kernels currently dispatch to
+kernel_isa_t kernel_isa(void);
+
+const char *kernel_isa_name(kernel_isa_t isa);
+
+// Selects the widest supported instruction set not wider than isa and returns it
+kernel_isa_t kernel_select_isa(kernel_isa_t isa);
+
+// out[i] = x[i] + y[i]
+void kernel_add(size_t n, double out[], const double x[], const double y[]);
+
+// out[i] = x[i] - y[i]
+void kernel_sub(size_t n, double out[], const double x[], const double y[]);
+
+// out[i] = x[i] * y[i]
+void kernel_mul(size_t n, double out[], const double x[], const double y[]);
+
+// out[i] = x[i] / y[i]
+void kernel_div(size_t n, double out[], const double x[], const double y[]);
+
+// out[i] = x[i] * y[i] + z[i], rounded once
+void kernel_fma(size_t n, double out[], const double x[], const double y[], const double z[]);
+
+// out[i] = a * x[i]
+void kernel_scale(size_t n, double out[], const double x[], double a);
+
+// out[i] = start + (first + i) * step, exact in the index below 2^53
+void kernel_ramp(size_t n, double out[], double start, double step, size_t first);
+
+// y[i] = y[i] + a * x[i]
+void kernel_axpy(size_t n, double y[], double a, const double x[]);
+
+double kernel_dot(size_t n, const double x[], const double y[]);
+
+double kernel_sum(size_t n, const double x[]);
+
+// out[i] = kernel_dot() of row i of the rows x cols row-major matrix a with x,
+// rows shorter than KERNEL_LANES are summed left to right instead
+void kernel_gemv(size_t rows, size_t cols, double out[], const double a[], const double x[]);
+
+// out[j] += x[i] * a[i][j] for every row i in order, the same bits as one kernel_axpy() per row
+void kernel_gemv_t(size_t rows, size_t cols, double out[], const double a[], const double x[]);
+
+// Adds x[i] into sums[i % KERNEL_LANES] and its rounding error into comps[i % KERNEL_LANES]
+void kernel_sum_compensated(size_t n, const double x[], double sums[KERNEL_LANES], double comps[KERNEL_LANES]);
+
+// Largest |x[i]|, NaNs are ignored
+double kernel_absmax(size_t n, const double x[]);
+
+/*
+Splits every x[i] into pieces on the grids of KERNEL_BINS bins and adds
+piece k to bins[k]. split[k] is 1.5 * 2^52 times the grid of bin k, the
+grids coarsest first. Each piece is x[i] rounded to the grid after the
+pieces before it are taken off, so the caller can keep the additions
+exact and the bins then do not depend on the order of the terms.
+*/
+void kernel_bin(size_t n, const double x[], const double split[KERNEL_BINS], double bins[KERNEL_BINS]);
+
+// Central differences for the interior points: out[i] for 0 < i < n - 1.
+// out must not alias y or x.
+void kernel_gradient_interior(size_t n, double out[], const double y[], const double x[]);
+
+// Returns twice the trapezoidal integral of y over x
+double kernel_trapz(size_t n, const double y[], const double x[]);
+
+// Adds the term for trapezoid i of kernel_trapz() into lanes[i % KERNEL_LANES]
+void kernel_trapz_lanes(size_t n, const double y[], const double x[], double lanes[KERNEL_LANES]);
+
+// Combines partial sums in the order every reduction kernel uses
+double kernel_combine_lanes(const double lanes[KERNEL_LANES]);
+
+/*
+float32 versions of the element-wise kernels, with twice the lanes per
+register. kernel_dot_f32() and kernel_sum_f32() accumulate in the
+KERNEL_LANES double lanes above and return double.
+*/
+void kernel_add_f32(size_t n, float out[], const float x[], const float y[]);
+
+void kernel_sub_f32(size_t n, float out[], const float x[], const float y[]);
+
+void kernel_mul_f32(size_t n, float out[], const float x[], const float y[]);
+
+void kernel_div_f32(size_t n, float out[], const float x[], const float y[]);
+
+void kernel_fma_f32(size_t n, float out[], const float x[], const float y[], const float z[]);
+
+void kernel_scale_f32(size_t n, float out[], const float x[], float a);
+
+void kernel_axpy_f32(size_t n, float y[], float a, const float x[]);
+
+double kernel_dot_f32(size_t n, const float x[], const float y[]);
+
+double kernel_sum_f32(size_t n, const float x[]);
+
+// out[i] = x[i], widened exactly; out must not overlap x
+void kernel_f32_to_f64(size_t n, double out[], const float x[]);
+
+// out[i] = x[i] rounded to the nearest float; out must not overlap x
+void kernel_f64_to_f32(size_t n, float out[], const double x[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
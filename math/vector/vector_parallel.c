@@ -0,0 +1,350 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "vector.h"
+#include "vector_parallel.h"
+
+typedef struct pool_t
+{
+    pthread_t *workers;
+    size_t n_workers;
+    bool started;
+    bool shutdown;
+
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+    unsigned long generation;
+    size_t active;
+
+    void (*task)(void *, size_t);
+    void *ctx;
+    size_t n_tasks;
+    atomic_size_t next;
+} pool_t;
+
+static pool_t pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .work_ready = PTHREAD_COND_INITIALIZER,
+    .work_done = PTHREAD_COND_INITIALIZER,
+};
+
+// Held by the thread that currently owns the pool
+static pthread_mutex_t submit_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static size_t num_threads = 0;
+static size_t threshold = PARALLEL_DEFAULT_THRESHOLD;
+
+static _Thread_local bool in_parallel = false;
+
+// Claims and runs tasks until none are left
+static void run_tasks(void)
+{
+    in_parallel = true;
+    for (;;)
+    {
+        size_t i = atomic_fetch_add(&pool.next, 1);
+        if (i >= pool.n_tasks)
+            break;
+        pool.task(pool.ctx, i);
+    }
+    in_parallel = false;
+}
+
+static void *worker_main(void *arg)
+{
+    (void)arg;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool.lock);
+    for (;;)
+    {
+        while (pool.generation == seen && !pool.shutdown)
+            pthread_cond_wait(&pool.work_ready, &pool.lock);
+
+        if (pool.shutdown)
+            break;
+
+        seen = pool.generation;
+        pthread_mutex_unlock(&pool.lock);
+
+        run_tasks();
+
+        pthread_mutex_lock(&pool.lock);
+        if (--pool.active == 0)
+            pthread_cond_signal(&pool.work_done);
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    return NULL;
+}
+
+size_t parallel_num_threads(void)
+{
+    if (num_threads == 0)
+    {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        return n > 0 ? (size_t)n : 1;
+    }
+    return num_threads;
+}
+
+// Called with submit_lock held
+static void stop_pool(void)
+{
+    if (!pool.started)
+        return;
+
+    pthread_mutex_lock(&pool.lock);
+    pool.shutdown = true;
+    pthread_cond_broadcast(&pool.work_ready);
+    pthread_mutex_unlock(&pool.lock);
+
+    for (size_t i = 0; i < pool.n_workers; ++i)
+        pthread_join(pool.workers[i], NULL);
+
+    free(pool.workers);
+    pool.workers = NULL;
+    pool.n_workers = 0;
+    pool.shutdown = false;
+    pool.started = false;
+}
+
+// Called with submit_lock held, returns false if no worker could be started
+static bool start_pool(void)
+{
+    if (pool.started)
+        return pool.n_workers > 0;
+
+    size_t wanted = parallel_num_threads() - 1;
+    pool.workers = malloc(sizeof(*pool.workers) * (wanted > 0 ? wanted : 1));
+    if (pool.workers == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        return false;
+    }
+
+    pool.generation = 0;
+    pool.n_workers = 0;
+    for (size_t i = 0; i < wanted; ++i)
+    {
+        if (pthread_create(&pool.workers[pool.n_workers], NULL, worker_main, NULL) != 0)
+        {
+            fprintf(stderr, "%s: Could only start %zu threads\n", __func__, pool.n_workers);
+            break;
+        }
+        ++pool.n_workers;
+    }
+
+    pool.started = true;
+    return pool.n_workers > 0;
+}
+
+void parallel_set_num_threads(size_t n)
+{
+    pthread_mutex_lock(&submit_lock);
+    stop_pool();
+    num_threads = n;
+    pthread_mutex_unlock(&submit_lock);
+}
+
+void parallel_set_threshold(size_t n)
+{
+    threshold = n;
+}
+
+size_t parallel_threshold(void)
+{
+    return threshold;
+}
+
+void parallel_for(size_t n_tasks, void (*task)(void *ctx, size_t index), void *ctx)
+{
+    bool serial = in_parallel || n_tasks < 2 || parallel_num_threads() < 2 ||
+                  pthread_mutex_trylock(&submit_lock) != 0;
+
+    if (!serial && !start_pool())
+    {
+        pthread_mutex_unlock(&submit_lock);
+        serial = true;
+    }
+
+    if (serial)
+    {
+        for (size_t i = 0; i < n_tasks; ++i)
+            task(ctx, i);
+        return;
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    pool.task = task;
+    pool.ctx = ctx;
+    pool.n_tasks = n_tasks;
+    atomic_store(&pool.next, 0);
+    pool.active = pool.n_workers;
+    ++pool.generation;
+    pthread_cond_broadcast(&pool.work_ready);
+    pthread_mutex_unlock(&pool.lock);
+
+    // The calling thread works too instead of just waiting
+    run_tasks();
+
+    pthread_mutex_lock(&pool.lock);
+    while (pool.active > 0)
+        pthread_cond_wait(&pool.work_done, &pool.lock);
+    pthread_mutex_unlock(&pool.lock);
+
+    pthread_mutex_unlock(&submit_lock);
+}
+
+static size_t n_chunks(size_t n)
+{
+    return (n + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK;
+}
+
+// True when the data of a and b overlap without being the same array
+static bool partially_overlaps(const vector_t *a, const vector_t *b)
+{
+    const double *a_end = a->arr + a->size;
+    const double *b_end = b->arr + b->size;
+
+    return a->arr != b->arr && a->arr < b_end && b->arr < a_end;
+}
+
+typedef struct map_job_t
+{
+    double *out;
+    const double *in;
+    size_t size;
+    double (*function)(double);
+} map_job_t;
+
+static void map_chunk(void *ctx, size_t chunk)
+{
+    map_job_t *job = ctx;
+    size_t start = chunk * PARALLEL_CHUNK;
+    size_t end = start + PARALLEL_CHUNK < job->size ? start + PARALLEL_CHUNK : job->size;
+
+    for (size_t i = start; i < end; ++i)
+        job->out[i] = job->function(job->in[i]);
+}
+
+void parallel_apply_function(vector_t *v, double (*function)(double))
+{
+    if (v == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return;
+    }
+
+    if (v->size < threshold)
+    {
+        apply_function(v, function);
+        return;
+    }
+
+    map_job_t job = {.out = v->arr, .in = v->arr, .size = v->size, .function = function};
+    parallel_for(n_chunks(v->size), map_chunk, &job);
+}
+
+vector_t *parallel_function_like(const vector_t *u, double (*function)(double))
+{
+    if (u == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    vector_t *v = empty_like(u);
+
+    if (v == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation falied\n", __func__);
+        exit(1);
+    }
+
+    return parallel_function_like_into(v, u, function);
+}
+
+vector_t *parallel_function_like_into(vector_t *out, const vector_t *u, double (*function)(double))
+{
+    if (out == NULL || u == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    if (out->size != u->size || partially_overlaps(out, u))
+    {
+        fprintf(stderr, "%s: Output has a different size or partially overlaps the input\n", __func__);
+        return NULL;
+    }
+
+    if (u->size < threshold)
+        return function_like_into(out, u, function);
+
+    map_job_t job = {.out = out->arr, .in = u->arr, .size = u->size, .function = function};
+    parallel_for(n_chunks(u->size), map_chunk, &job);
+
+    return out;
+}
+
+typedef struct reduce_job_t
+{
+    double *partials;
+    const double *in;
+    size_t size;
+    double (*f)(double, double);
+} reduce_job_t;
+
+static void reduce_chunk(void *ctx, size_t chunk)
+{
+    reduce_job_t *job = ctx;
+    size_t start = chunk * PARALLEL_CHUNK;
+    size_t end = start + PARALLEL_CHUNK < job->size ? start + PARALLEL_CHUNK : job->size;
+
+    double result = job->in[start];
+    for (size_t i = start + 1; i < end; ++i)
+        result = job->f(result, job->in[i]);
+
+    job->partials[chunk] = result;
+}
+
+double parallel_reduce(double(f)(double, double), const vector_t *v)
+{
+    if (v == NULL || v->size == 0)
+    {
+        fprintf(stderr, "%s: Null or empty vector\n", __func__);
+        return 0.0;
+    }
+
+    if (v->size < threshold)
+        return reduce(f, v);
+
+    const size_t n = n_chunks(v->size);
+    double *partials = malloc(sizeof(*partials) * n);
+
+    if (partials == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation falied\n", __func__);
+        return reduce(f, v);
+    }
+
+    reduce_job_t job = {.partials = partials, .in = v->arr, .size = v->size, .f = f};
+    parallel_for(n, reduce_chunk, &job);
+
+    // Pairwise tree combine, keeping the left-to-right order of the operands
+    for (size_t step = 1; step < n; step *= 2)
+    {
+        for (size_t i = 0; i + step < n; i += 2 * step)
+            partials[i] = f(partials[i], partials[i + step]);
+    }
+
+    double result = partials[0];
+    free(partials);
+
+    return result;
+}
@@ -0,0 +1,66 @@
+#ifndef VECTOR_PARALLEL_H_
+
+#define VECTOR_PARALLEL_H_
+
+#include <stddef.h>
+#include "vector.h"
+
+/*
+Multithreaded versions of the vector.h map and reduce functions.
+
+Work is split into chunks of PARALLEL_CHUNK elements and handed to a
+pool of worker threads that is started on first use and kept alive
+between calls. Vectors shorter than the parallel threshold are processed
+serially on the calling thread, so small inputs pay no threading cost.
+
+Chunk boundaries depend only on the vector length, never on the number
+of threads, so parallel_reduce() returns the same result for any thread
+count.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Elements per chunk, 128 KiB of doubles so a chunk stays in L2
+#define PARALLEL_CHUNK 16384
+
+#define PARALLEL_DEFAULT_THRESHOLD 65536
+
+// Sets the number of threads including the caller, 0 for one per online CPU
+void parallel_set_num_threads(size_t n);
+
+size_t parallel_num_threads(void);
+
+// Vectors with fewer elements than n are processed serially
+void parallel_set_threshold(size_t n);
+
+size_t parallel_threshold(void);
+
+/*
+Calls task(ctx, i) for every i in [0, n_tasks) using the thread pool and
+returns when all calls have finished. Tasks run in no particular order.
+Calls made from inside a task, or while another thread is using the
+pool, run serially on the calling thread.
+*/
+void parallel_for(size_t n_tasks, void (*task)(void *ctx, size_t index), void *ctx);
+
+// Parallel apply_function(), function must be safe to call from several threads
+void parallel_apply_function(vector_t *v, double (*function)(double));
+
+// Parallel function_like()
+vector_t *parallel_function_like(const vector_t *u, double (*function)(double));
+
+vector_t *parallel_function_like_into(vector_t *out, const vector_t *u, double (*function)(double));
+
+/*
+Parallel reduce(). Each chunk is folded left to right, then the chunk
+results are combined pairwise in a tree, so f must be associative.
+*/
+double parallel_reduce(double(f)(double, double), const vector_t *v);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
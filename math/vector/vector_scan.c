@@ -0,0 +1,305 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "vector_scan.h"
+#include "vector_parallel.h"
+
+// Interleaved accumulators of the chunk reductions, as in the kernels
+#define SCAN_LANES 8
+
+typedef enum scan_op_t
+{
+    SCAN_SUM,
+    SCAN_PROD,
+    SCAN_TRAPZ
+} scan_op_t;
+
+typedef struct scan_job_t
+{
+    scan_op_t op;
+    size_t n; // Terms to scan
+    double *out;
+    const double *x; // Input, or the abscissae for cumtrapz
+    const double *y; // Ordinates for cumtrapz
+    double *offsets; // Per chunk total, then per chunk offset
+} scan_job_t;
+
+#define ADD_TERMS(A, B) ((A) + (B))
+#define MUL_TERMS(A, B) ((A) * (B))
+#define INPUT_TERM(J) (x[J])
+#define TRAPZ_TERM(J) ((y[J] + y[(J) + 1]) * (x[(J) + 1] - x[J]) / 2.0)
+
+/*
+REDUCE combines len terms from start in SCAN_LANES lanes, lane k taking
+every term whose index is k modulo SCAN_LANES, then folds the lanes in
+order. SCAN runs the same terms into out, starting from the combined
+value of everything before them.
+*/
+#define DEFINE_CHUNK_SCAN(REDUCE, SCAN, IDENTITY, COMBINE, TERM)                      \
+    static double REDUCE(const scan_job_t *job, size_t start, size_t len)             \
+    {                                                                                 \
+        const double *x = job->x, *y = job->y;                                        \
+        double acc[SCAN_LANES];                                                       \
+        size_t i = 0;                                                                 \
+        (void)y;                                                                      \
+                                                                                      \
+        for (size_t k = 0; k < SCAN_LANES; ++k)                                       \
+            acc[k] = (IDENTITY);                                                      \
+                                                                                      \
+        for (; i + SCAN_LANES <= len; i += SCAN_LANES)                                \
+            for (size_t k = 0; k < SCAN_LANES; ++k)                                   \
+                acc[k] = COMBINE(acc[k], TERM(start + i + k));                        \
+        for (size_t k = 0; i < len; ++i, ++k)                                         \
+            acc[k] = COMBINE(acc[k], TERM(start + i));                                \
+                                                                                      \
+        double total = acc[0];                                                        \
+        for (size_t k = 1; k < SCAN_LANES; ++k)                                       \
+            total = COMBINE(total, acc[k]);                                           \
+        return total;                                                                 \
+    }                                                                                 \
+                                                                                      \
+    static void SCAN(const scan_job_t *job, size_t start, size_t len, double running) \
+    {                                                                                 \
+        const double *x = job->x, *y = job->y;                                        \
+        double *out = job->out;                                                       \
+        (void)y;                                                                      \
+                                                                                      \
+        for (size_t j = start; j < start + len; ++j)                                  \
+        {                                                                             \
+            running = COMBINE(running, TERM(j));                                      \
+            out[j] = running;                                                         \
+        }                                                                             \
+    }
+
+DEFINE_CHUNK_SCAN(reduce_sum, scan_sum, 0.0, ADD_TERMS, INPUT_TERM)
+DEFINE_CHUNK_SCAN(reduce_prod, scan_prod, 1.0, MUL_TERMS, INPUT_TERM)
+DEFINE_CHUNK_SCAN(reduce_trapz, scan_trapz, 0.0, ADD_TERMS, TRAPZ_TERM)
+
+static double identity(scan_op_t op)
+{
+    return op == SCAN_PROD ? 1.0 : 0.0;
+}
+
+static double combine(scan_op_t op, double a, double b)
+{
+    return op == SCAN_PROD ? a * b : a + b;
+}
+
+static size_t chunk_length(const scan_job_t *job, size_t chunk)
+{
+    size_t start = chunk * PARALLEL_CHUNK;
+    return job->n - start < PARALLEL_CHUNK ? job->n - start : PARALLEL_CHUNK;
+}
+
+static double reduce_chunk(const scan_job_t *job, size_t chunk)
+{
+    size_t start = chunk * PARALLEL_CHUNK, len = chunk_length(job, chunk);
+
+    switch (job->op)
+    {
+    case SCAN_SUM:
+        return reduce_sum(job, start, len);
+    case SCAN_PROD:
+        return reduce_prod(job, start, len);
+    default:
+        return reduce_trapz(job, start, len);
+    }
+}
+
+static void scan_chunk(const scan_job_t *job, size_t chunk, double offset)
+{
+    size_t start = chunk * PARALLEL_CHUNK, len = chunk_length(job, chunk);
+
+    switch (job->op)
+    {
+    case SCAN_SUM:
+        scan_sum(job, start, len, offset);
+        break;
+    case SCAN_PROD:
+        scan_prod(job, start, len, offset);
+        break;
+    default:
+        scan_trapz(job, start, len, offset);
+        break;
+    }
+}
+
+static void first_pass(void *ctx, size_t chunk)
+{
+    scan_job_t *job = ctx;
+    job->offsets[chunk] = reduce_chunk(job, chunk);
+}
+
+static void second_pass(void *ctx, size_t chunk)
+{
+    scan_job_t *job = ctx;
+    scan_chunk(job, chunk, job->offsets[chunk]);
+}
+
+static void run_scan(scan_job_t *job)
+{
+    const size_t n_chunks = (job->n + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK;
+
+    if (job->n < parallel_threshold() || parallel_num_threads() < 2)
+    {
+        // Serially each chunk is scanned while the reduction left it in cache
+        double offset = identity(job->op);
+        for (size_t c = 0; c < n_chunks; ++c)
+        {
+            double total = reduce_chunk(job, c);
+            scan_chunk(job, c, offset);
+            offset = combine(job->op, offset, total);
+        }
+        return;
+    }
+
+    job->offsets = malloc(sizeof(double) * n_chunks);
+    if (job->offsets == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation falied\n", __func__);
+        exit(1);
+    }
+
+    parallel_for(n_chunks, first_pass, job);
+
+    // Chunk totals become the offsets, in the order the serial path uses
+    double offset = identity(job->op);
+    for (size_t c = 0; c < n_chunks; ++c)
+    {
+        double total = job->offsets[c];
+        job->offsets[c] = offset;
+        offset = combine(job->op, offset, total);
+    }
+
+    parallel_for(n_chunks, second_pass, job);
+
+    free(job->offsets);
+}
+
+static bool partially_overlaps(const vector_t *out, const vector_t *in)
+{
+    return out != in && out->arr < in->arr + in->size && in->arr < out->arr + out->size;
+}
+
+static vector_t *scan_into(vector_t *out, const vector_t *v, scan_op_t op, const char *caller)
+{
+    if (out == NULL || v == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", caller);
+        return NULL;
+    }
+
+    if (out->size != v->size)
+    {
+        fprintf(stderr, "%s: Different size vectors\n", caller);
+        return NULL;
+    }
+
+    if (partially_overlaps(out, v))
+    {
+        fprintf(stderr, "%s: Output partially overlaps the input\n", caller);
+        return NULL;
+    }
+
+    scan_job_t job = {op, v->size, out->arr, v->arr, NULL, NULL};
+    run_scan(&job);
+    return out;
+}
+
+vector_t *cumsum(const vector_t *v)
+{
+    if (v == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    return scan_into(empty_like(v), v, SCAN_SUM, __func__);
+}
+
+vector_t *cumsum_into(vector_t *out, const vector_t *v)
+{
+    return scan_into(out, v, SCAN_SUM, __func__);
+}
+
+vector_t *cumprod(const vector_t *v)
+{
+    if (v == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    return scan_into(empty_like(v), v, SCAN_PROD, __func__);
+}
+
+vector_t *cumprod_into(vector_t *out, const vector_t *v)
+{
+    return scan_into(out, v, SCAN_PROD, __func__);
+}
+
+vector_t *cumtrapz(const vector_t *y, const vector_t *x)
+{
+    if (y == NULL || x == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    if (y->size != x->size)
+    {
+        fprintf(stderr, "%s: Different size vectors\n", __func__);
+        return NULL;
+    }
+
+    return cumtrapz_into(empty_like(y), y, x);
+}
+
+vector_t *cumtrapz_into(vector_t *out, const vector_t *y, const vector_t *x)
+{
+    if (out == NULL || y == NULL || x == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    if (y->size != x->size || out->size != y->size)
+    {
+        fprintf(stderr, "%s: Different size vectors\n", __func__);
+        return NULL;
+    }
+
+    if (partially_overlaps(out, y) || partially_overlaps(out, x))
+    {
+        fprintf(stderr, "%s: Output partially overlaps an input\n", __func__);
+        return NULL;
+    }
+
+    if (y->size == 0)
+        return out;
+
+    // Term i is written one place ahead of the samples it reads, so an
+    // input that is also the output is scanned from a copy
+    double *copy = NULL;
+    const double *ys = y->arr, *xs = x->arr;
+    if (out == y || out == x)
+    {
+        copy = malloc(sizeof(double) * out->size);
+        if (copy == NULL)
+        {
+            fprintf(stderr, "%s: Memory allocation falied\n", __func__);
+            exit(1);
+        }
+        memcpy(copy, out->arr, sizeof(double) * out->size);
+        ys = out == y ? copy : ys;
+        xs = out == x ? copy : xs;
+    }
+
+    scan_job_t job = {SCAN_TRAPZ, y->size - 1, out->arr + 1, xs, ys, NULL};
+    run_scan(&job);
+    out->arr[0] = 0.0;
+
+    free(copy);
+    return out;
+}
@@ -0,0 +1,50 @@
+#ifndef VECTOR_SCAN_H_
+
+#define VECTOR_SCAN_H_
+
+#include "vector.h"
+
+/*
+Cumulative sums, products and integrals.
+
+The scans run in two passes over chunks of PARALLEL_CHUNK elements.
+The first pass reduces every chunk to its total, with eight interleaved
+accumulators that vectorize like the kernels of vector_kernels.h. The
+totals are scanned into per chunk offsets, and the second pass runs each
+chunk from its offset in one sequential sweep. Vectors longer than
+parallel_threshold() run both passes on the thread pool of
+vector_parallel.h; otherwise each chunk is reduced and scanned while it
+is in cache.
+
+Chunk boundaries depend only on the vector length, so results are
+identical whatever the thread count or instruction set. They may differ
+from a plain left-to-right running sum in the last bits.
+
+The _into variants follow vector.h: out must have the size of the input
+and may be the input itself.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// out[i] = v[0] + ... + v[i]
+vector_t *cumsum(const vector_t *v);
+
+vector_t *cumsum_into(vector_t *out, const vector_t *v);
+
+// out[i] = v[0] * ... * v[i]
+vector_t *cumprod(const vector_t *v);
+
+vector_t *cumprod_into(vector_t *out, const vector_t *v);
+
+// out[i] is the trapezoidal integral of y over x from x[0] to x[i], out[0] = 0
+vector_t *cumtrapz(const vector_t *y, const vector_t *x);
+
+vector_t *cumtrapz_into(vector_t *out, const vector_t *y, const vector_t *x);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
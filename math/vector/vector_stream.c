@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <string.h>
+#include "vector_stream.h"
+#include "vector_kernels.h"
+#include "vector_sum.h"
+
+void gradient_stream_init(gradient_stream_t *s)
+{
+    memset(s, 0, sizeof(*s));
+}
+
+// Pushes one point, emitting the derivative of the point before it
+static size_t push_point(gradient_stream_t *s, double y, double x, double out[])
+{
+    size_t written = 0;
+
+    if (s->seen == 1)
+    {
+        // Forward difference for first point
+        out[0] = (y - s->y_last) / (x - s->x_last);
+        written = 1;
+    }
+    else if (s->seen > 1)
+    {
+        // Central difference for the interior points
+        out[0] = (y - s->y_prev) / (x - s->x_prev);
+        written = 1;
+    }
+
+    s->y_prev = s->y_last;
+    s->x_prev = s->x_last;
+    s->y_last = y;
+    s->x_last = x;
+    ++s->seen;
+
+    return written;
+}
+
+size_t gradient_stream_push(gradient_stream_t *s, const double y[], const double x[], size_t n, double out[])
+{
+    size_t written = 0;
+
+    // The first two points of a chunk need the previous chunk's points
+    for (size_t j = 0; j < n && j < 2; ++j)
+        written += push_point(s, y[j], x[j], out + written);
+
+    if (n > 2)
+    {
+        // out[written - 1] holds the derivative at y[0], so the kernel's
+        // out[j] for 0 < j < n - 1 lines up with y[j]
+        kernel_gradient_interior(n, out + written - 1, y, x);
+        written += n - 2;
+
+        s->y_prev = y[n - 2];
+        s->x_prev = x[n - 2];
+        s->y_last = y[n - 1];
+        s->x_last = x[n - 1];
+        s->seen += n - 2;
+    }
+
+    return written;
+}
+
+size_t gradient_stream_finish(gradient_stream_t *s, double out[])
+{
+    if (s->seen < 2)
+        return 0;
+
+    // Backward difference for last point
+    out[0] = (s->y_last - s->y_prev) / (s->x_last - s->x_prev);
+    return 1;
+}
+
+void trapz_stream_init(trapz_stream_t *s)
+{
+    memset(s, 0, sizeof(*s));
+    s->policy = sum_policy() == SUM_REPRODUCIBLE ? SUM_REPRODUCIBLE : SUM_NAIVE;
+    sum_binned_init(&s->binned);
+}
+
+// Adds one trapezoid into the lane kernel_trapz() would use for it
+static void add_term(trapz_stream_t *s, double y0, double y1, double x0, double x1)
+{
+    s->lanes[s->terms % KERNEL_LANES] += (y0 + y1) * (x1 - x0);
+    ++s->terms;
+}
+
+// Adds the trapezoids of a chunk into the lanes kernel_trapz() would use for them
+static void add_lanes(trapz_stream_t *s, const double y[], const double x[], size_t n)
+{
+    size_t i = 0;
+
+    if (s->has_last)
+        add_term(s, s->y_last, y[0], s->x_last, x[0]);
+
+    // Scalar terms until the lane index is back to zero, then the kernel
+    for (; i + 1 < n && s->terms % KERNEL_LANES != 0; ++i)
+        add_term(s, y[i], y[i + 1], x[i], x[i + 1]);
+
+    if (i + 1 < n)
+    {
+        kernel_trapz_lanes(n - i, y + i, x + i, s->lanes);
+        s->terms += n - i - 1;
+    }
+}
+
+// Bins the trapezoids of a chunk a tile at a time, the binned sum needs no lane alignment
+static void add_binned(trapz_stream_t *s, const double y[], const double x[], size_t n)
+{
+    double tile[SUM_TILE];
+
+    if (s->has_last)
+    {
+        tile[0] = (s->y_last + y[0]) * (x[0] - s->x_last);
+        sum_binned_add(&s->binned, 1, tile);
+        ++s->terms;
+    }
+
+    for (size_t first = 0; first + 1 < n; first += SUM_TILE)
+    {
+        size_t len = n - 1 - first < SUM_TILE ? n - 1 - first : SUM_TILE;
+        for (size_t j = 0; j < len; ++j)
+            tile[j] = (y[first + j] + y[first + j + 1]) * (x[first + j + 1] - x[first + j]);
+        sum_binned_add(&s->binned, len, tile);
+        s->terms += len;
+    }
+}
+
+double trapz_stream_push(trapz_stream_t *s, const double y[], const double x[], size_t n)
+{
+    if (n == 0)
+        return trapz_stream_value(s);
+
+    if (s->policy == SUM_REPRODUCIBLE)
+        add_binned(s, y, x, n);
+    else
+        add_lanes(s, y, x, n);
+
+    s->has_last = true;
+    s->y_last = y[n - 1];
+    s->x_last = x[n - 1];
+
+    return trapz_stream_value(s);
+}
+
+double trapz_stream_value(const trapz_stream_t *s)
+{
+    if (s->policy == SUM_REPRODUCIBLE)
+        return sum_binned_value(&s->binned) / 2.0;
+
+    return kernel_combine_lanes(s->lanes) / 2.0;
+}
@@ -0,0 +1,82 @@
+#ifndef VECTOR_STREAM_H_
+
+#define VECTOR_STREAM_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "vector_kernels.h"
+#include "vector_sum.h"
+
+/*
+Constant memory differentiation and integration of unbounded input.
+
+The (x, y) samples are pushed in chunks of any size, including single
+points. The streams carry the points they still need across chunk
+boundaries, so the output is bitwise identical to calling gradient() or
+trapezoidal_rule() on the whole input at once. For trapezoidal_rule()
+that holds under SUM_NAIVE and SUM_REPRODUCIBLE, the summation policy
+being read by trapz_stream_init(). The compensated and pairwise sums
+depend on how the terms are split up, so under those policies the stream
+sums naively.
+
+    gradient_stream_t g;
+    trapz_stream_t t;
+    gradient_stream_init(&g);
+    trapz_stream_init(&t);
+
+    while ((n = read_chunk(y, x)) > 0)
+    {
+        size_t m = gradient_stream_push(&g, y, x, n, dydx);
+        double area = trapz_stream_push(&t, y, x, n);
+        ...use dydx[0..m) and area...
+    }
+    m = gradient_stream_finish(&g, dydx);
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct gradient_stream_t
+{
+    size_t seen;           // Points pushed so far
+    double y_prev, x_prev; // Second to last point
+    double y_last, x_last; // Last point
+} gradient_stream_t;
+
+typedef struct trapz_stream_t
+{
+    size_t terms; // Trapezoids accumulated so far
+    bool has_last;
+    double y_last, x_last;
+    double lanes[KERNEL_LANES];
+    sum_policy_t policy;
+    sum_binned_t binned; // The terms under SUM_REPRODUCIBLE, lanes otherwise
+} trapz_stream_t;
+
+void gradient_stream_init(gradient_stream_t *s);
+
+/*
+Consumes n points and writes the derivatives that can now be computed to
+out, which needs room for n values. The derivative at a point is emitted
+once the point after it has been pushed, so the output lags the input by
+one point. Returns the number of derivatives written.
+*/
+size_t gradient_stream_push(gradient_stream_t *s, const double y[], const double x[], size_t n, double out[]);
+
+// Writes the derivative at the last point, returns the number written (0 or 1)
+size_t gradient_stream_finish(gradient_stream_t *s, double out[]);
+
+void trapz_stream_init(trapz_stream_t *s);
+
+// Consumes n points and returns the integral over every point pushed so far
+double trapz_stream_push(trapz_stream_t *s, const double y[], const double x[], size_t n);
+
+// Integral over every point pushed so far
+double trapz_stream_value(const trapz_stream_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
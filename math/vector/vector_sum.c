@@ -0,0 +1,456 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "vector_sum.h"
+
+// Exponent of the grid of bin 0; bin b has grid 2^(SUM_BIN_BASE + b * SUM_BIN_WIDTH)
+#define SUM_BIN_BASE (-1020)
+
+// Highest bin whose split constant 1.5 * 2^52 * grid is finite
+#define SUM_MAX_BIN 49
+
+// Terms per kernel_bin() call, few enough that bins of magnitude up to
+// 2^SUM_BIN_WIDTH grids stay exact: SUM_BLOCK * 2^(SUM_BIN_WIDTH - 1) < 2^52
+#define SUM_BLOCK 4096
+
+// Terms summed naively at the leaves of the pairwise tree
+#define SUM_PAIRWISE_LEAF 128
+
+static const char *const policy_names[] = {"naive", "compensated", "pairwise", "reproducible"};
+
+static sum_policy_t current_policy = SUM_NAIVE;
+
+void sum_set_policy(sum_policy_t policy)
+{
+    current_policy = policy;
+}
+
+sum_policy_t sum_policy(void)
+{
+    return current_policy;
+}
+
+const char *sum_policy_name(sum_policy_t policy)
+{
+    return policy <= SUM_REPRODUCIBLE ? policy_names[policy] : "unknown";
+}
+
+// Runs when the library is loaded, like the kernels' VECTOR_ISA
+__attribute__((constructor)) static void init_sum_policy(void)
+{
+    const char *requested = getenv("VECTOR_SUM");
+
+    if (requested == NULL)
+        return;
+
+    for (sum_policy_t p = SUM_NAIVE; p <= SUM_REPRODUCIBLE; ++p)
+    {
+        if (strcmp(requested, policy_names[p]) == 0)
+            current_policy = p;
+    }
+}
+
+/* ---------------------------- Binned ---------------------------- */
+
+static int grid_exponent(int bin)
+{
+    return SUM_BIN_BASE + bin * SUM_BIN_WIDTH;
+}
+
+// Lowest bin whose pieces can hold a term of magnitude m, keeping room
+// for the bins below it
+static int bin_for(double m)
+{
+    int e;
+    frexp(m, &e);
+
+    // m < 2^e must be at most 2^(SUM_BIN_WIDTH - 1) grids of the bin
+    int above = e - SUM_BIN_BASE - (SUM_BIN_WIDTH - 1);
+    int bin = above <= 0 ? 0 : (above + SUM_BIN_WIDTH - 1) / SUM_BIN_WIDTH;
+
+    return bin < KERNEL_BINS - 1 ? KERNEL_BINS - 1 : bin;
+}
+
+// Largest term the top bin can take
+static double bin_limit(void)
+{
+    return ldexp(1.0, grid_exponent(SUM_MAX_BIN) + SUM_BIN_WIDTH - 1);
+}
+
+void sum_binned_init(sum_binned_t *s)
+{
+    memset(s, 0, sizeof(*s));
+    s->top = -1;
+}
+
+// Moves the window up so bins[0] is bin top, dropping the bins that fall below it
+static void raise_window(sum_binned_t *s, int top)
+{
+    if (s->top < 0)
+    {
+        s->top = top;
+        return;
+    }
+
+    int shift = top - s->top;
+    for (int k = KERNEL_BINS - 1; k >= 0; --k)
+    {
+        s->bins[k] = k >= shift ? s->bins[k - shift] : 0.0;
+        s->carries[k] = k >= shift ? s->carries[k - shift] : 0.0;
+    }
+    s->top = top;
+}
+
+// Moves whole multiples of 2^SUM_BIN_WIDTH grids into the carries, leaving bins in [0, 2^SUM_BIN_WIDTH) grids
+static void carry_bins(sum_binned_t *s)
+{
+    for (int k = 0; k < KERNEL_BINS; ++k)
+    {
+        int e = grid_exponent(s->top - k) + SUM_BIN_WIDTH;
+        double c = floor(ldexp(s->bins[k], -e));
+        s->bins[k] -= ldexp(c, e);
+        s->carries[k] += c;
+    }
+}
+
+static void window_splits(const sum_binned_t *s, double split[KERNEL_BINS])
+{
+    for (int k = 0; k < KERNEL_BINS; ++k)
+        split[k] = ldexp(1.5, grid_exponent(s->top - k) + 52);
+}
+
+// One term at a time, sorting out non-finite and oversized terms
+static void add_slow(sum_binned_t *s, size_t n, const double x[])
+{
+    const double limit = bin_limit();
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const double t = x[i];
+
+        if (isnan(t))
+            s->nan = true;
+        else if (isinf(t) && t > 0)
+            s->pos_inf = true;
+        else if (isinf(t))
+            s->neg_inf = true;
+        else if (fabs(t) > limit)
+            s->huge += t;
+        else if (t != 0.0)
+        {
+            int bin = bin_for(fabs(t));
+            if (bin > s->top)
+                raise_window(s, bin);
+
+            double split[KERNEL_BINS];
+            window_splits(s, split);
+            kernel_bin(1, &t, split, s->bins);
+        }
+    }
+}
+
+void sum_binned_add(sum_binned_t *s, size_t n, const double x[])
+{
+    const double limit = bin_limit();
+
+    for (size_t first = 0; first < n; first += SUM_BLOCK)
+    {
+        const size_t len = n - first < SUM_BLOCK ? n - first : SUM_BLOCK;
+        const double *block = x + first;
+        const double m = kernel_absmax(len, block);
+
+        if (m > limit || !isfinite(m))
+        {
+            add_slow(s, len, block);
+        }
+        else if (m > 0.0)
+        {
+            int bin = bin_for(m);
+            if (bin > s->top)
+                raise_window(s, bin);
+
+            double split[KERNEL_BINS], saved[KERNEL_BINS];
+            window_splits(s, split);
+            memcpy(saved, s->bins, sizeof(saved));
+
+            kernel_bin(len, block, split, s->bins);
+
+            // kernel_absmax() skips NaNs, which then show up in the bins
+            for (int k = 0; k < KERNEL_BINS; ++k)
+            {
+                if (!isfinite(s->bins[k]))
+                {
+                    memcpy(s->bins, saved, sizeof(saved));
+                    add_slow(s, len, block);
+                    break;
+                }
+            }
+        }
+        else
+        {
+            // Zeros, or NaNs that kernel_absmax() skipped
+            add_slow(s, len, block);
+        }
+
+        if (s->top >= 0)
+            carry_bins(s);
+    }
+}
+
+void sum_binned_merge(sum_binned_t *s, const sum_binned_t *other)
+{
+    sum_binned_t o = *other;
+
+    s->huge += o.huge;
+    s->nan |= o.nan;
+    s->pos_inf |= o.pos_inf;
+    s->neg_inf |= o.neg_inf;
+
+    if (o.top < 0)
+        return;
+
+    if (o.top > s->top)
+        raise_window(s, o.top);
+    else
+        raise_window(&o, s->top);
+
+    for (int k = 0; k < KERNEL_BINS; ++k)
+    {
+        s->bins[k] += o.bins[k];
+        s->carries[k] += o.carries[k];
+    }
+    carry_bins(s);
+}
+
+double sum_binned_value(const sum_binned_t *s)
+{
+    if (s->nan || (s->pos_inf && s->neg_inf))
+        return NAN;
+    if (s->pos_inf)
+        return INFINITY;
+    if (s->neg_inf)
+        return -INFINITY;
+    if (s->top < 0)
+        return s->huge;
+
+    // The bins are in canonical form after carry_bins(), so adding them
+    // smallest first gives the same bits however they were filled
+    double total = 0.0;
+    for (int k = KERNEL_BINS - 1; k >= 0; --k)
+    {
+        total += s->bins[k];
+        total += ldexp(s->carries[k], grid_exponent(s->top - k) + SUM_BIN_WIDTH);
+    }
+    return total + s->huge;
+}
+
+/* ----------------------------- Terms ---------------------------- */
+
+typedef enum term_kind_t
+{
+    TERMS_SUM,
+    TERMS_DOT,
+    TERMS_TRAPZ,
+    TERMS_FUNCTION
+} term_kind_t;
+
+// The terms of a reduction, n of them
+typedef struct terms_t
+{
+    term_kind_t kind;
+    size_t n;
+    const double *x;
+    const double *y;
+    sum_term_function_t f;
+    void *ctx;
+} terms_t;
+
+// Returns terms first .. first + len - 1, computed into tile unless they are x itself
+static const double *get_terms(const terms_t *t, size_t first, size_t len, double tile[])
+{
+    double h[SUM_TILE];
+
+    switch (t->kind)
+    {
+    case TERMS_SUM:
+        return t->x + first;
+    case TERMS_DOT:
+        kernel_mul(len, tile, t->x + first, t->y + first);
+        return tile;
+    case TERMS_FUNCTION:
+        t->f(t->ctx, first, len, tile);
+        return tile;
+    default:
+        // (y[i] + y[i + 1]) * (x[i + 1] - x[i]), as kernel_trapz() computes it
+        kernel_add(len, tile, t->y + first, t->y + first + 1);
+        kernel_sub(len, h, t->x + first + 1, t->x + first);
+        kernel_mul(len, tile, tile, h);
+        return tile;
+    }
+}
+
+// The kernels' eight lane sum, with term first in lane 0
+static double naive_terms(const terms_t *t, size_t first, size_t len)
+{
+    switch (t->kind)
+    {
+    case TERMS_SUM:
+        return kernel_sum(len, t->x + first);
+    case TERMS_DOT:
+        return kernel_dot(len, t->x + first, t->y + first);
+    case TERMS_TRAPZ:
+        return kernel_trapz(len + 1, t->y + first, t->x + first);
+    default:
+        break;
+    }
+
+    double lanes[KERNEL_LANES] = {0.0};
+    double tile[SUM_TILE];
+
+    for (size_t i = 0; i < len; i += SUM_TILE)
+    {
+        size_t m = len - i < SUM_TILE ? len - i : SUM_TILE;
+        const double *terms = get_terms(t, first + i, m, tile);
+
+        for (size_t j = 0; j < m; ++j)
+            lanes[j % KERNEL_LANES] += terms[j];
+    }
+    return kernel_combine_lanes(lanes);
+}
+
+// Compensated sum, term i in lane i % KERNEL_LANES, the lanes folded with Neumaier's sum
+static double compensated_terms(const terms_t *t)
+{
+    double sums[KERNEL_LANES] = {0.0}, comps[KERNEL_LANES] = {0.0};
+    double tile[SUM_TILE];
+
+    for (size_t first = 0; first < t->n; first += SUM_TILE)
+    {
+        size_t len = t->n - first < SUM_TILE ? t->n - first : SUM_TILE;
+        kernel_sum_compensated(len, get_terms(t, first, len, tile), sums, comps);
+    }
+
+    double s = 0.0, c = 0.0;
+    for (size_t j = 0; j < KERNEL_LANES; ++j)
+    {
+        const double a = s, b = sums[j];
+        s = a + b;
+        c += fabs(a) >= fabs(b) ? (a - s) + b : (b - s) + a;
+        c += comps[j];
+    }
+    return s + c;
+}
+
+// Splits at a multiple of KERNEL_LANES near the middle, like NumPy
+static double pairwise_terms(const terms_t *t, size_t first, size_t len)
+{
+    if (len <= SUM_PAIRWISE_LEAF)
+        return naive_terms(t, first, len);
+
+    size_t half = len / 2;
+    half -= half % KERNEL_LANES;
+
+    return pairwise_terms(t, first, half) + pairwise_terms(t, first + half, len - half);
+}
+
+static double reproducible_terms(const terms_t *t)
+{
+    sum_binned_t s;
+    double tile[SUM_TILE];
+
+    sum_binned_init(&s);
+    for (size_t first = 0; first < t->n; first += SUM_TILE)
+    {
+        size_t len = t->n - first < SUM_TILE ? t->n - first : SUM_TILE;
+        sum_binned_add(&s, len, get_terms(t, first, len, tile));
+    }
+    return sum_binned_value(&s);
+}
+
+static double sum_policy_terms(sum_policy_t policy, const terms_t *t)
+{
+    switch (policy)
+    {
+    case SUM_COMPENSATED:
+        return compensated_terms(t);
+    case SUM_PAIRWISE:
+        return pairwise_terms(t, 0, t->n);
+    case SUM_REPRODUCIBLE:
+        return reproducible_terms(t);
+    default:
+        return naive_terms(t, 0, t->n);
+    }
+}
+
+double sum_array(sum_policy_t policy, size_t n, const double x[])
+{
+    terms_t t = {TERMS_SUM, n, x, NULL, NULL, NULL};
+    return sum_policy_terms(policy, &t);
+}
+
+double dot_array(sum_policy_t policy, size_t n, const double x[], const double y[])
+{
+    terms_t t = {TERMS_DOT, n, x, y, NULL, NULL};
+    return sum_policy_terms(policy, &t);
+}
+
+double trapz_array(sum_policy_t policy, size_t n, const double y[], const double x[])
+{
+    if (n < 2)
+        return 0.0;
+
+    terms_t t = {TERMS_TRAPZ, n - 1, x, y, NULL, NULL};
+    return sum_policy_terms(policy, &t) / 2.0;
+}
+
+double sum_terms(sum_policy_t policy, size_t n, sum_term_function_t terms, void *ctx)
+{
+    terms_t t = {TERMS_FUNCTION, n, NULL, NULL, terms, ctx};
+    return sum_policy_terms(policy, &t);
+}
+
+double sum_with(sum_policy_t policy, const vector_t *v)
+{
+    if (v == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return 0.0;
+    }
+
+    return sum_array(policy, v->size, v->arr);
+}
+
+double dot_with(sum_policy_t policy, const vector_t *x, const vector_t *y)
+{
+    if (x == NULL || y == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return 0.0;
+    }
+
+    if (x->size != y->size)
+    {
+        fprintf(stderr, "%s: Different size vectors\n", __func__);
+        return 0.0;
+    }
+
+    return dot_array(policy, x->size, x->arr, y->arr);
+}
+
+double trapezoidal_rule_with(sum_policy_t policy, const vector_t *y, const vector_t *x)
+{
+    if (y == NULL || x == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return 0.0;
+    }
+
+    if (x->size != y->size)
+    {
+        fprintf(stderr, "%s: x and y must have same size\n", __func__);
+        return 0.0;
+    }
+
+    return trapz_array(policy, y->size, y->arr, x->arr);
+}
@@ -0,0 +1,113 @@
+#ifndef VECTOR_SUM_H_
+
+#define VECTOR_SUM_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "vector.h"
+#include "vector_kernels.h"
+
+/*
+Summation policies for the reductions.
+
+    SUM_NAIVE         the kernels' eight lane sum, the fastest
+    SUM_COMPENSATED   Neumaier's compensated sum in each of the eight lanes
+    SUM_PAIRWISE      pairwise sums of 128 term blocks, error growing with log n
+    SUM_REPRODUCIBLE  exact binned sum, the same bits for any order of the terms
+
+sum(), dot() and trapezoidal_rule() of vector.h, and their view_ and gen_
+versions, use the global policy, SUM_NAIVE unless changed with
+sum_set_policy() or the VECTOR_SUM environment variable (naive,
+compensated, pairwise or reproducible). The _with functions take the
+policy per call. trapz_stream_t of vector_stream.h matches
+trapezoidal_rule() under SUM_NAIVE and SUM_REPRODUCIBLE only.
+
+The first three policies give the same bits on every instruction set but
+depend on how the terms are split up. SUM_REPRODUCIBLE rounds every term
+onto a fixed grid of bins, 2^SUM_BIN_WIDTH apart, and adds the pieces of
+the three bins below the largest term exactly, so the result does not
+depend on the order of the terms, the SIMD width or how they are divided
+between threads. Partial sums are kept in a sum_binned_t, and partials
+computed on any split of the terms merge to the same bits:
+
+    sum_binned_t total, part;
+    sum_binned_init(&total);
+    for each block of terms, on any thread
+        sum_binned_init(&part);
+        sum_binned_add(&part, n, terms);
+        sum_binned_merge(&total, &part);
+    double s = sum_binned_value(&total);
+
+Its error is below n * max|term| * 2^-80 before the final rounding, and
+it runs at memory speed on long vectors. Terms of magnitude above 2^979
+are added naively and make the result order dependent.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum sum_policy_t
+{
+    SUM_NAIVE,
+    SUM_COMPENSATED,
+    SUM_PAIRWISE,
+    SUM_REPRODUCIBLE
+} sum_policy_t;
+
+// Bits between the grids of neighbouring bins
+#define SUM_BIN_WIDTH 40
+
+// Most terms a sum_term_function_t is asked for at once, a multiple of KERNEL_LANES
+#define SUM_TILE 512
+
+// Writes terms first .. first + len - 1 of a sum to out
+typedef void (*sum_term_function_t)(void *ctx, size_t first, size_t len, double out[]);
+
+typedef struct sum_binned_t
+{
+    int top;                       // Bin of bins[0], -1 before the first nonzero finite term
+    double bins[KERNEL_BINS];      // Pieces on the grids of bins top, top - 1, ...
+    double carries[KERNEL_BINS];   // Multiples of 2^SUM_BIN_WIDTH grids moved out of bins
+    double huge;                   // Naive sum of the terms too large to bin
+    bool nan, pos_inf, neg_inf;    // Non-finite terms seen
+} sum_binned_t;
+
+void sum_set_policy(sum_policy_t policy);
+
+sum_policy_t sum_policy(void);
+
+const char *sum_policy_name(sum_policy_t policy);
+
+// Sum of x[0..n-1]
+double sum_array(sum_policy_t policy, size_t n, const double x[]);
+
+// Sum of x[i] * y[i]
+double dot_array(sum_policy_t policy, size_t n, const double x[], const double y[]);
+
+// Trapezoidal integral of y over x from n points
+double trapz_array(sum_policy_t policy, size_t n, const double y[], const double x[]);
+
+// Sum of n terms computed a tile at a time, for terms that are not stored
+double sum_terms(sum_policy_t policy, size_t n, sum_term_function_t terms, void *ctx);
+
+double sum_with(sum_policy_t policy, const vector_t *v);
+
+double dot_with(sum_policy_t policy, const vector_t *x, const vector_t *y);
+
+double trapezoidal_rule_with(sum_policy_t policy, const vector_t *y, const vector_t *x);
+
+void sum_binned_init(sum_binned_t *s);
+
+void sum_binned_add(sum_binned_t *s, size_t n, const double x[]);
+
+// Adds the terms of other to s
+void sum_binned_merge(sum_binned_t *s, const sum_binned_t *other);
+
+double sum_binned_value(const sum_binned_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,473 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <complex.h>
+#include "vector_types.h"
+#include "vector_kernels.h"
+#include "vector_sum.h"
+
+/* ---------------------------- float32 --------------------------- */
+
+#define add_elems_f32 kernel_add_f32
+#define sub_elems_f32 kernel_sub_f32
+#define mul_elems_f32 kernel_mul_f32
+#define div_elems_f32 kernel_div_f32
+#define fma_elems_f32 kernel_fma_f32
+#define scale_elems_f32 kernel_scale_f32
+#define axpy_elems_f32 kernel_axpy_f32
+
+typedef struct f32_pair_t
+{
+    const float *x;
+    const float *y;
+} f32_pair_t;
+
+// Terms for sum_terms(), widened to double so every policy sums what the kernels sum
+static void f32_sum_terms(void *ctx, size_t first, size_t len, double out[])
+{
+    const f32_pair_t *p = ctx;
+    kernel_f32_to_f64(len, out, p->x + first);
+}
+
+static void f32_dot_terms(void *ctx, size_t first, size_t len, double out[])
+{
+    const f32_pair_t *p = ctx;
+    double ys[SUM_TILE];
+
+    kernel_f32_to_f64(len, out, p->x + first);
+    kernel_f32_to_f64(len, ys, p->y + first);
+    kernel_mul(len, out, out, ys);
+}
+
+static void f32_trapz_terms(void *ctx, size_t first, size_t len, double out[])
+{
+    const f32_pair_t *p = ctx;
+    double ys[SUM_TILE + 1], xs[SUM_TILE + 1];
+
+    kernel_f32_to_f64(len + 1, ys, p->y + first);
+    kernel_f32_to_f64(len + 1, xs, p->x + first);
+    for (size_t i = 0; i < len; ++i)
+        out[i] = (ys[i] + ys[i + 1]) * (xs[i + 1] - xs[i]);
+}
+
+static double sum_elems_f32(size_t n, const float x[])
+{
+    const sum_policy_t policy = sum_policy();
+    if (policy == SUM_NAIVE)
+        return kernel_sum_f32(n, x);
+
+    f32_pair_t p = {x, NULL};
+    return sum_terms(policy, n, f32_sum_terms, &p);
+}
+
+static double dot_elems_f32(size_t n, const float x[], const float y[])
+{
+    const sum_policy_t policy = sum_policy();
+    if (policy == SUM_NAIVE)
+        return kernel_dot_f32(n, x, y);
+
+    f32_pair_t p = {x, y};
+    return sum_terms(policy, n, f32_dot_terms, &p);
+}
+
+static double trapz_elems_f32(size_t n, const float y[], const float x[])
+{
+    if (n < 2)
+        return 0.0;
+
+    f32_pair_t p = {x, y};
+    return sum_terms(sum_policy(), n - 1, f32_trapz_terms, &p) / 2.0;
+}
+
+static void print_elem_f32(float x)
+{
+    printf("%g", x);
+}
+
+DEFINE_VECTOR_FAMILY(vector_f32_t, float, double, f32)
+
+// Number of terms arange_f32() produces, 0 if there are none
+static size_t arange_terms_f32(float start, float end, float step)
+{
+    if (step == 0 || (step > 0 ? end <= start : start <= end))
+        return 0;
+
+    return (size_t)(((double)end - start) / step);
+}
+
+vector_f32_t *arange_f32(float start, float end, float step)
+{
+    const size_t n = arange_terms_f32(start, end, step);
+    if (n == 0)
+    {
+        fprintf(stderr, "%s: Step does not lead from start to end\n", __func__);
+        return NULL;
+    }
+
+    vector_f32_t *v = empty_f32(n);
+    return v != NULL ? arange_into_f32(v, start, end, step) : NULL;
+}
+
+vector_f32_t *arange_into_f32(vector_f32_t *out, float start, float end, float step)
+{
+    if (out == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    if (out->size == 0 || out->size != arange_terms_f32(start, end, step))
+    {
+        fprintf(stderr, "%s: Output vector has the wrong size\n", __func__);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < out->size; ++i)
+        out->arr[i] = (float)(start + (double)i * step);
+
+    return out;
+}
+
+/* ---------------------------- Complex --------------------------- */
+
+// Real and imaginary parts are interleaved, so add and subtract run on the real kernels
+static void add_elems_c64(size_t n, float _Complex out[], const float _Complex x[], const float _Complex y[])
+{
+    kernel_add_f32(2 * n, (float *)out, (const float *)x, (const float *)y);
+}
+
+static void sub_elems_c64(size_t n, float _Complex out[], const float _Complex x[], const float _Complex y[])
+{
+    kernel_sub_f32(2 * n, (float *)out, (const float *)x, (const float *)y);
+}
+
+static void add_elems_c128(size_t n, double _Complex out[], const double _Complex x[], const double _Complex y[])
+{
+    kernel_add(2 * n, (double *)out, (const double *)x, (const double *)y);
+}
+
+static void sub_elems_c128(size_t n, double _Complex out[], const double _Complex x[], const double _Complex y[])
+{
+    kernel_sub(2 * n, (double *)out, (const double *)x, (const double *)y);
+}
+
+// The rest are plain loops; multiply_add rounds the product and the sum separately
+#define DEFINE_COMPLEX_ELEMS(ELEM_T, SUFFIX)                                                          \
+    static void mul_elems_##SUFFIX(size_t n, ELEM_T out[], const ELEM_T x[], const ELEM_T y[])      \
+    {                                                                                                 \
+        for (size_t i = 0; i < n; ++i)                                                                \
+            out[i] = x[i] * y[i];                                                                     \
+    }                                                                                                 \
+                                                                                                      \
+    static void div_elems_##SUFFIX(size_t n, ELEM_T out[], const ELEM_T x[], const ELEM_T y[])      \
+    {                                                                                                 \
+        for (size_t i = 0; i < n; ++i)                                                                \
+            out[i] = x[i] / y[i];                                                                     \
+    }                                                                                                 \
+                                                                                                      \
+    static void fma_elems_##SUFFIX(size_t n, ELEM_T out[], const ELEM_T x[], const ELEM_T y[],      \
+                                   const ELEM_T z[])                                                  \
+    {                                                                                                 \
+        for (size_t i = 0; i < n; ++i)                                                                \
+            out[i] = x[i] * y[i] + z[i];                                                              \
+    }                                                                                                 \
+                                                                                                      \
+    static void scale_elems_##SUFFIX(size_t n, ELEM_T out[], const ELEM_T x[], ELEM_T a)            \
+    {                                                                                                 \
+        for (size_t i = 0; i < n; ++i)                                                                \
+            out[i] = a * x[i];                                                                        \
+    }                                                                                                 \
+                                                                                                      \
+    static void axpy_elems_##SUFFIX(size_t n, ELEM_T y[], ELEM_T a, const ELEM_T x[])               \
+    {                                                                                                 \
+        for (size_t i = 0; i < n; ++i)                                                                \
+            y[i] = y[i] + a * x[i];                                                                   \
+    }                                                                                                 \
+                                                                                                      \
+    static void print_elem_##SUFFIX(ELEM_T z)                                                        \
+    {                                                                                                 \
+        printf("%g%+gi", (double)creal(z), (double)cimag(z));                                         \
+    }
+
+DEFINE_COMPLEX_ELEMS(float _Complex, c64)
+DEFINE_COMPLEX_ELEMS(double _Complex, c128)
+
+typedef enum complex_kind_t
+{
+    COMPLEX_SUM,
+    COMPLEX_DOT,
+    COMPLEX_TRAPZ
+} complex_kind_t;
+
+// One part of the terms of a complex reduction, for sum_terms()
+typedef struct complex_terms_t
+{
+    complex_kind_t kind;
+    bool imag;
+    bool c64;
+    const void *x;
+    const void *y;
+} complex_terms_t;
+
+static double _Complex complex_at(const complex_terms_t *t, const void *arr, size_t i)
+{
+    return t->c64 ? ((const float _Complex *)arr)[i] : ((const double _Complex *)arr)[i];
+}
+
+static void complex_terms(void *ctx, size_t first, size_t len, double out[])
+{
+    const complex_terms_t *t = ctx;
+
+    for (size_t k = 0; k < len; ++k)
+    {
+        const size_t i = first + k;
+        double _Complex v;
+
+        switch (t->kind)
+        {
+        case COMPLEX_SUM:
+            v = complex_at(t, t->x, i);
+            break;
+        case COMPLEX_DOT:
+            v = complex_at(t, t->x, i) * complex_at(t, t->y, i);
+            break;
+        default:
+            v = (complex_at(t, t->y, i) + complex_at(t, t->y, i + 1)) *
+                (complex_at(t, t->x, i + 1) - complex_at(t, t->x, i));
+            break;
+        }
+        out[k] = t->imag ? cimag(v) : creal(v);
+    }
+}
+
+// Sums the real and the imaginary parts of n terms under the current policy
+static double _Complex complex_reduce(complex_kind_t kind, bool c64, size_t n, const void *x, const void *y)
+{
+    const sum_policy_t policy = sum_policy();
+    complex_terms_t re = {kind, false, c64, x, y};
+    complex_terms_t im = {kind, true, c64, x, y};
+
+    return CMPLX(sum_terms(policy, n, complex_terms, &re), sum_terms(policy, n, complex_terms, &im));
+}
+
+static double _Complex sum_elems_c64(size_t n, const float _Complex x[])
+{
+    return complex_reduce(COMPLEX_SUM, true, n, x, NULL);
+}
+
+static double _Complex dot_elems_c64(size_t n, const float _Complex x[], const float _Complex y[])
+{
+    return complex_reduce(COMPLEX_DOT, true, n, x, y);
+}
+
+static double _Complex trapz_elems_c64(size_t n, const float _Complex y[], const float _Complex x[])
+{
+    return n < 2 ? 0.0 : complex_reduce(COMPLEX_TRAPZ, true, n - 1, x, y) / 2.0;
+}
+
+static double _Complex sum_elems_c128(size_t n, const double _Complex x[])
+{
+    return complex_reduce(COMPLEX_SUM, false, n, x, NULL);
+}
+
+static double _Complex dot_elems_c128(size_t n, const double _Complex x[], const double _Complex y[])
+{
+    return complex_reduce(COMPLEX_DOT, false, n, x, y);
+}
+
+static double _Complex trapz_elems_c128(size_t n, const double _Complex y[], const double _Complex x[])
+{
+    return n < 2 ? 0.0 : complex_reduce(COMPLEX_TRAPZ, false, n - 1, x, y) / 2.0;
+}
+
+DEFINE_VECTOR_FAMILY(vector_c64_t, float _Complex, double _Complex, c64)
+
+DEFINE_VECTOR_FAMILY(vector_c128_t, double _Complex, double _Complex, c128)
+
+/* -------------------------- Conversions ------------------------- */
+
+// Checks a conversion between vectors of n elements whose data must not overlap
+static bool check_conversion(const void *out, const void *out_data, size_t out_size, size_t out_bytes,
+                             const void *u, const void *u_data, size_t u_size, size_t u_bytes, const char *caller)
+{
+    if (out == NULL || u == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", caller);
+        return false;
+    }
+
+    if (out_size != u_size)
+    {
+        fprintf(stderr, "%s: Different size vectors\n", caller);
+        return false;
+    }
+
+    const char *o = out_data, *v = u_data;
+    if (o < v + u_bytes && v < o + out_bytes)
+    {
+        fprintf(stderr, "%s: Output overlaps the input\n", caller);
+        return false;
+    }
+
+    return true;
+}
+
+#define CHECK_CONVERSION(OUT, U)                                                                      \
+    check_conversion(OUT, (OUT) != NULL ? (OUT)->arr : NULL, (OUT) != NULL ? (OUT)->size : 0,         \
+                     (OUT) != NULL ? sizeof((OUT)->arr[0]) * (OUT)->size : 0,                         \
+                     U, (U) != NULL ? (U)->arr : NULL, (U) != NULL ? (U)->size : 0,                   \
+                     (U) != NULL ? sizeof((U)->arr[0]) * (U)->size : 0, __func__)
+
+vector_f32_t *to_f32(const vector_t *u)
+{
+    if (u == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    vector_f32_t *v = empty_f32(u->size);
+    return v != NULL ? to_f32_into(v, u) : NULL;
+}
+
+vector_f32_t *to_f32_into(vector_f32_t *out, const vector_t *u)
+{
+    if (!CHECK_CONVERSION(out, u))
+        return NULL;
+
+    kernel_f64_to_f32(u->size, out->arr, u->arr);
+    return out;
+}
+
+vector_t *to_f64(const vector_f32_t *u)
+{
+    if (u == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    vector_t *v = empty(u->size);
+    return v != NULL ? to_f64_into(v, u) : NULL;
+}
+
+vector_t *to_f64_into(vector_t *out, const vector_f32_t *u)
+{
+    if (!CHECK_CONVERSION(out, u))
+        return NULL;
+
+    kernel_f32_to_f64(u->size, out->arr, u->arr);
+    return out;
+}
+
+vector_c64_t *to_c64(const vector_c128_t *u)
+{
+    if (u == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    vector_c64_t *v = empty_c64(u->size);
+    return v != NULL ? to_c64_into(v, u) : NULL;
+}
+
+vector_c64_t *to_c64_into(vector_c64_t *out, const vector_c128_t *u)
+{
+    if (!CHECK_CONVERSION(out, u))
+        return NULL;
+
+    kernel_f64_to_f32(2 * u->size, (float *)out->arr, (const double *)u->arr);
+    return out;
+}
+
+vector_c128_t *to_c128(const vector_c64_t *u)
+{
+    if (u == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    vector_c128_t *v = empty_c128(u->size);
+    return v != NULL ? to_c128_into(v, u) : NULL;
+}
+
+vector_c128_t *to_c128_into(vector_c128_t *out, const vector_c64_t *u)
+{
+    if (!CHECK_CONVERSION(out, u))
+        return NULL;
+
+    kernel_f32_to_f64(2 * u->size, (double *)out->arr, (const float *)u->arr);
+    return out;
+}
+
+vector_c128_t *complex_from(const vector_t *re, const vector_t *im)
+{
+    if (re == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    vector_c128_t *v = empty_c128(re->size);
+    return v != NULL ? complex_from_into(v, re, im) : NULL;
+}
+
+vector_c128_t *complex_from_into(vector_c128_t *out, const vector_t *re, const vector_t *im)
+{
+    if (!CHECK_CONVERSION(out, re) || (im != NULL && !CHECK_CONVERSION(out, im)))
+        return NULL;
+
+    for (size_t i = 0; i < out->size; ++i)
+        out->arr[i] = CMPLX(re->arr[i], im != NULL ? im->arr[i] : 0.0);
+
+    return out;
+}
+
+vector_t *real_part(const vector_c128_t *u)
+{
+    if (u == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    vector_t *v = empty(u->size);
+    return v != NULL ? real_part_into(v, u) : NULL;
+}
+
+vector_t *real_part_into(vector_t *out, const vector_c128_t *u)
+{
+    if (!CHECK_CONVERSION(out, u))
+        return NULL;
+
+    for (size_t i = 0; i < out->size; ++i)
+        out->arr[i] = creal(u->arr[i]);
+
+    return out;
+}
+
+vector_t *imag_part(const vector_c128_t *u)
+{
+    if (u == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", __func__);
+        return NULL;
+    }
+
+    vector_t *v = empty(u->size);
+    return v != NULL ? imag_part_into(v, u) : NULL;
+}
+
+vector_t *imag_part_into(vector_t *out, const vector_c128_t *u)
+{
+    if (!CHECK_CONVERSION(out, u))
+        return NULL;
+
+    for (size_t i = 0; i < out->size; ++i)
+        out->arr[i] = cimag(u->arr[i]);
+
+    return out;
+}
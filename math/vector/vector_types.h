@@ -0,0 +1,76 @@
+#ifndef VECTOR_TYPES_H_
+
+#define VECTOR_TYPES_H_
+
+#include <stddef.h>
+#include "vector.h"
+#include "vector_family.h"
+
+/*
+float32 and complex vectors with the vector.h API.
+
+    vector_f32_t    float               reductions in double
+    vector_c64_t    float _Complex      reductions in double _Complex
+    vector_c128_t   double _Complex     reductions in double _Complex
+
+Every vector.h function exists for each type with the type appended,
+add_f32(), dot_c64(), linspace_into_c128(), and vector_generic.h picks
+the right one from the argument's type. float32 vectors run on the
+float kernels of vector_kernels.h, with twice the SIMD lanes and half
+the memory traffic of vector_t. trapezoidal_rule, dot and sum follow
+the summation policy of vector_sum.h; complex ones sum the real and
+imaginary parts separately. dot does not conjugate either operand.
+
+The conversions below go between the types. Narrowing rounds to the
+nearest float, and converting a complex vector to vector_t keeps one
+part.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+DECLARE_VECTOR_FAMILY(vector_f32_t, float, double, f32)
+
+DECLARE_VECTOR_FAMILY(vector_c64_t, float _Complex, double _Complex, c64)
+
+DECLARE_VECTOR_FAMILY(vector_c128_t, double _Complex, double _Complex, c128)
+
+vector_f32_t *arange_f32(float start, float end, float step);
+
+vector_f32_t *arange_into_f32(vector_f32_t *out, float start, float end, float step);
+
+vector_f32_t *to_f32(const vector_t *u);
+
+vector_f32_t *to_f32_into(vector_f32_t *out, const vector_t *u);
+
+vector_t *to_f64(const vector_f32_t *u);
+
+vector_t *to_f64_into(vector_t *out, const vector_f32_t *u);
+
+vector_c64_t *to_c64(const vector_c128_t *u);
+
+vector_c64_t *to_c64_into(vector_c64_t *out, const vector_c128_t *u);
+
+vector_c128_t *to_c128(const vector_c64_t *u);
+
+vector_c128_t *to_c128_into(vector_c128_t *out, const vector_c64_t *u);
+
+// re + i * im, im may be NULL for a zero imaginary part
+vector_c128_t *complex_from(const vector_t *re, const vector_t *im);
+
+vector_c128_t *complex_from_into(vector_c128_t *out, const vector_t *re, const vector_t *im);
+
+vector_t *real_part(const vector_c128_t *u);
+
+vector_t *real_part_into(vector_t *out, const vector_c128_t *u);
+
+vector_t *imag_part(const vector_c128_t *u);
+
+vector_t *imag_part_into(vector_t *out, const vector_c128_t *u);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
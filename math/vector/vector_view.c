@@ -0,0 +1,440 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "vector.h"
+#include "vector_view.h"
+#include "vector_kernels.h"
+#include "vector_sum.h"
+
+vector_view_t view_of(const vector_t *v)
+{
+    if (v == NULL)
+        return (vector_view_t){.data = NULL, .size = 0, .stride = 1};
+
+    return (vector_view_t){.data = v->arr, .size = v->size, .stride = 1};
+}
+
+vector_view_t view_from_buffer(const double *data, size_t size, ptrdiff_t stride)
+{
+    return (vector_view_t){.data = data, .size = size, .stride = stride};
+}
+
+// Clamps a slice bound the way Python's slice.indices() does
+static ptrdiff_t clamp_bound(ptrdiff_t i, ptrdiff_t n, ptrdiff_t step)
+{
+    if (i < 0)
+    {
+        i += n;
+        if (i < 0)
+            i = step < 0 ? -1 : 0;
+    }
+    else if (i >= n)
+    {
+        i = step < 0 ? n - 1 : n;
+    }
+    return i;
+}
+
+vector_view_t view_slice(vector_view_t v, ptrdiff_t start, ptrdiff_t stop, ptrdiff_t step)
+{
+    assert(step != 0);
+
+    const ptrdiff_t n = (ptrdiff_t)v.size;
+
+    start = clamp_bound(start, n, step);
+    if (stop == VIEW_END)
+        stop = step > 0 ? n : -1;
+    else
+        stop = clamp_bound(stop, n, step);
+
+    size_t length = 0;
+    if (step > 0 && stop > start)
+        length = (size_t)((stop - start - 1) / step + 1);
+    else if (step < 0 && start > stop)
+        length = (size_t)((start - stop - 1) / -step + 1);
+
+    if (length == 0)
+        return (vector_view_t){.data = v.data, .size = 0, .stride = v.stride * step};
+
+    return (vector_view_t){
+        .data = v.data + start * v.stride,
+        .size = length,
+        .stride = v.stride * step,
+    };
+}
+
+vector_view_t view_reverse(vector_view_t v)
+{
+    return view_slice(v, -1, VIEW_END, -1);
+}
+
+static bool contiguous(vector_view_t v)
+{
+    return v.stride == 1 || v.size < 2;
+}
+
+// True when out shares memory with the elements spanned by v
+static bool view_overlaps(const vector_t *out, vector_view_t v)
+{
+    if (v.size == 0 || out->size == 0)
+        return false;
+
+    const double *first = v.data;
+    const double *last = v.data + (ptrdiff_t)(v.size - 1) * v.stride;
+    const double *lo = first < last ? first : last;
+    const double *hi = first < last ? last : first;
+
+    return lo < out->arr + out->size && out->arr <= hi;
+}
+
+vector_t *view_to_vector(vector_view_t v)
+{
+    vector_t *out = empty(v.size);
+
+    if (out == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation falied\n", __func__);
+        exit(1);
+    }
+
+    return view_to_vector_into(out, v);
+}
+
+vector_t *view_to_vector_into(vector_t *out, vector_view_t v)
+{
+    if (out == NULL || out->size != v.size)
+    {
+        fprintf(stderr, "%s: Null or different size vector\n", __func__);
+        return NULL;
+    }
+
+    if (contiguous(v))
+    {
+        memmove(out->arr, v.data, sizeof(double) * v.size);
+        return out;
+    }
+
+    if (view_overlaps(out, v))
+    {
+        fprintf(stderr, "%s: Output overlaps the view\n", __func__);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < v.size; ++i)
+        out->arr[i] = view_at(v, i);
+
+    return out;
+}
+
+void print_view(vector_view_t v)
+{
+    printf("[");
+    for (size_t i = 0; i < v.size; ++i)
+    {
+        printf("%g", view_at(v, i));
+
+        if ((i + 1) < v.size)
+            printf(", ");
+
+        if ((i + 1) % 10 == 0 && (i + 1) != v.size)
+            putchar('\n');
+    }
+    puts("]\n");
+}
+
+vector_t *view_gradient(vector_view_t y, vector_view_t x)
+{
+    assert(y.size == x.size && y.size > 2);
+
+    vector_t *v = empty(y.size);
+
+    if (v == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation falied\n", __func__);
+        exit(1);
+    }
+
+    return view_gradient_into(v, y, x);
+}
+
+vector_t *view_gradient_into(vector_t *out, vector_view_t y, vector_view_t x)
+{
+    if (out == NULL || y.size != x.size || out->size != y.size || y.size < 3)
+    {
+        fprintf(stderr, "%s: Vectors must have the same size of at least 3\n", __func__);
+        return NULL;
+    }
+
+    if (view_overlaps(out, y) || view_overlaps(out, x))
+    {
+        fprintf(stderr, "%s: Output overlaps an input view\n", __func__);
+        return NULL;
+    }
+
+    const size_t n = y.size;
+
+    // Forward difference for first point
+    out->arr[0] = (view_at(y, 1) - view_at(y, 0)) / (view_at(x, 1) - view_at(x, 0));
+
+    // Central difference for the interior points
+    if (contiguous(y) && contiguous(x))
+    {
+        kernel_gradient_interior(n, out->arr, y.data, x.data);
+    }
+    else
+    {
+        for (size_t i = 1; i < n - 1; ++i)
+            out->arr[i] = (view_at(y, i + 1) - view_at(y, i - 1)) / (view_at(x, i + 1) - view_at(x, i - 1));
+    }
+
+    // Backward difference for last point
+    out->arr[n - 1] = (view_at(y, n - 1) - view_at(y, n - 2)) / (view_at(x, n - 1) - view_at(x, n - 2));
+
+    return out;
+}
+
+// Terms of view_trapezoidal_rule(), view_sum() and view_dot() for sum_terms()
+typedef struct view_pair_t
+{
+    vector_view_t x;
+    vector_view_t y;
+} view_pair_t;
+
+static void trapz_terms(void *ctx, size_t first, size_t len, double out[])
+{
+    const view_pair_t *p = ctx;
+    for (size_t i = first; i < first + len; ++i)
+        out[i - first] = (view_at(p->y, i) + view_at(p->y, i + 1)) * (view_at(p->x, i + 1) - view_at(p->x, i));
+}
+
+static void sum_view_terms(void *ctx, size_t first, size_t len, double out[])
+{
+    const vector_view_t *v = ctx;
+    for (size_t i = first; i < first + len; ++i)
+        out[i - first] = view_at(*v, i);
+}
+
+static void dot_terms(void *ctx, size_t first, size_t len, double out[])
+{
+    const view_pair_t *p = ctx;
+    for (size_t i = first; i < first + len; ++i)
+        out[i - first] = view_at(p->x, i) * view_at(p->y, i);
+}
+
+double view_trapezoidal_rule(vector_view_t y, vector_view_t x)
+{
+    if (x.size != y.size)
+    {
+        fprintf(stderr, "%s: x and y must have same size\n", __func__);
+        return 0.0;
+    }
+
+    const sum_policy_t policy = sum_policy();
+
+    if (contiguous(y) && contiguous(x))
+        return trapz_array(policy, x.size, y.data, x.data);
+
+    if (policy != SUM_NAIVE)
+    {
+        view_pair_t p = {x, y};
+        return x.size < 2 ? 0.0 : sum_terms(policy, x.size - 1, trapz_terms, &p) / 2.0;
+    }
+
+    // Same lane layout as kernel_trapz() so strided and contiguous views agree
+    double lanes[KERNEL_LANES] = {0};
+    for (size_t i = 0; i + 1 < x.size; ++i)
+    {
+        double h = view_at(x, i + 1) - view_at(x, i);
+        lanes[i % KERNEL_LANES] += (view_at(y, i) + view_at(y, i + 1)) * h;
+    }
+
+    double s0 = lanes[0] + lanes[4];
+    double s1 = lanes[1] + lanes[5];
+    double s2 = lanes[2] + lanes[6];
+    double s3 = lanes[3] + lanes[7];
+
+    return ((s0 + s2) + (s1 + s3)) / 2.0;
+}
+
+double view_reduce(double(f)(double, double), vector_view_t v)
+{
+    if (v.size == 0)
+    {
+        fprintf(stderr, "%s: Empty view\n", __func__);
+        return 0.0;
+    }
+
+    double result = view_at(v, 0);
+    for (size_t i = 1; i < v.size; ++i)
+    {
+        result = f(result, view_at(v, i));
+    }
+    return result;
+}
+
+double view_dot(vector_view_t x, vector_view_t y)
+{
+    if (x.size != y.size)
+    {
+        fprintf(stderr, "%s: Different size views\n", __func__);
+        return 0.0;
+    }
+
+    const sum_policy_t policy = sum_policy();
+
+    if (contiguous(x) && contiguous(y))
+        return dot_array(policy, x.size, x.data, y.data);
+
+    if (policy != SUM_NAIVE)
+    {
+        view_pair_t p = {x, y};
+        return sum_terms(policy, x.size, dot_terms, &p);
+    }
+
+    double lanes[KERNEL_LANES] = {0};
+    for (size_t i = 0; i < x.size; ++i)
+        lanes[i % KERNEL_LANES] += view_at(x, i) * view_at(y, i);
+
+    double s0 = lanes[0] + lanes[4];
+    double s1 = lanes[1] + lanes[5];
+    double s2 = lanes[2] + lanes[6];
+    double s3 = lanes[3] + lanes[7];
+
+    return (s0 + s2) + (s1 + s3);
+}
+
+double view_sum(vector_view_t v)
+{
+    const sum_policy_t policy = sum_policy();
+
+    if (contiguous(v))
+        return sum_array(policy, v.size, v.data);
+
+    if (policy != SUM_NAIVE)
+        return sum_terms(policy, v.size, sum_view_terms, &v);
+
+    double lanes[KERNEL_LANES] = {0};
+    for (size_t i = 0; i < v.size; ++i)
+        lanes[i % KERNEL_LANES] += view_at(v, i);
+
+    double s0 = lanes[0] + lanes[4];
+    double s1 = lanes[1] + lanes[5];
+    double s2 = lanes[2] + lanes[6];
+    double s3 = lanes[3] + lanes[7];
+
+    return (s0 + s2) + (s1 + s3);
+}
+
+vector_t *view_function_like(vector_view_t u, double (*function)(double))
+{
+    vector_t *v = empty(u.size);
+
+    if (v == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation falied\n", __func__);
+        exit(1);
+    }
+
+    for (size_t i = 0; i < v->size; ++i)
+    {
+        v->arr[i] = function(view_at(u, i));
+    }
+
+    return v;
+}
+
+vector_t *view_get_result(vector_view_t x, vector_view_t y, double (*function)(double, double))
+{
+    if (x.size != y.size)
+    {
+        fprintf(stderr, "%s: Different size views\n", __func__);
+        return NULL;
+    }
+
+    vector_t *v = empty(x.size);
+
+    if (v == NULL)
+    {
+        fprintf(stderr, "%s: Memory allocation falied\n", __func__);
+        exit(1);
+    }
+
+    for (size_t i = 0; i < v->size; ++i)
+    {
+        v->arr[i] = function(view_at(x, i), view_at(y, i));
+    }
+
+    return v;
+}
+
+// Checks the output and operands of an element-wise operation on views
+static bool check_elementwise(const vector_t *out, vector_view_t x, vector_view_t y, const char *caller)
+{
+    if (out == NULL)
+    {
+        fprintf(stderr, "%s: Null vector\n", caller);
+        return false;
+    }
+
+    if (x.size != y.size || out->size != x.size)
+    {
+        fprintf(stderr, "%s: Different size views\n", caller);
+        return false;
+    }
+
+    // Writing over a contiguous operand element by element is safe
+    bool x_ok = (contiguous(x) && x.data == out->arr) || !view_overlaps(out, x);
+    bool y_ok = (contiguous(y) && y.data == out->arr) || !view_overlaps(out, y);
+
+    if (!x_ok || !y_ok)
+    {
+        fprintf(stderr, "%s: Output overlaps an input view\n", caller);
+        return false;
+    }
+
+    return true;
+}
+
+#define DEFINE_VIEW_ELEMENTWISE(NAME, KERNEL, OP)                                    \
+    vector_t *view_##NAME##_into(vector_t *out, vector_view_t x, vector_view_t y)    \
+    {                                                                                \
+        if (!check_elementwise(out, x, y, __func__))                                 \
+            return NULL;                                                             \
+                                                                                     \
+        if (contiguous(x) && contiguous(y))                                          \
+        {                                                                            \
+            KERNEL(out->size, out->arr, x.data, y.data);                             \
+            return out;                                                              \
+        }                                                                            \
+                                                                                     \
+        for (size_t i = 0; i < out->size; ++i)                                       \
+            out->arr[i] = view_at(x, i) OP view_at(y, i);                            \
+                                                                                     \
+        return out;                                                                  \
+    }                                                                                \
+                                                                                     \
+    vector_t *view_##NAME(vector_view_t x, vector_view_t y)                          \
+    {                                                                                \
+        if (x.size != y.size)                                                        \
+        {                                                                            \
+            fprintf(stderr, "%s: Different size views\n", __func__);                 \
+            return NULL;                                                             \
+        }                                                                            \
+                                                                                     \
+        vector_t *v = empty(x.size);                                                 \
+                                                                                     \
+        if (v == NULL)                                                               \
+        {                                                                            \
+            fprintf(stderr, "%s: Memory allocation falied\n", __func__);             \
+            exit(1);                                                                 \
+        }                                                                            \
+                                                                                     \
+        return view_##NAME##_into(v, x, y);                                          \
+    }
+
+DEFINE_VIEW_ELEMENTWISE(add, kernel_add, +)
+DEFINE_VIEW_ELEMENTWISE(subtract, kernel_sub, -)
+DEFINE_VIEW_ELEMENTWISE(multiply, kernel_mul, *)
+DEFINE_VIEW_ELEMENTWISE(divide, kernel_div, /)
@@ -0,0 +1,102 @@
+#ifndef VECTOR_VIEW_H_
+
+#define VECTOR_VIEW_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "vector.h"
+
+/*
+Strided, non-owning views over vector data.
+
+A view is a pointer, a length and a stride in elements, so sub-ranges,
+every k-th element and reversed sequences are made in O(1) without
+copying. Views never own memory: the vector or buffer they were made
+from must outlive them. They are plain values and are passed by value.
+
+The read-only functions of vector.h have view_ counterparts. When every
+operand has stride 1 they run on the SIMD kernels like their vector
+versions.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct vector_view_t
+{
+    const double *data;
+    size_t size;
+    ptrdiff_t stride;
+} vector_view_t;
+
+// Stop value for view_slice() meaning "run to the end in the step direction"
+#define VIEW_END PTRDIFF_MIN
+
+// Returns the element at ith position
+static inline double view_at(vector_view_t v, size_t i)
+{
+    return v.data[(ptrdiff_t)i * v.stride];
+}
+
+// View of the whole of v, which may also be a mapped vector
+vector_view_t view_of(const vector_t *v);
+
+// View of size elements of data, stride elements apart
+vector_view_t view_from_buffer(const double *data, size_t size, ptrdiff_t stride);
+
+/*
+Python style v[start:stop:step]. Negative start and stop count from the
+end, out of range values are clamped and step may be negative. Pass
+VIEW_END as stop to run to the end.
+*/
+vector_view_t view_slice(vector_view_t v, ptrdiff_t start, ptrdiff_t stop, ptrdiff_t step);
+
+vector_view_t view_reverse(vector_view_t v);
+
+// Copies a view into a new vector
+vector_t *view_to_vector(vector_view_t v);
+
+vector_t *view_to_vector_into(vector_t *out, vector_view_t v);
+
+void print_view(vector_view_t v);
+
+vector_t *view_gradient(vector_view_t y, vector_view_t x);
+
+vector_t *view_gradient_into(vector_t *out, vector_view_t y, vector_view_t x);
+
+double view_trapezoidal_rule(vector_view_t y, vector_view_t x);
+
+double view_reduce(double(f)(double, double), vector_view_t v);
+
+double view_dot(vector_view_t x, vector_view_t y);
+
+double view_sum(vector_view_t v);
+
+vector_t *view_function_like(vector_view_t u, double (*function)(double));
+
+vector_t *view_get_result(vector_view_t x, vector_view_t y, double (*function)(double, double));
+
+// Element-wise operations on views, the results are new vectors
+vector_t *view_add(vector_view_t x, vector_view_t y);
+
+vector_t *view_subtract(vector_view_t x, vector_view_t y);
+
+vector_t *view_multiply(vector_view_t x, vector_view_t y);
+
+vector_t *view_divide(vector_view_t x, vector_view_t y);
+
+// out may be the data of a stride 1 operand but must not otherwise overlap one
+vector_t *view_add_into(vector_t *out, vector_view_t x, vector_view_t y);
+
+vector_t *view_subtract_into(vector_t *out, vector_view_t x, vector_view_t y);
+
+vector_t *view_multiply_into(vector_t *out, vector_view_t x, vector_view_t y);
+
+vector_t *view_divide_into(vector_t *out, vector_view_t x, vector_view_t y);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif